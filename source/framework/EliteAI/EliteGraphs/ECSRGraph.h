@@ -0,0 +1,241 @@
+/*=============================================================================*/
+// Copyright 2020-2021 Elite Engine
+/*=============================================================================*/
+// ECSRGraph.h: Immutable compressed sparse row snapshot of an IGraph and a read-only view that the graph algorithms run on
+/*=============================================================================*/
+#pragma once
+
+#include "EIGraph.h"
+#include "EImplicitGridGraph.h"
+#include <vector>
+
+namespace Elite
+{
+	// Frozen copy of the adjacency of an IGraph in compressed sparse row form.
+	// The edges of node i are [GetFirstEdge(i), GetFirstEdge(i + 1)) and are stored in connection list order,
+	// so edge indices match the ones of the precomputed bounding box tables.
+	// Every edge keeps its original connection as edge id, the snapshot has to be rebuilt when the graph changes.
+	template <class T_NodeType, class T_ConnectionType>
+	class CSRGraph final
+	{
+	public:
+		CSRGraph() = default;
+		explicit CSRGraph(const IGraph<T_NodeType, T_ConnectionType>* pGraph) { Build(pGraph); }
+
+		void Build(const IGraph<T_NodeType, T_ConnectionType>* pGraph);
+		void Clear();
+
+		int GetNrOfNodes() const { return static_cast<int>(m_Nodes.size()); }
+		int GetNrOfEdges() const { return static_cast<int>(m_EdgeTargets.size()); }
+		bool IsNodeValid(int idx) const { return idx >= 0 && idx < GetNrOfNodes() && m_IsValid[idx]; }
+		T_NodeType* GetNode(int idx) const;
+		const Vector2& GetNodePos(int idx) const { return m_Positions[idx]; }
+		const Vector2& GetNodeWorldPos(int idx) const { return m_WorldPositions[idx]; }
+
+		int GetFirstEdge(int idx) const { return m_FirstEdge[idx]; }
+		int GetNrOfConnections(int idx) const { return m_FirstEdge[idx + 1] - m_FirstEdge[idx]; }
+		int GetEdgeTarget(int edgeIdx) const { return m_EdgeTargets[edgeIdx]; }
+		float GetEdgeCost(int edgeIdx) const { return m_EdgeCosts[edgeIdx]; }
+		T_ConnectionType* GetEdgeConnection(int edgeIdx) const { return m_EdgeConnections[edgeIdx]; }
+
+		// Calls visit(edgeNr, toIdx, cost, pConnection) for every connection of the node, edgeNr counts from 0 per node
+		template <typename T_Visitor>
+		void ForEachConnection(int idx, T_Visitor visit) const;
+
+	private:
+		std::vector<int> m_FirstEdge{ 0 }; // offsets, one entry per node plus the end of the last node
+		std::vector<int> m_EdgeTargets;
+		std::vector<float> m_EdgeCosts;
+		std::vector<T_ConnectionType*> m_EdgeConnections; // edge id, the connection of the source graph
+
+		std::vector<T_NodeType*> m_Nodes;
+		std::vector<Vector2> m_Positions;
+		std::vector<Vector2> m_WorldPositions;
+		std::vector<unsigned char> m_IsValid;
+	};
+
+	template <class T_NodeType, class T_ConnectionType>
+	void CSRGraph<T_NodeType, T_ConnectionType>::Build(const IGraph<T_NodeType, T_ConnectionType>* pGraph)
+	{
+		assert(pGraph && "<CSRGraph::Build>: no graph");
+		Clear();
+
+		const int nrOfNodes = pGraph->GetNrOfNodes();
+		const int nrOfEdges = pGraph->GetNrOfConnections();
+		m_FirstEdge.reserve(nrOfNodes + 1);
+		m_EdgeTargets.reserve(nrOfEdges);
+		m_EdgeCosts.reserve(nrOfEdges);
+		m_EdgeConnections.reserve(nrOfEdges);
+		m_Nodes.reserve(nrOfNodes);
+		m_Positions.reserve(nrOfNodes);
+		m_WorldPositions.reserve(nrOfNodes);
+		m_IsValid.reserve(nrOfNodes);
+
+		for (int idx{}; idx < nrOfNodes; ++idx)
+		{
+			//RemoveNode only invalidates the index of the node, its slot stays in the graph
+			const bool isValid = pGraph->IsNodeValid(idx) && pGraph->GetNode(idx)->GetIndex() != invalid_node_index;
+			m_Nodes.push_back(pGraph->GetNode(idx));
+			m_IsValid.push_back(isValid);
+			m_Positions.push_back(isValid ? pGraph->GetNodePos(idx) : Vector2{});
+			m_WorldPositions.push_back(isValid ? pGraph->GetNodeWorldPos(idx) : Vector2{});
+
+			//Invalid nodes keep their (empty) connection list, so indices stay the same as in the graph
+			if (isValid)
+			{
+				for (T_ConnectionType* pConnection : pGraph->GetNodeConnections(idx))
+				{
+					m_EdgeTargets.push_back(pConnection->GetTo());
+					m_EdgeCosts.push_back(pConnection->GetCost());
+					m_EdgeConnections.push_back(pConnection);
+				}
+			}
+			m_FirstEdge.push_back(static_cast<int>(m_EdgeTargets.size()));
+		}
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	void CSRGraph<T_NodeType, T_ConnectionType>::Clear()
+	{
+		m_FirstEdge.assign(1, 0);
+		m_EdgeTargets.clear();
+		m_EdgeCosts.clear();
+		m_EdgeConnections.clear();
+		m_Nodes.clear();
+		m_Positions.clear();
+		m_WorldPositions.clear();
+		m_IsValid.clear();
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	T_NodeType* CSRGraph<T_NodeType, T_ConnectionType>::GetNode(int idx) const
+	{
+		assert((idx < GetNrOfNodes()) && (idx >= 0) && "<CSRGraph::GetNode>: invalid index");
+		return m_Nodes[idx];
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	template <typename T_Visitor>
+	void CSRGraph<T_NodeType, T_ConnectionType>::ForEachConnection(int idx, T_Visitor visit) const
+	{
+		const int firstEdge = m_FirstEdge[idx];
+		const int endEdge = m_FirstEdge[idx + 1];
+		for (int edgeIdx = firstEdge; edgeIdx < endEdge; ++edgeIdx)
+			visit(edgeIdx - firstEdge, m_EdgeTargets[edgeIdx], m_EdgeCosts[edgeIdx], m_EdgeConnections[edgeIdx]);
+	}
+
+	// Read-only access to either a live IGraph, a CSRGraph snapshot or an ImplicitGridGraph, so the graph algorithms can run on all of them.
+	// None is owned by the view. An implicit grid has no node or connection objects, GetNode and pConnection are nullptr for it.
+	template <class T_NodeType, class T_ConnectionType>
+	class GraphView final
+	{
+	public:
+		GraphView(const IGraph<T_NodeType, T_ConnectionType>* pGraph) : m_pGraph{ pGraph } {}
+		GraphView(const CSRGraph<T_NodeType, T_ConnectionType>* pCSRGraph) : m_pCSRGraph{ pCSRGraph } {}
+		GraphView(const ImplicitGridGraph* pImplicitGrid) : m_pImplicitGrid{ pImplicitGrid } {}
+
+		const IGraph<T_NodeType, T_ConnectionType>* GetGraph() const { return m_pGraph; }
+		const CSRGraph<T_NodeType, T_ConnectionType>* GetCSRGraph() const { return m_pCSRGraph; }
+		const ImplicitGridGraph* GetImplicitGrid() const { return m_pImplicitGrid; }
+		bool IsCSR() const { return m_pCSRGraph != nullptr; }
+		bool IsImplicitGrid() const { return m_pImplicitGrid != nullptr; }
+
+		int GetNrOfNodes() const;
+		bool IsNodeValid(int idx) const;
+		T_NodeType* GetNode(int idx) const;
+		Vector2 GetNodePos(int idx) const;
+		Vector2 GetNodeWorldPos(int idx) const;
+		int GetNrOfEdges() const;
+		int GetNrOfConnections(int idx) const;
+
+		// Calls visit(edgeNr, toIdx, cost, pConnection) for every connection of the node in connection list order
+		template <typename T_Visitor>
+		void ForEachConnection(int idx, T_Visitor visit) const;
+
+	private:
+		const IGraph<T_NodeType, T_ConnectionType>* m_pGraph = nullptr;
+		const CSRGraph<T_NodeType, T_ConnectionType>* m_pCSRGraph = nullptr;
+		const ImplicitGridGraph* m_pImplicitGrid = nullptr;
+	};
+
+	template <class T_NodeType, class T_ConnectionType>
+	inline int GraphView<T_NodeType, T_ConnectionType>::GetNrOfNodes() const
+	{
+		if (m_pImplicitGrid)
+			return m_pImplicitGrid->GetNrOfNodes();
+		return m_pCSRGraph ? m_pCSRGraph->GetNrOfNodes() : m_pGraph->GetNrOfNodes();
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	inline bool GraphView<T_NodeType, T_ConnectionType>::IsNodeValid(int idx) const
+	{
+		if (m_pImplicitGrid)
+			return m_pImplicitGrid->IsNodeValid(idx);
+		if (m_pCSRGraph)
+			return m_pCSRGraph->IsNodeValid(idx);
+		//Same test as CSRGraph::Build, a removed node keeps its slot
+		return m_pGraph->IsNodeValid(idx) && m_pGraph->GetNode(idx)->GetIndex() != invalid_node_index;
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	inline T_NodeType* GraphView<T_NodeType, T_ConnectionType>::GetNode(int idx) const
+	{
+		if (m_pImplicitGrid)
+			return nullptr;
+		return m_pCSRGraph ? m_pCSRGraph->GetNode(idx) : m_pGraph->GetNode(idx);
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	inline Vector2 GraphView<T_NodeType, T_ConnectionType>::GetNodePos(int idx) const
+	{
+		if (m_pImplicitGrid)
+			return m_pImplicitGrid->GetNodePos(idx);
+		return m_pCSRGraph ? m_pCSRGraph->GetNodePos(idx) : m_pGraph->GetNodePos(idx);
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	inline Vector2 GraphView<T_NodeType, T_ConnectionType>::GetNodeWorldPos(int idx) const
+	{
+		if (m_pImplicitGrid)
+			return m_pImplicitGrid->GetNodeWorldPos(idx);
+		return m_pCSRGraph ? m_pCSRGraph->GetNodeWorldPos(idx) : m_pGraph->GetNodeWorldPos(idx);
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	inline int GraphView<T_NodeType, T_ConnectionType>::GetNrOfEdges() const
+	{
+		if (m_pImplicitGrid)
+			return m_pImplicitGrid->GetNrOfConnections();
+		return m_pCSRGraph ? m_pCSRGraph->GetNrOfEdges() : m_pGraph->GetNrOfConnections();
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	int GraphView<T_NodeType, T_ConnectionType>::GetNrOfConnections(int idx) const
+	{
+		if (m_pImplicitGrid)
+			return m_pImplicitGrid->GetNrOfConnections(idx);
+		if (m_pCSRGraph)
+			return m_pCSRGraph->GetNrOfConnections(idx);
+		return static_cast<int>(m_pGraph->GetNodeConnections(idx).size());
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	template <typename T_Visitor>
+	void GraphView<T_NodeType, T_ConnectionType>::ForEachConnection(int idx, T_Visitor visit) const
+	{
+		if (m_pImplicitGrid)
+		{
+			m_pImplicitGrid->ForEachConnection(idx, [&visit](int edgeNr, int toIdx, float cost) { visit(edgeNr, toIdx, cost, static_cast<T_ConnectionType*>(nullptr)); });
+			return;
+		}
+		if (m_pCSRGraph)
+		{
+			m_pCSRGraph->ForEachConnection(idx, visit);
+			return;
+		}
+
+		int edgeNr{};
+		for (T_ConnectionType* pConnection : m_pGraph->GetNodeConnections(idx))
+			visit(edgeNr++, pConnection->GetTo(), pConnection->GetCost(), pConnection);
+	}
+}
@@ -43,8 +43,14 @@ namespace Elite
 
 		int GetNodeIdxAtWorldPos(const Elite::Vector2& pos) const override;
 
+		// Also updates the cost of existing connections and removes them when the terrain became impassable,
+		// so call it again when the terrain of a cell changes
 		void AddConnectionsToAdjacentCells(int col, int row);
 		void AddConnectionsToAdjacentCells(int idx);
+
+		bool IsConnectedDiagonally() const { return m_IsConnectedDiagonally; }
+		// Cost of the connection between two neighbouring cells, including their terrain for GridTerrainNode grids
+		float CalculateConnectionCost(int fromIdx, int toIdx) const;
 	private:
 		
 		int m_NrOfColumns;
@@ -60,8 +66,6 @@ namespace Elite
 
 		// graph creation helper functions
 		void AddConnectionsInDirections(int idx, int col, int row, vector<Vector2> directions);
-
-		float CalculateConnectionCost(int fromIdx, int toIdx) const;
 	
 		friend class EGraphRenderer;
 	};
@@ -179,9 +183,23 @@ namespace Elite
 				int neighborIdx = neighborRow * m_NrOfColumns + neighborCol;
 				float connectionCost = CalculateConnectionCost(idx, neighborIdx);
 
-				if (IsUniqueConnection(idx, neighborIdx) 
-					&& connectionCost < 100000) //Extra check for different terrain types
+				if (connectionCost >= 100000) //Extra check for different terrain types
+				{
+					//The terrain became impassable, the connections that were there before go
+					if (!IsUniqueConnection(idx, neighborIdx) || (!m_IsDirectionalGraph && !IsUniqueConnection(neighborIdx, idx)))
+						RemoveConnection(idx, neighborIdx);
+					continue;
+				}
+
+				if (IsUniqueConnection(idx, neighborIdx))
 					AddConnection(new GraphConnection(idx, neighborIdx, connectionCost));
+				else
+				{
+					//The terrain changed, the connections in both directions get the new cost
+					GetConnection(idx, neighborIdx)->SetCost(connectionCost);
+					if (!m_IsDirectionalGraph && !IsUniqueConnection(neighborIdx, idx))
+						GetConnection(neighborIdx, idx)->SetCost(connectionCost);
+				}
 			}
 		}
 	}
@@ -353,7 +353,9 @@ namespace Elite
 		}
 
 		SAFE_DELETE(conFromTo);
-		SAFE_DELETE(conToFrom);
+		//A directed graph keeps the connection in the other direction
+		if (!m_IsDirectionalGraph)
+			SAFE_DELETE(conToFrom);
 
 		OnGraphModified(false, true);
 	}
@@ -449,6 +451,8 @@ namespace Elite
 		m_Connections.clear();
 
 		m_NextNodeIndex = 0;
+
+		OnGraphModified(true, true);
 	}
 
 	template<class T_NodeType, class T_ConnectionType>
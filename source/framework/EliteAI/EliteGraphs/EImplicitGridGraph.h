@@ -0,0 +1,191 @@
+/*=============================================================================*/
+// Copyright 2020-2021 Elite Engine
+/*=============================================================================*/
+// EImplicitGridGraph.h: Grid graph without node or connection objects, the neighbours of a cell are generated when they're visited
+/*=============================================================================*/
+#pragma once
+
+#include "EGraphEnums.h"
+#include <vector>
+#include <cstdint>
+#include <cassert>
+
+namespace Elite
+{
+	// Same layout and costs as a GridGraph of GridTerrainNodes, stored as one bit per cell (passable or not) and, only once a cell
+	// gets another terrain than ground, one byte per cell with its terrain cost. Cells are numbered row by row and a passable cell is
+	// connected to every passable neighbour, like GridGraph does. A 4096x4096 grid takes 2MB, or 18MB with terrain costs.
+	// There are no node objects: the graph algorithms run on it through GraphView and return paths as cell indices.
+	class ImplicitGridGraph final
+	{
+	public:
+		ImplicitGridGraph() = default;
+		ImplicitGridGraph(int columns, int rows, int cellSize, bool isConnectedDiagonally, float costStraight = 1.f, float costDiagonal = 1.5f)
+		{
+			InitializeGrid(columns, rows, cellSize, isConnectedDiagonally, costStraight, costDiagonal);
+		}
+		// Every cell becomes passable ground
+		void InitializeGrid(int columns, int rows, int cellSize, bool isConnectedDiagonally, float costStraight = 1.f, float costDiagonal = 1.5f);
+
+		int GetRows() const { return m_NrOfRows; }
+		int GetColumns() const { return m_NrOfColumns; }
+		int GetNrOfNodes() const { return m_NrOfColumns * m_NrOfRows; }
+		bool IsConnectedDiagonally() const { return m_IsConnectedDiagonally; }
+
+		bool IsWithinBounds(int col, int row) const { return col >= 0 && col < m_NrOfColumns && row >= 0 && row < m_NrOfRows; }
+		int GetIndex(int col, int row) const { return row * m_NrOfColumns + col; }
+		bool IsNodeValid(int idx) const { return idx >= 0 && idx < GetNrOfNodes(); }
+
+		bool IsPassable(int idx) const { return (m_PassableBits[idx >> 5] >> (idx & 31)) & 1u; }
+		void SetPassable(int idx, bool isPassable);
+
+		// Cost multiplier of a cell, a step costs the straight or diagonal cost times the average of both cells (see GridGraph::CalculateConnectionCost)
+		int GetTerrainCost(int idx) const { return m_TerrainCosts.empty() ? int(TerrainType::Ground) : m_TerrainCosts[idx]; }
+		void SetTerrainCost(int idx, uint8_t cost);
+		// Water blocks the cell, any other terrain makes it passable with the terrain as its cost
+		void SetTerrainType(int idx, TerrainType terrain);
+		bool HasTerrainCosts() const { return !m_TerrainCosts.empty(); }
+		// Back to ground everywhere, frees the terrain costs
+		void ClearTerrainCosts() { std::vector<uint8_t>().swap(m_TerrainCosts); }
+
+		// returns the column and row of the cell in a Vector2
+		Vector2 GetNodePos(int idx) const { return Vector2{ float(idx % m_NrOfColumns), float(idx / m_NrOfColumns) }; }
+		// returns the center of the cell in the world
+		Vector2 GetNodeWorldPos(int idx) const;
+		int GetNodeIdxAtWorldPos(const Vector2& pos) const;
+
+		int GetNrOfConnections(int idx) const;
+		// Walks the whole grid, connections are counted once per direction like IGraph does
+		int GetNrOfConnections() const;
+		// Calls visit(edgeNr, toIdx, cost) for every passable neighbour of a passable cell, straight neighbours first,
+		// in the order GridGraph adds its connections. edgeNr counts from 0 per cell
+		template <typename T_Visitor>
+		void ForEachConnection(int idx, T_Visitor visit) const;
+
+	private:
+		int m_NrOfColumns = 0;
+		int m_NrOfRows = 0;
+		int m_CellSize = 5;
+		bool m_IsConnectedDiagonally = true;
+		float m_DefaultCostStraight = 1.f;
+		float m_DefaultCostDiagonal = 1.5f;
+
+		std::vector<uint32_t> m_PassableBits; // bit (idx & 31) of word (idx >> 5)
+		std::vector<uint8_t> m_TerrainCosts; // empty while every cell is ground
+
+		static int GetColumnOffset(int direction)
+		{
+			static const int columnOffsets[8]{ 1, 0, -1, 0, 1, -1, -1, 1 };
+			return columnOffsets[direction];
+		}
+		static int GetRowOffset(int direction)
+		{
+			static const int rowOffsets[8]{ 0, 1, 0, -1, 1, 1, -1, -1 };
+			return rowOffsets[direction];
+		}
+	};
+
+	inline void ImplicitGridGraph::InitializeGrid(int columns, int rows, int cellSize, bool isConnectedDiagonally, float costStraight, float costDiagonal)
+	{
+		m_NrOfColumns = columns;
+		m_NrOfRows = rows;
+		m_CellSize = cellSize;
+		m_IsConnectedDiagonally = isConnectedDiagonally;
+		m_DefaultCostStraight = costStraight;
+		m_DefaultCostDiagonal = costDiagonal;
+
+		//Padding bits of the last word stay 0, they're never read
+		const int nrOfCells = columns * rows;
+		m_PassableBits.assign((nrOfCells + 31) / 32, ~0u);
+		if (nrOfCells % 32 != 0)
+			m_PassableBits.back() = (1u << (nrOfCells % 32)) - 1;
+		ClearTerrainCosts();
+	}
+
+	inline void ImplicitGridGraph::SetPassable(int idx, bool isPassable)
+	{
+		assert(IsNodeValid(idx) && "<ImplicitGridGraph::SetPassable>: invalid index");
+		if (isPassable)
+			m_PassableBits[idx >> 5] |= 1u << (idx & 31);
+		else
+			m_PassableBits[idx >> 5] &= ~(1u << (idx & 31));
+	}
+
+	inline void ImplicitGridGraph::SetTerrainCost(int idx, uint8_t cost)
+	{
+		assert(IsNodeValid(idx) && cost > 0 && "<ImplicitGridGraph::SetTerrainCost>: invalid index or cost");
+		if (m_TerrainCosts.empty())
+		{
+			if (cost == uint8_t(TerrainType::Ground))
+				return;
+			m_TerrainCosts.assign(GetNrOfNodes(), uint8_t(TerrainType::Ground));
+		}
+		m_TerrainCosts[idx] = cost;
+	}
+
+	inline void ImplicitGridGraph::SetTerrainType(int idx, TerrainType terrain)
+	{
+		SetPassable(idx, terrain != TerrainType::Water);
+		if (terrain != TerrainType::Water)
+			SetTerrainCost(idx, uint8_t(terrain));
+	}
+
+	inline Vector2 ImplicitGridGraph::GetNodeWorldPos(int idx) const
+	{
+		const Vector2 colRow = GetNodePos(idx);
+		return Vector2{ (colRow.x + 0.5f) * m_CellSize, (colRow.y + 0.5f) * m_CellSize };
+	}
+
+	inline int ImplicitGridGraph::GetNodeIdxAtWorldPos(const Vector2& pos) const
+	{
+		if (pos.x < 0 || pos.y < 0)
+			return invalid_node_index;
+
+		const int c = int(pos.x / m_CellSize);
+		const int r = int(pos.y / m_CellSize);
+		return IsWithinBounds(c, r) ? GetIndex(c, r) : invalid_node_index;
+	}
+
+	inline int ImplicitGridGraph::GetNrOfConnections(int idx) const
+	{
+		int nrOfConnections{};
+		ForEachConnection(idx, [&nrOfConnections](int, int, float) { ++nrOfConnections; });
+		return nrOfConnections;
+	}
+
+	inline int ImplicitGridGraph::GetNrOfConnections() const
+	{
+		int nrOfConnections{};
+		for (int idx{}; idx < GetNrOfNodes(); ++idx)
+			nrOfConnections += GetNrOfConnections(idx);
+		return nrOfConnections;
+	}
+
+	template <typename T_Visitor>
+	void ImplicitGridGraph::ForEachConnection(int idx, T_Visitor visit) const
+	{
+		if (!IsPassable(idx))
+			return;
+
+		const int col = idx % m_NrOfColumns;
+		const int row = idx / m_NrOfColumns;
+		const int nrOfDirections = m_IsConnectedDiagonally ? 8 : 4;
+		int edgeNr{};
+		for (int direction{}; direction < nrOfDirections; ++direction)
+		{
+			const int toCol = col + GetColumnOffset(direction);
+			const int toRow = row + GetRowOffset(direction);
+			if (!IsWithinBounds(toCol, toRow))
+				continue;
+
+			const int toIdx = GetIndex(toCol, toRow);
+			if (!IsPassable(toIdx))
+				continue;
+
+			float cost = direction < 4 ? m_DefaultCostStraight : m_DefaultCostDiagonal;
+			if (!m_TerrainCosts.empty())
+				cost *= (m_TerrainCosts[idx] + m_TerrainCosts[toIdx]) / 2.0f;
+			visit(edgeNr++, toIdx, cost);
+		}
+	}
+}
@@ -1,28 +1,33 @@
 #include "stdafx.h"
 #include "ENavGraph.h"
+#include <iterator>
 #include "framework\EliteAI\EliteGraphs\EliteGraphAlgorithms\EAStar.h"
 
 using namespace Elite;
 
 Elite::NavGraph::NavGraph(const Polygon& contourMesh, float playerRadius = 1.0f) :
+	//Get all shapes from all static rigid bodies with NavigationCollider flag
+	NavGraph(contourMesh, PHYSICSWORLD->GetAllStaticShapesInWorld(PhysicsFlags::NavigationCollider), playerRadius)
+{
+}
+
+Elite::NavGraph::NavGraph(const Polygon& contourMesh, const std::vector<Polygon>& shapes, float playerRadius, TriangulationEngine engine) :
 	Graph2D(false),
-	m_pNavMeshPolygon(nullptr)
+	m_pNavMeshPolygon(nullptr),
+	m_PlayerRadius(playerRadius)
 {
 	//Create the navigation mesh (polygon of navigable area= Contour - Static Shapes)
 	m_pNavMeshPolygon = new Polygon(contourMesh); // Create copy on heap
 
-	//Get all shapes from all static rigid bodies with NavigationCollider flag
-	auto vShapes = PHYSICSWORLD->GetAllStaticShapesInWorld(PhysicsFlags::NavigationCollider);
-
 	//Store all children
-	for (auto shape : vShapes)
+	for (auto shape : shapes)
 	{
 		shape.ExpandShape(playerRadius);
 		m_pNavMeshPolygon->AddChild(shape);
 	}
 
 	//Triangulate
-	m_pNavMeshPolygon->Triangulate();
+	m_pNavMeshPolygon->Triangulate(engine);
 
 	//Create the actual graph (nodes & connections) from the navigation mesh
 	CreateNavigationGraph();
@@ -36,13 +41,10 @@ Elite::NavGraph::~NavGraph()
 
 int Elite::NavGraph::GetNodeIdxFromLineIdx(int lineIdx) const
 {
-	auto nodeIt = std::find_if(m_Nodes.begin(), m_Nodes.end(), [lineIdx](const NavGraphNode* n) { return n->GetLineIndex() == lineIdx; });
-	if (nodeIt != m_Nodes.end())
-	{
-		return (*nodeIt)->GetIndex();
-	}
+	if (lineIdx < 0 || lineIdx >= static_cast<int>(m_LineToNodeIdx.size()))
+		return invalid_node_index;
 
-	return invalid_node_index;
+	return m_LineToNodeIdx[lineIdx];
 }
 
 Elite::Polygon* Elite::NavGraph::GetNavMeshPolygon() const
@@ -50,20 +52,63 @@ Elite::Polygon* Elite::NavGraph::GetNavMeshPolygon() const
 	return m_pNavMeshPolygon;
 }
 
+Elite::SearchEndpoint Elite::NavGraph::GetSearchEndpoint(const Vector2& position, const Triangle* pTriangle) const
+{
+	SearchEndpoint endpoint{ position };
+	if (!pTriangle)
+		return endpoint;
+
+	//Lines without a node are on the border of the navmesh
+	for (int lineIdx : pTriangle->metaData.IndexLines)
+	{
+		int nodeIdx{ GetNodeIdxFromLineIdx(lineIdx) };
+		if (nodeIdx != invalid_node_index)
+			endpoint.AddLink(nodeIdx);
+	}
+
+	return endpoint;
+}
+
+Elite::NavGraphUpdate Elite::NavGraph::AddNavigationCollider(const Polygon& shape)
+{
+	Polygon expandedShape{ shape };
+	expandedShape.ExpandShape(m_PlayerRadius);
+
+	TriangulationUpdate update{};
+	if (!m_pNavMeshPolygon->AddChildIncremental(expandedShape, update))
+		return RecreateNavigationGraph();
+	return ApplyTriangulationUpdate(update);
+}
+
+Elite::NavGraphUpdate Elite::NavGraph::RemoveNavigationCollider(const Polygon& shape)
+{
+	Polygon expandedShape{ shape };
+	expandedShape.ExpandShape(m_PlayerRadius);
+
+	TriangulationUpdate update{};
+	if (!m_pNavMeshPolygon->RemoveChildIncremental(expandedShape, update))
+		return RecreateNavigationGraph();
+	return ApplyTriangulationUpdate(update);
+}
+
 void Elite::NavGraph::CreateNavigationGraph()
 {
+	m_IsCreatingGraph = true;
+	m_LineToNodeIdx.assign(m_pNavMeshPolygon->GetLines().size(), invalid_node_index);
+
 	//1. Go over all the edges of the navigation mesh and create nodes
-	auto polyLines{ m_pNavMeshPolygon->GetLines() };
+	const auto& polyLines{ m_pNavMeshPolygon->GetLines() };
 	for (auto curLine : polyLines)
 	{
-		//Check if that line is connected to another triangle (GetTrianglesFromLineIndex())
-		if (m_pNavMeshPolygon->GetTrianglesFromLineIndex(curLine->index).size() > 1)
+		//Check if that line is connected to another triangle (line to triangle table of the triangulation)
+		if (m_pNavMeshPolygon->GetAmountTrianglesOnLine(curLine->index) > 1)
 		{
 			//Create a NavGraphNode on the graph
 			//positioned on the middle of the line
 			//has as lineIdx the curLine idx
 			NavGraphNode* pNewNode(new NavGraphNode(GetNextFreeNodeIndex(), curLine->index, (curLine->p1 + curLine->p2) / 2.f));
 			AddNode(pNewNode);
+			m_LineToNodeIdx[curLine->index] = pNewNode->GetIndex();
 		}
 	}
 
@@ -75,13 +120,9 @@ void Elite::NavGraph::CreateNavigationGraph()
 		std::vector<int> savedLineIndexes{};
 		for (auto lineIdx : curTriangle->metaData.IndexLines)
 		{
-			for (auto node : m_Nodes)
-			{
-				if (node->GetLineIndex() == lineIdx)
-				{
-					savedLineIndexes.push_back(node->GetIndex());
-				}
-			}
+			const int nodeIdx{ GetNodeIdxFromLineIdx(lineIdx) };
+			if (nodeIdx != invalid_node_index)
+				savedLineIndexes.push_back(nodeIdx);
 		}
 		if (savedLineIndexes.size() == 2)
 		{
@@ -102,4 +143,175 @@ void Elite::NavGraph::CreateNavigationGraph()
 
 	//3. Set the connections cost to the actual distance
 	SetConnectionCostsToDistance();
+
+	m_IsCreatingGraph = false;
+}
+
+Elite::NavGraphUpdate Elite::NavGraph::ApplyTriangulationUpdate(const TriangulationUpdate& update)
+{
+	m_IsCreatingGraph = true;
+	NavGraphUpdate graphUpdate{};
+	auto removePortal = [this, &graphUpdate](int nodeIdx)
+	{
+		for (auto pConnection : GetNodeConnections(nodeIdx))
+			graphUpdate.changedNodes.push_back(pConnection->GetTo());
+		graphUpdate.changedNodes.push_back(nodeIdx);
+		graphUpdate.removedNodes.push_back(nodeIdx);
+		RemoveNode(nodeIdx);
+	};
+
+	//1. Remove the connections that went through the removed triangles, with the line indices from before the update
+	for (const auto& lines : update.removedTriangleLines)
+	{
+		std::vector<int> nodes{};
+		for (int lineIdx : lines)
+		{
+			const int nodeIdx{ GetNodeIdxFromLineIdx(lineIdx) };
+			if (nodeIdx != invalid_node_index && std::find(nodes.begin(), nodes.end(), nodeIdx) == nodes.end())
+				nodes.push_back(nodeIdx);
+		}
+		for (size_t i{}; i < nodes.size(); ++i)
+		{
+			for (size_t j{ i + 1 }; j < nodes.size(); ++j)
+			{
+				if (GetConnection(nodes[i], nodes[j]) == nullptr)
+					continue;
+				RemoveConnection(nodes[i], nodes[j]);
+				graphUpdate.changedNodes.push_back(nodes[i]);
+				graphUpdate.changedNodes.push_back(nodes[j]);
+			}
+		}
+	}
+
+	//2. Remove the nodes of the removed lines, then follow the lines that moved
+	for (int lineIdx : update.removedLines)
+	{
+		const int nodeIdx{ GetNodeIdxFromLineIdx(lineIdx) };
+		if (nodeIdx != invalid_node_index)
+			removePortal(nodeIdx);
+		m_LineToNodeIdx[lineIdx] = invalid_node_index;
+	}
+	for (const auto& move : update.movedLines)
+	{
+		const int nodeIdx{ m_LineToNodeIdx[move.first] };
+		m_LineToNodeIdx[move.second] = nodeIdx;
+		m_LineToNodeIdx[move.first] = invalid_node_index;
+		if (nodeIdx != invalid_node_index)
+			m_Nodes[nodeIdx]->SetLineIndex(move.second);
+	}
+	m_LineToNodeIdx.resize(m_pNavMeshPolygon->GetLines().size(), invalid_node_index);
+
+	//3. Lines around and in the retriangulated area become a portal or stop being one.
+	//New nodes take the place of removed ones, so the graph doesn't grow with every update
+	const auto& polyLines{ m_pNavMeshPolygon->GetLines() };
+	std::vector<int> freeNodes{};
+	for (int idx{}; idx < static_cast<int>(m_Nodes.size()); ++idx)
+	{
+		if (m_Nodes[idx]->GetIndex() == invalid_node_index)
+			freeNodes.push_back(idx);
+	}
+	for (int lineIdx : update.changedLines)
+	{
+		const bool isPortal{ m_pNavMeshPolygon->GetAmountTrianglesOnLine(lineIdx) > 1 };
+		const int nodeIdx{ m_LineToNodeIdx[lineIdx] };
+		if (!isPortal && nodeIdx != invalid_node_index)
+		{
+			removePortal(nodeIdx);
+			m_LineToNodeIdx[lineIdx] = invalid_node_index;
+			freeNodes.push_back(nodeIdx);
+		}
+		else if (isPortal && nodeIdx == invalid_node_index)
+		{
+			const Line* pLine{ polyLines[lineIdx] };
+			int newNodeIdx{ GetNextFreeNodeIndex() };
+			NavGraphNode* pOldNode{ nullptr };
+			if (!freeNodes.empty())
+			{
+				newNodeIdx = freeNodes.back();
+				freeNodes.pop_back();
+				pOldNode = m_Nodes[newNodeIdx];
+			}
+			AddNode(new NavGraphNode(newNodeIdx, lineIdx, (pLine->p1 + pLine->p2) / 2.f));
+			SAFE_DELETE(pOldNode);
+			m_LineToNodeIdx[lineIdx] = newNodeIdx;
+			graphUpdate.changedNodes.push_back(newNodeIdx);
+			graphUpdate.addedNodes.push_back(newNodeIdx);
+		}
+	}
+
+	//4. Connect the portals of the new triangles
+	const auto& polyTriangles{ m_pNavMeshPolygon->GetTriangles() };
+	for (int triangleIdx : update.addedTriangles)
+		AddPortalConnections(polyTriangles[triangleIdx], graphUpdate);
+
+	m_IsCreatingGraph = false;
+
+	for (auto pNodes : { &graphUpdate.changedNodes, &graphUpdate.addedNodes, &graphUpdate.removedNodes })
+	{
+		std::sort(pNodes->begin(), pNodes->end());
+		pNodes->erase(std::unique(pNodes->begin(), pNodes->end()), pNodes->end());
+	}
+	return graphUpdate;
+}
+
+Elite::NavGraphUpdate Elite::NavGraph::RecreateNavigationGraph()
+{
+	NavGraphUpdate graphUpdate{};
+	for (int i{}; i < GetNrOfNodes(); ++i)
+		graphUpdate.removedNodes.push_back(i);
+
+	Clear();
+	CreateNavigationGraph();
+
+	for (int i{}; i < GetNrOfNodes(); ++i)
+		graphUpdate.addedNodes.push_back(i);
+
+	//Every node of the old and of the new graph changed, both lists are sorted already
+	std::set_union(graphUpdate.removedNodes.begin(), graphUpdate.removedNodes.end(), graphUpdate.addedNodes.begin(), graphUpdate.addedNodes.end(),
+		std::back_inserter(graphUpdate.changedNodes));
+	return graphUpdate;
+}
+
+void Elite::NavGraph::AddPortalConnections(const Triangle* pTriangle, NavGraphUpdate& graphUpdate)
+{
+	std::vector<int> nodes{};
+	for (int lineIdx : pTriangle->metaData.IndexLines)
+	{
+		const int nodeIdx{ GetNodeIdxFromLineIdx(lineIdx) };
+		if (nodeIdx != invalid_node_index && std::find(nodes.begin(), nodes.end(), nodeIdx) == nodes.end())
+			nodes.push_back(nodeIdx);
+	}
+	for (size_t i{}; i < nodes.size(); ++i)
+	{
+		for (size_t j{ i + 1 }; j < nodes.size(); ++j)
+		{
+			if (GetConnection(nodes[i], nodes[j]) != nullptr)
+				continue;
+			AddConnection(new GraphConnection2D(nodes[i], nodes[j], abs(Distance(GetNodePos(nodes[i]), GetNodePos(nodes[j])))));
+			graphUpdate.changedNodes.push_back(nodes[i]);
+			graphUpdate.changedNodes.push_back(nodes[j]);
+		}
+	}
+}
+
+void Elite::NavGraph::RebuildLineToNodeIdx()
+{
+	//The first valid node of a line wins, like the search over all nodes did
+	m_LineToNodeIdx.assign(m_pNavMeshPolygon ? m_pNavMeshPolygon->GetLines().size() : 0, invalid_node_index);
+	for (auto pNode : m_Nodes)
+	{
+		const int lineIdx{ pNode->GetLineIndex() };
+		if (pNode->GetIndex() != invalid_node_index && lineIdx >= 0 && lineIdx < static_cast<int>(m_LineToNodeIdx.size())
+			&& m_LineToNodeIdx[lineIdx] == invalid_node_index)
+			m_LineToNodeIdx[lineIdx] = pNode->GetIndex();
+	}
+}
+
+void Elite::NavGraph::OnGraphModified(bool nrOfNodesChanged, bool nrOfConnectionsChanged)
+{
+	++m_Version;
+
+	//Nodes added or removed outside of CreateNavigationGraph (e.g. by the graph editor)
+	if (nrOfNodesChanged && !m_IsCreatingGraph)
+		RebuildLineToNodeIdx();
 }
\ No newline at end of file
@@ -3,23 +3,57 @@
 #include "framework/EliteAI/EliteGraphs/EGraph2D.h"
 #include "framework/EliteAI/EliteGraphs/EGraphConnectionTypes.h"
 #include "framework/EliteAI/EliteGraphs/EGraphNodeTypes.h"
+#include "framework/EliteAI/EliteGraphs/EliteGraphAlgorithms/ESearchEndpoint.h"
 
 namespace Elite
 {
+	//Nodes touched by an incremental change of a NavGraph, all sorted
+	struct NavGraphUpdate final
+	{
+		std::vector<int> changedNodes{}; //Added, removed or reconnected
+		std::vector<int> addedNodes{}; //Can reuse the index of a removed node
+		std::vector<int> removedNodes{};
+	};
+
 	class NavGraph final: public Graph2D<NavGraphNode, GraphConnection2D>
 	{
 	public:
+		//The shapes of all static rigid bodies with the NavigationCollider flag are the obstacles
 		NavGraph(const Polygon& baseMesh, float playerRadius );
+		//Doesn't use the physics world (e.g. headless benchmarks), the shapes are expanded by the player radius
+		NavGraph(const Polygon& baseMesh, const std::vector<Polygon>& shapes, float playerRadius, TriangulationEngine engine = TriangulationEngine::EarClipping);
 		~NavGraph();
 
+		//O(1), portal nodes are looked up in a table indexed by line
 		int GetNodeIdxFromLineIdx(int lineIdx) const;
 		Polygon* GetNavMeshPolygon() const;
 
+		//Creates a query endpoint at position, linked to the portal nodes of pTriangle (the triangle that contains position)
+		SearchEndpoint GetSearchEndpoint(const Vector2& position, const Triangle* pTriangle) const;
+
+		//Doors and destructibles: only the triangles around the shape are retriangulated, only their nodes and connections change.
+		//The shape is expanded by the player radius, like the static shapes. When the whole graph had to be rebuilt
+		//every old node is reported as removed and every new one as added
+		NavGraphUpdate AddNavigationCollider(const Polygon& shape);
+		NavGraphUpdate RemoveNavigationCollider(const Polygon& shape);
+
+		//Bumped on every change of the nodes or connections, data derived from the graph (e.g. cached paths) is stale once it differs
+		unsigned int GetVersion() const { return m_Version; }
+
 	private:
 		//--- Datamembers ---
 		Polygon* m_pNavMeshPolygon = nullptr; //Polygon that represents navigation mesh
+		std::vector<int> m_LineToNodeIdx; //Node of every line of the navigation mesh, invalid_node_index for lines without one
+		bool m_IsCreatingGraph = false; //CreateNavigationGraph and ApplyTriangulationUpdate fill m_LineToNodeIdx themselves
+		float m_PlayerRadius = 1.0f;
+		unsigned int m_Version = 0;
 
 		void CreateNavigationGraph();
+		NavGraphUpdate ApplyTriangulationUpdate(const TriangulationUpdate& update);
+		NavGraphUpdate RecreateNavigationGraph();
+		void AddPortalConnections(const Triangle* pTriangle, NavGraphUpdate& graphUpdate);
+		void RebuildLineToNodeIdx();
+		virtual void OnGraphModified(bool nrOfNodesChanged, bool nrOfConnectionsChanged) override;
 
 
 	private:
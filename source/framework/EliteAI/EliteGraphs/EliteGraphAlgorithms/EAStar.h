@@ -1,13 +1,28 @@
 #pragma once
 #include "../../App_FasterAStar/OptimizedGraph.h"
+#include "ESearchContext.h"
+#include "ESearchEndpoint.h"
+#include "ESearchStatistics.h"
+#include "../ECSRGraph.h"
 
 namespace Elite
 {
-	template <class T_NodeType, class T_ConnectionType>
+	// Open list implementation used by AStar::FindPath
+	enum class AStarEngine
+	{
+		LinearScan, // vector of open nodes, the next node is picked with a linear scan
+		PriorityQueue // indexed 4-ary heap with decrease-key
+	};
+
+	template <class T_NodeType, class T_ConnectionType, AStarEngine T_Engine = AStarEngine::PriorityQueue>
 	class AStar
 	{
 	public:
 		AStar(IGraph<T_NodeType, T_ConnectionType>* pGraph, Heuristic hFunction);
+		// Searches a frozen snapshot of the graph, which has to outlive the pathfinder
+		AStar(const CSRGraph<T_NodeType, T_ConnectionType>* pGraph, Heuristic hFunction);
+		// Searches an implicit grid, which has no node objects: use the FindPath overload with cell indices
+		AStar(const ImplicitGridGraph* pGraph, Heuristic hFunction);
 
 		// stores the optimal connection to a node and its total costs related to the start and end node of the path
 		struct NodeRecord
@@ -33,113 +48,262 @@ namespace Elite
 
 		std::vector<T_NodeType*> FindPath(T_NodeType* pStartNode, T_NodeType* pDestinationNode, OptimizedGraph<T_NodeType, T_ConnectionType>* pOptimization = nullptr);
 
+		// Finds a path between two positions that aren't nodes of the graph, see SearchEndpoint.
+		// path receives the graph nodes in between the endpoints and is left empty when there is no path.
+		// The graph is never copied or modified, once the pathfinder and path have grown to the size of the graph this doesn't allocate.
+		bool FindPath(const SearchEndpoint& start, const SearchEndpoint& goal, std::vector<T_NodeType*>& path, OptimizedGraph<T_NodeType, T_ConnectionType>* pOptimization = nullptr);
+
+		// Same search between two nodes by index, path receives the node indices from start to goal and is left empty when there is no path
+		bool FindPath(int startIdx, int goalIdx, std::vector<int>& path, OptimizedGraph<T_NodeType, T_ConnectionType>* pOptimization = nullptr);
+
+		// Work done by the last FindPath call, always zero when USE_SEARCH_STATISTICS is off
+		const SearchStatistics& GetLastSearchStatistics() const { return m_LastSearchStatistics; }
+
 	private:
-		float GetHeuristicCost(T_NodeType* pStartNode, T_NodeType* pEndNode) const;
+		using LinearScanEngine = std::integral_constant<AStarEngine, AStarEngine::LinearScan>;
+		using PriorityQueueEngine = std::integral_constant<AStarEngine, AStarEngine::PriorityQueue>;
+		using Engine = std::integral_constant<AStarEngine, T_Engine>;
+
+		// The virtual start and goal node of an endpoint query get the indices right after the last node of the graph
+		enum { nr_of_virtual_nodes = 2 };
+
+		bool Search(int startIdx, int goalIdx, const Vector2& startPos, const Vector2& goalPos,
+			const SearchEndpoint* pStartEndpoint, const SearchEndpoint* pGoalEndpoint, OptimizedGraph<T_NodeType, T_ConnectionType>* pOptimization);
+		void Relax(int fromIdx, int toIdx, float totalGCost, const Vector2& toPos, const Vector2& goalPos);
+		void ReconstructPath(int goalIdx, std::vector<T_NodeType*>& path) const;
+		void ReconstructPath(int goalIdx, std::vector<int>& path) const;
+
+		void OpenNode(int idx, float costSoFar, float estimatedTotalCost, int parentIdx, LinearScanEngine);
+		void OpenNode(int idx, float costSoFar, float estimatedTotalCost, int parentIdx, PriorityQueueEngine);
+		int CloseBestNode(LinearScanEngine);
+		int CloseBestNode(PriorityQueueEngine);
+		bool IsOpenListEmpty(LinearScanEngine) const { return m_LinearOpenList.empty(); }
+		bool IsOpenListEmpty(PriorityQueueEngine) const { return m_Context.IsOpenListEmpty(); }
+		int GetOpenListSize(LinearScanEngine) const { return static_cast<int>(m_LinearOpenList.size()); }
+		int GetOpenListSize(PriorityQueueEngine) const { return m_Context.GetOpenListSize(); }
+
+		float GetHeuristicCost(const Vector2& startPos, const Vector2& endPos) const;
 
-		IGraph<T_NodeType, T_ConnectionType>* m_pGraph;
+		GraphView<T_NodeType, T_ConnectionType> m_Graph;
 		Heuristic m_HeuristicFunction;
+		SearchContext m_Context; // reused by every FindPath call on this pathfinder
+		std::vector<int> m_LinearOpenList; // open list of the LinearScan engine
+		SearchStatistics m_LastSearchStatistics;
 	};
 
-	template <class T_NodeType, class T_ConnectionType>
-	AStar<T_NodeType, T_ConnectionType>::AStar(IGraph<T_NodeType, T_ConnectionType>* pGraph, Heuristic hFunction)
-		: m_pGraph(pGraph)
+	template <class T_NodeType, class T_ConnectionType, AStarEngine T_Engine>
+	AStar<T_NodeType, T_ConnectionType, T_Engine>::AStar(IGraph<T_NodeType, T_ConnectionType>* pGraph, Heuristic hFunction)
+		: m_Graph(pGraph)
 		, m_HeuristicFunction(hFunction)
 	{
 	}
 
-	template <class T_NodeType, class T_ConnectionType>
-	std::vector<T_NodeType*> AStar<T_NodeType, T_ConnectionType>::FindPath(T_NodeType* pStartNode, T_NodeType* pGoalNode, OptimizedGraph<T_NodeType, T_ConnectionType>* pOptimization)
+	template <class T_NodeType, class T_ConnectionType, AStarEngine T_Engine>
+	AStar<T_NodeType, T_ConnectionType, T_Engine>::AStar(const CSRGraph<T_NodeType, T_ConnectionType>* pGraph, Heuristic hFunction)
+		: m_Graph(pGraph)
+		, m_HeuristicFunction(hFunction)
+	{
+	}
+
+	template <class T_NodeType, class T_ConnectionType, AStarEngine T_Engine>
+	AStar<T_NodeType, T_ConnectionType, T_Engine>::AStar(const ImplicitGridGraph* pGraph, Heuristic hFunction)
+		: m_Graph(pGraph)
+		, m_HeuristicFunction(hFunction)
+	{
+	}
+
+	template <class T_NodeType, class T_ConnectionType, AStarEngine T_Engine>
+	std::vector<T_NodeType*> AStar<T_NodeType, T_ConnectionType, T_Engine>::FindPath(T_NodeType* pStartNode, T_NodeType* pGoalNode, OptimizedGraph<T_NodeType, T_ConnectionType>* pOptimization)
 	{
-		//Hier A* implenteren
 		std::vector<T_NodeType*> path;
-		std::vector<NodeRecord> openList;
-		std::vector<NodeRecord> closedList;
-		NodeRecord currentRecord;
+
+		const int goalIdx = pGoalNode->GetIndex();
+		if (Search(pStartNode->GetIndex(), goalIdx, m_Graph.GetNodePos(pStartNode->GetIndex()), m_Graph.GetNodePos(goalIdx), nullptr, nullptr, pOptimization))
+			ReconstructPath(goalIdx, path);
+
+		return path;
+	}
+
+	template <class T_NodeType, class T_ConnectionType, AStarEngine T_Engine>
+	bool AStar<T_NodeType, T_ConnectionType, T_Engine>::FindPath(const SearchEndpoint& start, const SearchEndpoint& goal, std::vector<T_NodeType*>& path, OptimizedGraph<T_NodeType, T_ConnectionType>* pOptimization)
+	{
+		path.clear();
+		SEARCH_STATISTIC(m_LastSearchStatistics = {});
+		if (start.nrOfLinks == 0 || goal.nrOfLinks == 0)
+			return false;
+
+		const int startIdx = m_Graph.GetNrOfNodes();
+		const int goalIdx = startIdx + 1;
+		if (!Search(startIdx, goalIdx, start.position, goal.position, &start, &goal, pOptimization))
+			return false;
+
+		ReconstructPath(goalIdx, path);
+		return true;
+	}
+
+	template <class T_NodeType, class T_ConnectionType, AStarEngine T_Engine>
+	bool AStar<T_NodeType, T_ConnectionType, T_Engine>::FindPath(int startIdx, int goalIdx, std::vector<int>& path, OptimizedGraph<T_NodeType, T_ConnectionType>* pOptimization)
+	{
+		path.clear();
+		if (!Search(startIdx, goalIdx, m_Graph.GetNodePos(startIdx), m_Graph.GetNodePos(goalIdx), nullptr, nullptr, pOptimization))
+			return false;
+
+		ReconstructPath(goalIdx, path);
+		return true;
+	}
+
+	template <class T_NodeType, class T_ConnectionType, AStarEngine T_Engine>
+	bool AStar<T_NodeType, T_ConnectionType, T_Engine>::Search(int startIdx, int goalIdx, const Vector2& startPos, const Vector2& goalPos,
+		const SearchEndpoint* pStartEndpoint, const SearchEndpoint* pGoalEndpoint, OptimizedGraph<T_NodeType, T_ConnectionType>* pOptimization)
+	{
+		m_Context.Reset(m_Graph.GetNrOfNodes() + nr_of_virtual_nodes);
+		m_LinearOpenList.clear();
+		SEARCH_STATISTIC(m_LastSearchStatistics = {});
+
+		const bool isPruning = pOptimization && pOptimization->HasBoundingBoxes();
 
 		//Add the start node to OPEN
-		NodeRecord startRecord{};
-		startRecord.pNode = pStartNode;
-		startRecord.pConnection = nullptr;
-		startRecord.estimatedTotalCost = GetHeuristicCost(pStartNode, pGoalNode) + startRecord.costSoFar;
-		openList.push_back(startRecord);
-
-		//Loop
-		while (!openList.empty())
-		{
-			//Set the currentRecord to the best record from the openList (The one with the lowest F-cost)
-			currentRecord = *std::min_element(openList.begin(), openList.end(), [](NodeRecord A, NodeRecord B) {return A < B; });
+		OpenNode(startIdx, 0.f, GetHeuristicCost(startPos, goalPos), invalid_node_index, Engine{});
 
-			//Check if that connection leads to the end node
-			if (currentRecord.pConnection)
-			{
-				if (currentRecord.pConnection->GetTo() == pGoalNode->GetIndex())
-					break;
-			}
+		while (!IsOpenListEmpty(Engine{}))
+		{
+			//Close the node with the lowest F-cost
+			const int currentIdx = CloseBestNode(Engine{});
+			SEARCH_STATISTIC(++m_LastSearchStatistics.nrOfExpandedNodes);
+			if (currentIdx == goalIdx)
+				return true;
 
-			//Else, we get all the connections of the connection's end node (neighbors of the currentNode.pNode)
-			std::list<T_ConnectionType*> connections{ m_pGraph->GetNodeConnections(currentRecord.pNode->GetIndex()) };
+			const float currentCostSoFar = m_Context.GetCostSoFar(currentIdx);
 
-			for (auto& connection : connections)
+			//A virtual start node is only connected to its links
+			if (pStartEndpoint && currentIdx == startIdx)
 			{
-				//optimization part
-				if (pOptimization
-					&& (connection->GetFrom() != pStartNode->GetIndex())
-					&& (connection->GetTo() != pGoalNode->GetIndex()))
+				for (int i{}; i < pStartEndpoint->nrOfLinks; ++i)
 				{
-					if (!pOptimization->IsWithinBoundingBox(currentRecord.pNode, *connection, pGoalNode->GetPosition()))
-						continue;
+					const int toIdx = pStartEndpoint->links[i];
+					const Vector2 toPos = m_Graph.GetNodePos(toIdx);
+					Relax(currentIdx, toIdx, currentCostSoFar + Distance(startPos, toPos), toPos, goalPos);
 				}
+				continue;
+			}
 
-				float totalGCost = connection->GetCost() + currentRecord.costSoFar;
-
-				auto nodeInClosedList{ std::find_if(closedList.begin(), closedList.end(), [&connection](NodeRecord A) {return A.pNode->GetIndex() == connection->GetTo(); }) };
-				auto nodeInOpenList{ std::find_if(openList.begin(), openList.end(), [&connection](NodeRecord A) {return A.pNode->GetIndex() == connection->GetTo(); }) };
-				if (nodeInClosedList != closedList.end())
+			//Else, we get all the connections of the current node
+			//Edges of the start node are never pruned, edges are numbered in connection list order
+			const bool isPruningNode = isPruning && (currentIdx != startIdx);
+			const int firstEdge = isPruningNode ? pOptimization->GetFirstEdge(currentIdx) : 0;
+			const int nrOfEdges = isPruningNode ? pOptimization->GetFirstEdge(currentIdx + 1) - firstEdge : 0;
+			unsigned int withinMask{};
+			m_Graph.ForEachConnection(currentIdx, [&](int edgeNr, int toIdx, float cost, T_ConnectionType*)
 				{
-					if (nodeInClosedList->costSoFar <= totalGCost)
-						continue;
-					else
-						closedList.erase(std::remove(closedList.begin(), closedList.end(), *nodeInClosedList), closedList.end());
-				}
-				else if (nodeInOpenList != openList.end())
-				{
-					if (nodeInOpenList->costSoFar <= totalGCost)
-						continue;
-					else
-						openList.erase(std::remove(openList.begin(), openList.end(), *nodeInOpenList), openList.end());
-				}
+					const int bit = edgeNr % BoundingBoxTable::max_batch_edges;
 
-				NodeRecord newRecord{};
-				newRecord.pConnection = connection;
-				newRecord.pNode = m_pGraph->GetNode(connection->GetTo());
-				newRecord.costSoFar = totalGCost;
-				newRecord.estimatedTotalCost = GetHeuristicCost(newRecord.pNode, pGoalNode) + totalGCost;
-				openList.push_back(newRecord);
+					//optimization part: the goal is tested against the boxes of a whole batch of edges at once
+					if (isPruningNode)
+					{
+						if (bit == 0)
+							withinMask = pOptimization->GetWithinBoundingBoxMask(firstEdge + edgeNr, std::min(nrOfEdges - edgeNr, int(BoundingBoxTable::max_batch_edges)), goalPos);
 
-			}
-			//G Remove NodeRecord from the openList and add it to the closedList.
-			openList.erase(std::remove(openList.begin(), openList.end(), currentRecord), openList.end());
-			closedList.push_back(currentRecord);
+						if (!(withinMask & (1u << bit)) && (toIdx != goalIdx))
+						{
+							SEARCH_STATISTIC(++m_LastSearchStatistics.nrOfPrunedEdges);
+							return;
+						}
+					}
+
+					Relax(currentIdx, toIdx, currentCostSoFar + cost, m_Graph.GetNodePos(toIdx), goalPos);
+				});
+
+			//Links of a virtual goal node get an extra connection to it
+			if (pGoalEndpoint && pGoalEndpoint->IsLinkedTo(currentIdx))
+				Relax(currentIdx, goalIdx, currentCostSoFar + Distance(m_Graph.GetNodePos(currentIdx), goalPos), goalPos, goalPos);
 		}
 
-		//Reconstruct path from last connection to startNode
-		while (currentRecord.pNode != pStartNode)
+		return false;
+	}
+
+	template <class T_NodeType, class T_ConnectionType, AStarEngine T_Engine>
+	void AStar<T_NodeType, T_ConnectionType, T_Engine>::Relax(int fromIdx, int toIdx, float totalGCost, const Vector2& toPos, const Vector2& goalPos)
+	{
+		SEARCH_STATISTIC(++m_LastSearchStatistics.nrOfRelaxedEdges);
+
+		//Already open or closed with a cheaper (or equal) path
+		if (m_Context.IsVisited(toIdx) && m_Context.GetCostSoFar(toIdx) <= totalGCost)
+			return;
+
+		//Opens the node, or reopens it when it was closed before
+		OpenNode(toIdx, totalGCost, GetHeuristicCost(toPos, goalPos) + totalGCost, fromIdx, Engine{});
+		SEARCH_STATISTIC(m_LastSearchStatistics.peakOpenListSize = std::max(m_LastSearchStatistics.peakOpenListSize, GetOpenListSize(Engine{})));
+	}
+
+	template <class T_NodeType, class T_ConnectionType, AStarEngine T_Engine>
+	void AStar<T_NodeType, T_ConnectionType, T_Engine>::ReconstructPath(int goalIdx, std::vector<T_NodeType*>& path) const
+	{
+		//Reconstruct path from goal to startNode by following the parents back, virtual nodes aren't part of the path
+		const int nrOfNodes = m_Graph.GetNrOfNodes();
+		for (int idx = goalIdx; idx != invalid_node_index; idx = m_Context.GetParent(idx))
 		{
-			path.push_back(currentRecord.pNode);
-			currentRecord = *std::find_if(closedList.begin(), closedList.end(), [&currentRecord](NodeRecord A)
-				{ return A.pNode->GetIndex() == currentRecord.pConnection->GetFrom(); });
+			if (idx < nrOfNodes)
+				path.push_back(m_Graph.GetNode(idx));
 		}
-		path.push_back(pStartNode);
 
 		std::reverse(path.begin(), path.end());
+	}
 
-		return path;
+	template <class T_NodeType, class T_ConnectionType, AStarEngine T_Engine>
+	void AStar<T_NodeType, T_ConnectionType, T_Engine>::ReconstructPath(int goalIdx, std::vector<int>& path) const
+	{
+		const int nrOfNodes = m_Graph.GetNrOfNodes();
+		for (int idx = goalIdx; idx != invalid_node_index; idx = m_Context.GetParent(idx))
+		{
+			if (idx < nrOfNodes)
+				path.push_back(idx);
+		}
+
+		std::reverse(path.begin(), path.end());
+	}
+
+	template <class T_NodeType, class T_ConnectionType, AStarEngine T_Engine>
+	void AStar<T_NodeType, T_ConnectionType, T_Engine>::OpenNode(int idx, float costSoFar, float estimatedTotalCost, int parentIdx, LinearScanEngine)
+	{
+		//Closed nodes are reopened, open nodes just get their record updated
+		if (!m_Context.IsOpen(idx))
+			m_LinearOpenList.push_back(idx);
+		m_Context.SetRecord(idx, costSoFar, estimatedTotalCost, parentIdx);
+	}
+
+	template <class T_NodeType, class T_ConnectionType, AStarEngine T_Engine>
+	void AStar<T_NodeType, T_ConnectionType, T_Engine>::OpenNode(int idx, float costSoFar, float estimatedTotalCost, int parentIdx, PriorityQueueEngine)
+	{
+		m_Context.Open(idx, costSoFar, estimatedTotalCost, parentIdx);
+	}
+
+	template <class T_NodeType, class T_ConnectionType, AStarEngine T_Engine>
+	int AStar<T_NodeType, T_ConnectionType, T_Engine>::CloseBestNode(LinearScanEngine)
+	{
+		//Find the open node with the lowest F-cost
+		auto bestIt = std::min_element(m_LinearOpenList.begin(), m_LinearOpenList.end(), [this](int A, int B)
+			{ return m_Context.GetEstimatedTotalCost(A) < m_Context.GetEstimatedTotalCost(B); });
+		const int bestIdx = *bestIt;
+
+		//Remove it from the openList and close it
+		*bestIt = m_LinearOpenList.back();
+		m_LinearOpenList.pop_back();
+		m_Context.SetState(bestIdx, SearchContext::NodeState::Closed);
+
+		return bestIdx;
+	}
+
+	template <class T_NodeType, class T_ConnectionType, AStarEngine T_Engine>
+	int AStar<T_NodeType, T_ConnectionType, T_Engine>::CloseBestNode(PriorityQueueEngine)
+	{
+		//The node with the lowest F-cost is on top of the heap
+		return m_Context.CloseBest();
 	}
 
-	template <class T_NodeType, class T_ConnectionType>
-	float Elite::AStar<T_NodeType, T_ConnectionType>::GetHeuristicCost(T_NodeType* pStartNode, T_NodeType* pEndNode) const
+	template <class T_NodeType, class T_ConnectionType, AStarEngine T_Engine>
+	float Elite::AStar<T_NodeType, T_ConnectionType, T_Engine>::GetHeuristicCost(const Vector2& startPos, const Vector2& endPos) const
 	{
-		Vector2 toDestination = m_pGraph->GetNodePos(pEndNode) - m_pGraph->GetNodePos(pStartNode);
+		Vector2 toDestination = endPos - startPos;
 		return m_HeuristicFunction(abs(toDestination.x), abs(toDestination.y));
 	}
 }
\ No newline at end of file
@@ -1,4 +1,6 @@
 #pragma once
+#include "../ECSRGraph.h"
+#include "ESearchContext.h"
 
 namespace Elite 
 {
@@ -7,15 +9,34 @@ namespace Elite
 	{
 	public:
 		BFS(IGraph<T_NodeType, T_ConnectionType>* pGraph);
+		BFS(const CSRGraph<T_NodeType, T_ConnectionType>* pGraph);
+		// Searches an implicit grid, which has no node objects: use the FindPath overload with cell indices
+		BFS(const ImplicitGridGraph* pGraph);
 
 		std::vector<T_NodeType*> FindPath(T_NodeType* pStartNode, T_NodeType* pDestinationNode);
+		// Path with the least connections by node index, path receives the node indices from start to goal and is left empty when there is no path
+		bool FindPath(int startIdx, int goalIdx, std::vector<int>& path);
 	private:
-		IGraph<T_NodeType, T_ConnectionType>* m_pGraph;
+		GraphView<T_NodeType, T_ConnectionType> m_Graph;
+		SearchContext m_Context; // only the parents are used, reused by every index FindPath call
+		std::vector<int> m_Queue;
 	};
 
 	template <class T_NodeType, class T_ConnectionType>
 	BFS<T_NodeType, T_ConnectionType>::BFS(IGraph<T_NodeType, T_ConnectionType>* pGraph)
-		: m_pGraph(pGraph)
+		: m_Graph(pGraph)
+	{
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	BFS<T_NodeType, T_ConnectionType>::BFS(const CSRGraph<T_NodeType, T_ConnectionType>* pGraph)
+		: m_Graph(pGraph)
+	{
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	BFS<T_NodeType, T_ConnectionType>::BFS(const ImplicitGridGraph* pGraph)
+		: m_Graph(pGraph)
 	{
 	}
 
@@ -38,15 +59,15 @@ namespace Elite
 				break;
 			}
 
-			for (auto con : m_pGraph->GetNodeConnections(currentNode->GetIndex()))
-			{
-				T_NodeType* nextNode = m_pGraph->GetNode(con->GetTo());
-				if (closedList.find(nextNode) == closedList.end())
+			m_Graph.ForEachConnection(currentNode->GetIndex(), [&](int, int toIdx, float, T_ConnectionType*)
 				{
-					openList.push(nextNode);
-					closedList[nextNode] = currentNode;
-				}
-			}
+					T_NodeType* nextNode = m_Graph.GetNode(toIdx);
+					if (closedList.find(nextNode) == closedList.end())
+					{
+						openList.push(nextNode);
+						closedList[nextNode] = currentNode;
+					}
+				});
 		}
 
 		//We reached the goal node
@@ -64,5 +85,39 @@ namespace Elite
 
 		return path;
 	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	bool BFS<T_NodeType, T_ConnectionType>::FindPath(int startIdx, int goalIdx, std::vector<int>& path)
+	{
+		path.clear();
+		m_Context.Reset(m_Graph.GetNrOfNodes());
+		m_Queue.clear();
+
+		//The queue is never popped, the front moves instead so every node is only pushed once
+		m_Context.SetRecord(startIdx, 0.f, 0.f, invalid_node_index);
+		m_Queue.push_back(startIdx);
+		for (size_t front{}; front < m_Queue.size(); ++front)
+		{
+			const int currentIdx = m_Queue[front];
+			if (currentIdx == goalIdx)
+			{
+				for (int idx = goalIdx; idx != invalid_node_index; idx = m_Context.GetParent(idx))
+					path.push_back(idx);
+				std::reverse(path.begin(), path.end());
+				return true;
+			}
+
+			m_Graph.ForEachConnection(currentIdx, [&](int, int toIdx, float, T_ConnectionType*)
+				{
+					if (m_Context.IsVisited(toIdx))
+						return;
+
+					m_Context.SetRecord(toIdx, 0.f, 0.f, currentIdx);
+					m_Queue.push_back(toIdx);
+				});
+		}
+
+		return false;
+	}
 }
 
@@ -5,6 +5,8 @@
 #include <utility>
 #include <vector>
 #include <algorithm>
+#include "../ECSRGraph.h"
+#include "ESearchContext.h"
 
 namespace Elite
 {
@@ -13,6 +15,9 @@ namespace Elite
 	{
 	public:
 		Dijkstra(IGraph<T_NodeType, T_ConnectionType>* pGraph);
+		Dijkstra(const CSRGraph<T_NodeType, T_ConnectionType>* pGraph);
+		// Searches an implicit grid, which has no node objects: use the FindPath overload with cell indices
+		Dijkstra(const ImplicitGridGraph* pGraph);
 
 		// stores the optimal connection to a node and its total costs related to the start and end node of the path
 		struct NodeRecord
@@ -38,13 +43,28 @@ namespace Elite
 
 		std::vector<T_NodeType*> FindPath(T_NodeType* pStartNode, T_NodeType* pDestinationNode);
 		std::vector<T_NodeType*> FindPath(int src);
+		// Cheapest path by node index, path receives the node indices from start to goal and is left empty when there is no path
+		bool FindPath(int startIdx, int goalIdx, std::vector<int>& path);
 	private:
-		IGraph<T_NodeType, T_ConnectionType>* m_pGraph;
+		GraphView<T_NodeType, T_ConnectionType> m_Graph;
+		SearchContext m_Context; // reused by every index FindPath call
 	};
 
 	template <class T_NodeType, class T_ConnectionType>
 	Dijkstra<T_NodeType, T_ConnectionType>::Dijkstra(IGraph<T_NodeType, T_ConnectionType>* pGraph)
-		: m_pGraph(pGraph)
+		: m_Graph(pGraph)
+	{
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	Dijkstra<T_NodeType, T_ConnectionType>::Dijkstra(const CSRGraph<T_NodeType, T_ConnectionType>* pGraph)
+		: m_Graph(pGraph)
+	{
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	Dijkstra<T_NodeType, T_ConnectionType>::Dijkstra(const ImplicitGridGraph* pGraph)
+		: m_Graph(pGraph)
 	{
 	}
 
@@ -77,35 +97,34 @@ namespace Elite
 			}
 
 			//Else, we get all the connections of the connection's end node (neighbors of the currentNode.pNode)
-			std::list<T_ConnectionType*> connections{ m_pGraph->GetNodeConnections(currentRecord.pNode->GetIndex()) };
-			for (auto& connection : connections)
-			{
-				float totalGCost = connection->GetCost() + currentRecord.costSoFar;
-
-				auto nodeInClosedList{ std::find_if(closedList.begin(), closedList.end(), [&connection](NodeRecord A) {return A.pNode->GetIndex() == connection->GetTo(); }) };
-				auto nodeInOpenList{ std::find_if(openList.begin(), openList.end(), [&connection](NodeRecord A) {return A.pNode->GetIndex() == connection->GetTo(); }) };
-				if (nodeInClosedList != closedList.end())
-				{
-					if (nodeInClosedList->costSoFar < totalGCost)
-						continue;
-					else
-						closedList.erase(std::remove(closedList.begin(), closedList.end(), *nodeInClosedList), closedList.end());
-				}
-				else if (nodeInOpenList != openList.end())
+			m_Graph.ForEachConnection(currentRecord.pNode->GetIndex(), [&](int, int toIdx, float cost, T_ConnectionType* connection)
 				{
-					if (nodeInOpenList->costSoFar < totalGCost)
-						continue;
-					else
-						openList.erase(std::remove(openList.begin(), openList.end(), *nodeInOpenList), openList.end());
-				}
-
-				NodeRecord newRecord{};
-				newRecord.pConnection = connection;
-				newRecord.pNode = m_pGraph->GetNode(connection->GetTo());
-				newRecord.costSoFar = totalGCost;
-				newRecord.estimatedTotalCost = totalGCost;
-				openList.push_back(newRecord);
-			}
+					float totalGCost = cost + currentRecord.costSoFar;
+
+					auto nodeInClosedList{ std::find_if(closedList.begin(), closedList.end(), [toIdx](NodeRecord A) {return A.pNode->GetIndex() == toIdx; }) };
+					auto nodeInOpenList{ std::find_if(openList.begin(), openList.end(), [toIdx](NodeRecord A) {return A.pNode->GetIndex() == toIdx; }) };
+					if (nodeInClosedList != closedList.end())
+					{
+						if (nodeInClosedList->costSoFar < totalGCost)
+							return;
+						else
+							closedList.erase(std::remove(closedList.begin(), closedList.end(), *nodeInClosedList), closedList.end());
+					}
+					else if (nodeInOpenList != openList.end())
+					{
+						if (nodeInOpenList->costSoFar < totalGCost)
+							return;
+						else
+							openList.erase(std::remove(openList.begin(), openList.end(), *nodeInOpenList), openList.end());
+					}
+
+					NodeRecord newRecord{};
+					newRecord.pConnection = connection;
+					newRecord.pNode = m_Graph.GetNode(toIdx);
+					newRecord.costSoFar = totalGCost;
+					newRecord.estimatedTotalCost = totalGCost;
+					openList.push_back(newRecord);
+				});
 			//G Remove NodeRecord from the openList and add it to the closedList.
 			openList.erase(std::remove(openList.begin(), openList.end(), currentRecord), openList.end());
 			closedList.push_back(currentRecord);
@@ -134,7 +153,7 @@ namespace Elite
 
 		// Create a vector for distances and initialize all 
 		// distances as infinite (INF) 
-		vector<int> dist(m_pGraph->GetNrOfNodes(), INT_MAX);
+		vector<int> dist(m_Graph.GetNrOfNodes(), INT_MAX);
 
 		// Insert source itself in Set and initialize its 
 		// distance as 0. 
@@ -156,14 +175,12 @@ namespace Elite
 			// in pair) 
 			int u = tmp.second;
 
-			// 'i' is used to get all adjacent vertices of a vertex 
-			auto adjList = m_pGraph->GetNodeConnections(u);
-			for (auto i = adjList.begin(); i != adjList.end(); ++i)
+			// Visit all adjacent vertices of a vertex 
+			m_Graph.ForEachConnection(u, [&](int, int v, float cost, T_ConnectionType*)
 			{
-				// Get vertex label and weight of current adjacent 
+				// Vertex label and weight of current adjacent 
 				// of u. 
-				int v = (*i)->GetFrom();
-				int weight = (*i)->GetCost();
+				int weight = static_cast<int>(cost);
 
 				//  If there is shorter path to v through u. 
 				if (dist[v] > dist[u] + weight)
@@ -181,15 +198,48 @@ namespace Elite
 					dist[v] = dist[u] + weight;
 					setds.insert(make_pair(dist[v], v));
 				}
-			}
+			});
 		}
 
 		// Print shortest distances stored in dist[]
 		printf("Vertex   Distance from Source\n");
-		for (int i = 0; i < m_pGraph->GetNrOfNodes(); ++i)
+		for (int i = 0; i < m_Graph.GetNrOfNodes(); ++i)
 			printf("%d \t\t %d\n", i, dist[i]);
 
 		return std::vector<T_NodeType*>();
 	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	bool Dijkstra<T_NodeType, T_ConnectionType>::FindPath(int startIdx, int goalIdx, std::vector<int>& path)
+	{
+		path.clear();
+		m_Context.Reset(m_Graph.GetNrOfNodes());
+
+		//Without a heuristic the estimated total cost is the cost so far
+		m_Context.Open(startIdx, 0.f, 0.f, invalid_node_index);
+		while (!m_Context.IsOpenListEmpty())
+		{
+			const int currentIdx = m_Context.CloseBest();
+			if (currentIdx == goalIdx)
+			{
+				for (int idx = goalIdx; idx != invalid_node_index; idx = m_Context.GetParent(idx))
+					path.push_back(idx);
+				std::reverse(path.begin(), path.end());
+				return true;
+			}
+
+			const float currentCostSoFar = m_Context.GetCostSoFar(currentIdx);
+			m_Graph.ForEachConnection(currentIdx, [&](int, int toIdx, float cost, T_ConnectionType*)
+				{
+					const float totalGCost = currentCostSoFar + cost;
+					if (m_Context.IsVisited(toIdx) && m_Context.GetCostSoFar(toIdx) <= totalGCost)
+						return;
+
+					m_Context.Open(toIdx, totalGCost, totalGCost, currentIdx);
+				});
+		}
+
+		return false;
+	}
 }
 
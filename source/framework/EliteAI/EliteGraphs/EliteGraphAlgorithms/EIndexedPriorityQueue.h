@@ -0,0 +1,168 @@
+#pragma once
+#include <vector>
+#include <cassert>
+
+namespace Elite
+{
+	// Min-priority queue over node indices, implemented as a 4-ary heap.
+	// A handle table (indexed by node index) keeps track of where every index lives in the heap,
+	// which gives O(1) membership checks and O(log n) decrease-key.
+	class IndexedPriorityQueue final
+	{
+	public:
+		IndexedPriorityQueue() = default;
+		explicit IndexedPriorityQueue(int nrOfIndices) { Resize(nrOfIndices); }
+
+		// Makes room for indices [0, nrOfIndices), never shrinks. Only allowed while the queue is empty.
+		void Resize(int nrOfIndices);
+		// Removes every entry, cost is proportional to the amount of entries left in the queue
+		void Clear();
+
+		bool IsEmpty() const { return m_Heap.empty(); }
+		int GetSize() const { return static_cast<int>(m_Heap.size()); }
+		int GetNrOfIndices() const { return static_cast<int>(m_Handles.size()); }
+
+		bool Contains(int idx) const { return m_Handles[idx] != invalid_handle; }
+		float GetKey(int idx) const { return m_Heap[m_Handles[idx]].key; }
+
+		int Top() const { return m_Heap.front().idx; }
+		float TopKey() const { return m_Heap.front().key; }
+
+		void Push(int idx, float key);
+		int Pop();
+		void DecreaseKey(int idx, float key);
+		// Pushes idx when it's not in the queue yet, lowers its key otherwise
+		void PushOrDecreaseKey(int idx, float key);
+
+	private:
+		struct Entry
+		{
+			float key;
+			int idx;
+		};
+
+		enum
+		{
+			arity = 4,
+			invalid_handle = -1
+		};
+
+		std::vector<Entry> m_Heap;
+		std::vector<int> m_Handles; // heap position of every index, invalid_handle when not queued
+
+		void SiftUp(int pos);
+		void SiftDown(int pos);
+		void Place(const Entry& entry, int pos)
+		{
+			m_Heap[pos] = entry;
+			m_Handles[entry.idx] = pos;
+		}
+	};
+
+	inline void IndexedPriorityQueue::Resize(int nrOfIndices)
+	{
+		assert(m_Heap.empty() && "<IndexedPriorityQueue::Resize>: queue should be empty");
+
+		if (nrOfIndices > static_cast<int>(m_Handles.size()))
+			m_Handles.resize(nrOfIndices, invalid_handle);
+		if (static_cast<int>(m_Heap.capacity()) < nrOfIndices)
+			m_Heap.reserve(nrOfIndices);
+	}
+
+	inline void IndexedPriorityQueue::Clear()
+	{
+		for (const Entry& entry : m_Heap)
+			m_Handles[entry.idx] = invalid_handle;
+		m_Heap.clear();
+	}
+
+	inline void IndexedPriorityQueue::Push(int idx, float key)
+	{
+		assert(idx >= 0 && idx < GetNrOfIndices() && "<IndexedPriorityQueue::Push>: invalid index");
+		assert(!Contains(idx) && "<IndexedPriorityQueue::Push>: index is already queued");
+
+		m_Heap.push_back(Entry{ key, idx });
+		m_Handles[idx] = GetSize() - 1;
+		SiftUp(GetSize() - 1);
+	}
+
+	inline int IndexedPriorityQueue::Pop()
+	{
+		assert(!m_Heap.empty() && "<IndexedPriorityQueue::Pop>: queue is empty");
+
+		const int top = m_Heap.front().idx;
+		m_Handles[top] = invalid_handle;
+
+		const Entry last = m_Heap.back();
+		m_Heap.pop_back();
+		if (!m_Heap.empty())
+		{
+			Place(last, 0);
+			SiftDown(0);
+		}
+		return top;
+	}
+
+	inline void IndexedPriorityQueue::DecreaseKey(int idx, float key)
+	{
+		assert(Contains(idx) && "<IndexedPriorityQueue::DecreaseKey>: index is not queued");
+
+		const int pos = m_Handles[idx];
+		if (key >= m_Heap[pos].key)
+			return;
+
+		m_Heap[pos].key = key;
+		SiftUp(pos);
+	}
+
+	inline void IndexedPriorityQueue::PushOrDecreaseKey(int idx, float key)
+	{
+		if (Contains(idx))
+			DecreaseKey(idx, key);
+		else
+			Push(idx, key);
+	}
+
+	inline void IndexedPriorityQueue::SiftUp(int pos)
+	{
+		const Entry entry = m_Heap[pos];
+		while (pos > 0)
+		{
+			const int parent = (pos - 1) / arity;
+			if (!(entry.key < m_Heap[parent].key))
+				break;
+
+			Place(m_Heap[parent], pos);
+			pos = parent;
+		}
+		Place(entry, pos);
+	}
+
+	inline void IndexedPriorityQueue::SiftDown(int pos)
+	{
+		const Entry entry = m_Heap[pos];
+		const int size = GetSize();
+		while (true)
+		{
+			const int firstChild = pos * arity + 1;
+			if (firstChild >= size)
+				break;
+
+			//Find the smallest child
+			const int lastChild = (firstChild + arity < size) ? firstChild + arity : size;
+			int best = firstChild;
+			for (int child = firstChild + 1; child < lastChild; ++child)
+			{
+				if (m_Heap[child].key < m_Heap[best].key)
+					best = child;
+			}
+
+			if (!(m_Heap[best].key < entry.key))
+				break;
+
+			Place(m_Heap[best], pos);
+			pos = best;
+		}
+		Place(entry, pos);
+	}
+}
@@ -0,0 +1,405 @@
+#pragma once
+#include "EAStar.h"
+#include "../EGridGraph.h"
+
+namespace Elite
+{
+	// Jump Point Search (Harabor and Grastien) on an 8-way connected GridGraph where every straight step costs the same, and so does every diagonal one.
+	// Instead of opening every neighbour, a search "jumps" in a straight or diagonal line until it reaches a cell with a forced neighbour
+	// (a neighbour that is only reached optimally through that cell, next to an obstacle), so only those jump points enter the open list.
+	// JPS+ (Rabin) precomputes how far every cell jumps in every direction, so a jump is a table lookup.
+	// Either one can be combined with the grid goal bounds of OptimizedGraph::ComputeGridBoundingBoxes.
+	// Grids with other costs (mud, a removed connection in between two passable cells, ...) are searched with a regular AStar instead.
+	template <class T_NodeType, class T_ConnectionType>
+	class JumpPointSearch
+	{
+	public:
+		JumpPointSearch(GridGraph<T_NodeType, T_ConnectionType>* pGrid, Heuristic hFunction);
+
+		// Takes a snapshot of which cells are passable and checks whether the costs are uniform, call it again after the grid changed.
+		// With isPrecomputingJumps the jump distances of every cell and direction are stored as well (JPS+)
+		void Build(bool isPrecomputingJumps = false);
+
+		// False before the first Build, FindPath then runs a regular AStar
+		bool IsUniformCost() const { return m_IsUniformCost; }
+		bool HasJumpDistances() const { return !m_JumpDistances.empty(); }
+
+		// Returns every cell of the path, like AStar::FindPath. The goal bounds of pOptimization are only used when they were baked
+		// with ComputeGridBoundingBoxes, the per edge boxes are used by the AStar fallback
+		std::vector<T_NodeType*> FindPath(T_NodeType* pStartNode, T_NodeType* pGoalNode, OptimizedGraph<T_NodeType, T_ConnectionType>* pOptimization = nullptr);
+
+		// Work done by the last FindPath call, always zero when USE_SEARCH_STATISTICS is off. Expanded nodes are jump points,
+		// relaxed edges are jumps that found one and pruned edges are directions skipped because of the goal bounds
+		const SearchStatistics& GetLastSearchStatistics() const { return m_LastSearchStatistics; }
+
+	private:
+		enum { nr_of_directions = GridBoundingBoxTable::nr_of_directions };
+
+		bool Search(int startIdx, int goalIdx, const GridBoundingBoxTable* pGoalBounds);
+		void Relax(int fromIdx, int toIdx, float totalGCost, int direction, int goalIdx);
+		void ReconstructPath(int goalIdx, std::vector<T_NodeType*>& path) const;
+
+		bool IsPassable(int col, int row) const;
+		// Whether entering the cell in the direction (columnOffset, rowOffset) makes it a jump point
+		bool HasForcedNeighbour(int col, int row, int columnOffset, int rowOffset) const;
+		// Mask of the directions to jump in from a cell that was entered in direction, every direction for the start (invalid_node_index)
+		unsigned int GetSuccessorDirections(int col, int row, int direction) const;
+		// Steps to the next jump point (or the goal) in direction, 0 when there is none before an obstacle
+		int Jump(int col, int row, int direction, int goalCol, int goalRow) const;
+		// Same, looked up in the jump distances
+		int JumpWithDistances(int cellIdx, int col, int row, int direction, int goalCol, int goalRow) const;
+		void ComputeJumpDistances();
+
+		float GetHeuristicCost(int fromIdx, int toIdx) const;
+		float GetStepCost(int direction) const { return direction < 4 ? m_StraightCost : m_DiagonalCost; }
+
+		GridGraph<T_NodeType, T_ConnectionType>* m_pGrid;
+		Heuristic m_HeuristicFunction;
+		AStar<T_NodeType, T_ConnectionType> m_AStar; // fallback for grids without uniform costs
+
+		int m_NrOfColumns = 0;
+		int m_NrOfRows = 0;
+		bool m_IsUniformCost = false;
+		float m_StraightCost = 0.f;
+		float m_DiagonalCost = 0.f;
+		std::vector<bool> m_IsPassable; // a cell is passable when it has a connection
+		// JPS+: per cell, nr_of_directions jump distances in GridBoundingBoxTable order. A positive distance is the number of steps to
+		// the next jump point, otherwise it's minus the number of free steps before an obstacle or the border of the grid
+		std::vector<int16_t> m_JumpDistances;
+
+		SearchContext m_Context; // the origin of a jump point is the direction it was entered in
+		SearchStatistics m_LastSearchStatistics;
+	};
+
+	template <class T_NodeType, class T_ConnectionType>
+	JumpPointSearch<T_NodeType, T_ConnectionType>::JumpPointSearch(GridGraph<T_NodeType, T_ConnectionType>* pGrid, Heuristic hFunction)
+		: m_pGrid(pGrid)
+		, m_HeuristicFunction(hFunction)
+		, m_AStar(pGrid, hFunction)
+	{
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	void JumpPointSearch<T_NodeType, T_ConnectionType>::Build(bool isPrecomputingJumps)
+	{
+		m_NrOfColumns = m_pGrid->GetColumns();
+		m_NrOfRows = m_pGrid->GetRows();
+		assert(m_NrOfColumns <= INT16_MAX && m_NrOfRows <= INT16_MAX && "<JumpPointSearch::Build>: jump distances have to fit in 16 bits");
+		const int nrOfCells = m_NrOfColumns * m_NrOfRows;
+		m_IsUniformCost = false;
+		m_JumpDistances.clear();
+
+		//Cost of the step in every direction of every cell, FLT_MAX where there is no connection
+		std::vector<float> stepCosts(static_cast<size_t>(nrOfCells) * nr_of_directions, FLT_MAX);
+		m_IsPassable.assign(nrOfCells, false);
+		for (int i{}; i < nrOfCells; ++i)
+		{
+			if (!m_pGrid->IsNodeValid(i))
+				continue;
+
+			for (const T_ConnectionType* pConnection : m_pGrid->GetNodeConnections(i))
+			{
+				const int direction = GridBoundingBoxTable::GetDirection(pConnection->GetTo() % m_NrOfColumns - i % m_NrOfColumns, pConnection->GetTo() / m_NrOfColumns - i / m_NrOfColumns);
+				if (direction < 0)
+					return;
+
+				stepCosts[static_cast<size_t>(i) * nr_of_directions + direction] = pConnection->GetCost();
+				m_IsPassable[i] = true;
+			}
+		}
+
+		//Uniform: every passable cell is connected to all of its passable neighbours, all straight steps cost the same and so do all diagonal ones.
+		//The pruning rules only hold when a diagonal step is cheaper than two straight ones, but not cheaper than one
+		if (!m_pGrid->IsConnectedDiagonally())
+			return;
+
+		float straightCost{ -1.f }, diagonalCost{ -1.f };
+		for (int i{}; i < nrOfCells; ++i)
+		{
+			if (!m_IsPassable[i])
+				continue;
+
+			for (int direction{}; direction < nr_of_directions; ++direction)
+			{
+				const float cost = stepCosts[static_cast<size_t>(i) * nr_of_directions + direction];
+				const bool isNeighbourPassable = IsPassable(i % m_NrOfColumns + GridBoundingBoxTable::GetColumnOffset(direction), i / m_NrOfColumns + GridBoundingBoxTable::GetRowOffset(direction));
+				if ((cost != FLT_MAX) != isNeighbourPassable)
+					return;
+				if (!isNeighbourPassable)
+					continue;
+
+				float& expectedCost = direction < 4 ? straightCost : diagonalCost;
+				if (expectedCost < 0.f)
+					expectedCost = cost;
+				else if (cost != expectedCost)
+					return;
+			}
+		}
+		if (!(straightCost > 0.f && straightCost < diagonalCost && diagonalCost < 2.f * straightCost))
+			return;
+
+		m_IsUniformCost = true;
+		m_StraightCost = straightCost;
+		m_DiagonalCost = diagonalCost;
+		if (isPrecomputingJumps)
+			ComputeJumpDistances();
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	std::vector<T_NodeType*> JumpPointSearch<T_NodeType, T_ConnectionType>::FindPath(T_NodeType* pStartNode, T_NodeType* pGoalNode, OptimizedGraph<T_NodeType, T_ConnectionType>* pOptimization)
+	{
+		if (!m_IsUniformCost)
+		{
+			std::vector<T_NodeType*> path = m_AStar.FindPath(pStartNode, pGoalNode, pOptimization);
+			SEARCH_STATISTIC(m_LastSearchStatistics = m_AStar.GetLastSearchStatistics());
+			return path;
+		}
+		assert(m_NrOfColumns == m_pGrid->GetColumns() && m_NrOfRows == m_pGrid->GetRows() && "<JumpPointSearch::FindPath>: the grid was resized after Build");
+
+		//Boxes baked for another grid (or only per edge) can't be used
+		const GridBoundingBoxTable* pGoalBounds{};
+		if (pOptimization && pOptimization->GetGridBoundingBoxTable().GetNrOfColumns() == m_NrOfColumns && pOptimization->GetGridBoundingBoxTable().GetNrOfRows() == m_NrOfRows)
+			pGoalBounds = &pOptimization->GetGridBoundingBoxTable();
+
+		std::vector<T_NodeType*> path;
+		const int goalIdx = pGoalNode->GetIndex();
+		if (Search(pStartNode->GetIndex(), goalIdx, pGoalBounds))
+			ReconstructPath(goalIdx, path);
+
+		return path;
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	bool JumpPointSearch<T_NodeType, T_ConnectionType>::Search(int startIdx, int goalIdx, const GridBoundingBoxTable* pGoalBounds)
+	{
+		m_Context.Reset(m_NrOfColumns * m_NrOfRows);
+		SEARCH_STATISTIC(m_LastSearchStatistics = {});
+
+		//Jumps only stop on passable cells, a start without connections can't leave its cell
+		if (startIdx != goalIdx && (!m_IsPassable[startIdx] || !m_IsPassable[goalIdx]))
+			return false;
+
+		const int goalCol = goalIdx % m_NrOfColumns;
+		const int goalRow = goalIdx / m_NrOfColumns;
+		m_Context.Open(startIdx, 0.f, GetHeuristicCost(startIdx, goalIdx), invalid_node_index, invalid_node_index);
+
+		while (!m_Context.IsOpenListEmpty())
+		{
+			//Close the jump point with the lowest F-cost
+			const int currentIdx = m_Context.CloseBest();
+			SEARCH_STATISTIC(++m_LastSearchStatistics.nrOfExpandedNodes);
+			if (currentIdx == goalIdx)
+				return true;
+
+			const int col = currentIdx % m_NrOfColumns;
+			const int row = currentIdx / m_NrOfColumns;
+			const float currentCostSoFar = m_Context.GetCostSoFar(currentIdx);
+			const unsigned int directions = GetSuccessorDirections(col, row, m_Context.GetOrigin(currentIdx));
+			const unsigned int withinMask = pGoalBounds ? pGoalBounds->GetInsideMask(currentIdx, goalCol, goalRow) : ~0u;
+			for (int direction{}; direction < nr_of_directions; ++direction)
+			{
+				if (!(directions & (1u << direction)))
+					continue;
+
+				//optimization part: no optimal path to the goal starts with a step in this direction
+				if (!(withinMask & (1u << direction)))
+				{
+					SEARCH_STATISTIC(++m_LastSearchStatistics.nrOfPrunedEdges);
+					continue;
+				}
+
+				const int nrOfSteps = m_JumpDistances.empty() ? Jump(col, row, direction, goalCol, goalRow) : JumpWithDistances(currentIdx, col, row, direction, goalCol, goalRow);
+				if (nrOfSteps == 0)
+					continue;
+
+				const int toIdx = m_pGrid->GetIndex(col + nrOfSteps * GridBoundingBoxTable::GetColumnOffset(direction), row + nrOfSteps * GridBoundingBoxTable::GetRowOffset(direction));
+				Relax(currentIdx, toIdx, currentCostSoFar + nrOfSteps * GetStepCost(direction), direction, goalIdx);
+			}
+		}
+
+		return false;
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	void JumpPointSearch<T_NodeType, T_ConnectionType>::Relax(int fromIdx, int toIdx, float totalGCost, int direction, int goalIdx)
+	{
+		SEARCH_STATISTIC(++m_LastSearchStatistics.nrOfRelaxedEdges);
+
+		//Already open or closed with a cheaper (or equal) path
+		if (m_Context.IsVisited(toIdx) && m_Context.GetCostSoFar(toIdx) <= totalGCost)
+			return;
+
+		m_Context.Open(toIdx, totalGCost, GetHeuristicCost(toIdx, goalIdx) + totalGCost, fromIdx, direction);
+		SEARCH_STATISTIC(m_LastSearchStatistics.peakOpenListSize = std::max(m_LastSearchStatistics.peakOpenListSize, m_Context.GetOpenListSize()));
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	void JumpPointSearch<T_NodeType, T_ConnectionType>::ReconstructPath(int goalIdx, std::vector<T_NodeType*>& path) const
+	{
+		//Follow the jump points back to the start, the cells in between two of them are on a straight or diagonal line
+		for (int idx = goalIdx; idx != invalid_node_index; idx = m_Context.GetParent(idx))
+		{
+			path.push_back(m_pGrid->GetNode(idx));
+
+			const int parentIdx = m_Context.GetParent(idx);
+			if (parentIdx == invalid_node_index)
+				break;
+
+			int col = idx % m_NrOfColumns;
+			int row = idx / m_NrOfColumns;
+			const int parentCol = parentIdx % m_NrOfColumns;
+			const int parentRow = parentIdx / m_NrOfColumns;
+			const int columnOffset = (parentCol > col) - (parentCol < col);
+			const int rowOffset = (parentRow > row) - (parentRow < row);
+			for (col += columnOffset, row += rowOffset; col != parentCol || row != parentRow; col += columnOffset, row += rowOffset)
+				path.push_back(m_pGrid->GetNode(m_pGrid->GetIndex(col, row)));
+		}
+
+		std::reverse(path.begin(), path.end());
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	inline bool JumpPointSearch<T_NodeType, T_ConnectionType>::IsPassable(int col, int row) const
+	{
+		return m_pGrid->IsWithinBounds(col, row) && m_IsPassable[m_pGrid->GetIndex(col, row)];
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	bool JumpPointSearch<T_NodeType, T_ConnectionType>::HasForcedNeighbour(int col, int row, int columnOffset, int rowOffset) const
+	{
+		//A blocked cell next to the line, with a passable cell past it that would otherwise be reached around the obstacle
+		if (columnOffset != 0 && rowOffset != 0)
+			return (!IsPassable(col - columnOffset, row) && IsPassable(col - columnOffset, row + rowOffset))
+				|| (!IsPassable(col, row - rowOffset) && IsPassable(col + columnOffset, row - rowOffset));
+		if (columnOffset != 0)
+			return (!IsPassable(col, row + 1) && IsPassable(col + columnOffset, row + 1))
+				|| (!IsPassable(col, row - 1) && IsPassable(col + columnOffset, row - 1));
+		return (!IsPassable(col + 1, row) && IsPassable(col + 1, row + rowOffset))
+			|| (!IsPassable(col - 1, row) && IsPassable(col - 1, row + rowOffset));
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	unsigned int JumpPointSearch<T_NodeType, T_ConnectionType>::GetSuccessorDirections(int col, int row, int direction) const
+	{
+		if (direction == invalid_node_index)
+			return (1u << nr_of_directions) - 1;
+
+		//The natural neighbours: straight ahead, and for a diagonal both of its straight components
+		const int columnOffset = GridBoundingBoxTable::GetColumnOffset(direction);
+		const int rowOffset = GridBoundingBoxTable::GetRowOffset(direction);
+		unsigned int directions = 1u << direction;
+		const auto add = [&directions](int dc, int dr) { directions |= 1u << GridBoundingBoxTable::GetDirection(dc, dr); };
+		if (columnOffset != 0 && rowOffset != 0)
+		{
+			add(columnOffset, 0);
+			add(0, rowOffset);
+			if (!IsPassable(col - columnOffset, row))
+				add(-columnOffset, rowOffset);
+			if (!IsPassable(col, row - rowOffset))
+				add(columnOffset, -rowOffset);
+		}
+		else if (columnOffset != 0)
+		{
+			if (!IsPassable(col, row + 1))
+				add(columnOffset, 1);
+			if (!IsPassable(col, row - 1))
+				add(columnOffset, -1);
+		}
+		else
+		{
+			if (!IsPassable(col + 1, row))
+				add(1, rowOffset);
+			if (!IsPassable(col - 1, row))
+				add(-1, rowOffset);
+		}
+		return directions;
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	int JumpPointSearch<T_NodeType, T_ConnectionType>::Jump(int col, int row, int direction, int goalCol, int goalRow) const
+	{
+		const int columnOffset = GridBoundingBoxTable::GetColumnOffset(direction);
+		const int rowOffset = GridBoundingBoxTable::GetRowOffset(direction);
+		const bool isDiagonal = columnOffset != 0 && rowOffset != 0;
+		for (int nrOfSteps{ 1 };; ++nrOfSteps)
+		{
+			col += columnOffset;
+			row += rowOffset;
+			if (!IsPassable(col, row))
+				return 0;
+			if ((col == goalCol && row == goalRow) || HasForcedNeighbour(col, row, columnOffset, rowOffset))
+				return nrOfSteps;
+
+			//A diagonal stops where one of its straight components finds a jump point
+			if (isDiagonal && (Jump(col, row, GridBoundingBoxTable::GetDirection(columnOffset, 0), goalCol, goalRow) > 0
+				|| Jump(col, row, GridBoundingBoxTable::GetDirection(0, rowOffset), goalCol, goalRow) > 0))
+				return nrOfSteps;
+		}
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	int JumpPointSearch<T_NodeType, T_ConnectionType>::JumpWithDistances(int cellIdx, int col, int row, int direction, int goalCol, int goalRow) const
+	{
+		const int distance = m_JumpDistances[static_cast<size_t>(cellIdx) * nr_of_directions + direction];
+		const int nrOfFreeSteps = std::abs(distance);
+		const int columnOffset = GridBoundingBoxTable::GetColumnOffset(direction);
+		const int rowOffset = GridBoundingBoxTable::GetRowOffset(direction);
+
+		//The distances don't know the goal: stop on it when it's on the line before the jump point or obstacle.
+		//A diagonal stops where the goal is straight ahead of it, the straight jumps from there find it
+		int nrOfStepsToGoal{};
+		if (rowOffset == 0)
+			nrOfStepsToGoal = (goalRow == row) ? (goalCol - col) * columnOffset : 0;
+		else if (columnOffset == 0)
+			nrOfStepsToGoal = (goalCol == col) ? (goalRow - row) * rowOffset : 0;
+		else
+			nrOfStepsToGoal = std::min((goalCol - col) * columnOffset, (goalRow - row) * rowOffset);
+
+		if (nrOfStepsToGoal > 0 && nrOfStepsToGoal <= nrOfFreeSteps)
+			return nrOfStepsToGoal;
+		return std::max(distance, 0);
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	void JumpPointSearch<T_NodeType, T_ConnectionType>::ComputeJumpDistances()
+	{
+		m_JumpDistances.assign(static_cast<size_t>(m_NrOfColumns) * m_NrOfRows * nr_of_directions, 0);
+
+		//Every cell follows from the next one in the direction, so the cells are visited against the direction.
+		//The straight directions come first, a diagonal stops where one of its straight components has a jump point
+		for (int direction{}; direction < nr_of_directions; ++direction)
+		{
+			const int columnOffset = GridBoundingBoxTable::GetColumnOffset(direction);
+			const int rowOffset = GridBoundingBoxTable::GetRowOffset(direction);
+			const bool isDiagonal = columnOffset != 0 && rowOffset != 0;
+			const int columnDirection = isDiagonal ? GridBoundingBoxTable::GetDirection(columnOffset, 0) : direction;
+			const int rowDirection = isDiagonal ? GridBoundingBoxTable::GetDirection(0, rowOffset) : direction;
+			for (int i{}; i < m_NrOfRows; ++i)
+			{
+				const int row = rowOffset > 0 ? m_NrOfRows - 1 - i : i;
+				for (int j{}; j < m_NrOfColumns; ++j)
+				{
+					const int col = columnOffset > 0 ? m_NrOfColumns - 1 - j : j;
+					const int nextCol = col + columnOffset;
+					const int nextRow = row + rowOffset;
+					if (!IsPassable(col, row) || !IsPassable(nextCol, nextRow))
+						continue;
+
+					const size_t next = static_cast<size_t>(m_pGrid->GetIndex(nextCol, nextRow)) * nr_of_directions;
+					const bool isJumpPoint = HasForcedNeighbour(nextCol, nextRow, columnOffset, rowOffset)
+						|| (isDiagonal && (m_JumpDistances[next + columnDirection] > 0 || m_JumpDistances[next + rowDirection] > 0));
+					const int16_t nextDistance = m_JumpDistances[next + direction];
+					m_JumpDistances[static_cast<size_t>(m_pGrid->GetIndex(col, row)) * nr_of_directions + direction] =
+						isJumpPoint ? 1 : static_cast<int16_t>(nextDistance > 0 ? nextDistance + 1 : nextDistance - 1);
+				}
+			}
+		}
+	}
+
+	template <class T_NodeType, class T_ConnectionType>
+	inline float JumpPointSearch<T_NodeType, T_ConnectionType>::GetHeuristicCost(int fromIdx, int toIdx) const
+	{
+		//Same heuristic as AStar on a grid: the distance in cells
+		return m_HeuristicFunction(float(std::abs(toIdx % m_NrOfColumns - fromIdx % m_NrOfColumns)), float(std::abs(toIdx / m_NrOfColumns - fromIdx / m_NrOfColumns)));
+	}
+}
@@ -0,0 +1,115 @@
+#pragma once
+#include <vector>
+#include <algorithm>
+#include <cassert>
+#include "../EGraphEnums.h"
+#include "EIndexedPriorityQueue.h"
+
+namespace Elite
+{
+	// Per-node search state of a graph search, stored in flat arrays indexed by node index.
+	// Every record is stamped with the generation of the search that wrote it, so starting a new search
+	// only bumps the generation instead of clearing the arrays. Once the arrays are big enough for the graph,
+	// repeated searches don't allocate anymore.
+	class SearchContext final
+	{
+	public:
+		enum class NodeState : unsigned char
+		{
+			Unvisited,
+			Open,
+			Closed
+		};
+
+		SearchContext() = default;
+		explicit SearchContext(int nrOfNodes) { Reset(nrOfNodes); }
+
+		// Starts a new search over node indices [0, nrOfNodes), invalidates every record of the previous search
+		void Reset(int nrOfNodes);
+
+		int GetNrOfNodes() const { return static_cast<int>(m_Generations.size()); }
+
+		NodeState GetState(int idx) const { return IsVisited(idx) ? m_States[idx] : NodeState::Unvisited; }
+		bool IsVisited(int idx) const { return m_Generations[idx] == m_Generation; }
+		bool IsOpen(int idx) const { return GetState(idx) == NodeState::Open; }
+		bool IsClosed(int idx) const { return GetState(idx) == NodeState::Closed; }
+
+		// Only meaningful for visited nodes
+		float GetCostSoFar(int idx) const { return m_CostsSoFar[idx]; }
+		float GetEstimatedTotalCost(int idx) const { return m_EstimatedTotalCosts[idx]; }
+		int GetParent(int idx) const { return m_Parents[idx]; }
+		int GetOrigin(int idx) const { return m_Origins[idx]; }
+
+		// Records a (better) path to idx and marks it open, without touching the open list
+		void SetRecord(int idx, float costSoFar, float estimatedTotalCost, int parentIdx, int originIdx = invalid_node_index);
+		void SetState(int idx, NodeState state) { assert(IsVisited(idx)); m_States[idx] = state; }
+
+		// Records a (better) path to idx and pushes it on the open list, reopening it when it was closed
+		void Open(int idx, float costSoFar, float estimatedTotalCost, int parentIdx, int originIdx = invalid_node_index);
+		// Pops the open node with the lowest estimated total cost and closes it
+		int CloseBest();
+
+		bool IsOpenListEmpty() const { return m_OpenList.IsEmpty(); }
+		int GetOpenListSize() const { return m_OpenList.GetSize(); }
+
+	private:
+		std::vector<float> m_CostsSoFar;
+		std::vector<float> m_EstimatedTotalCosts;
+		std::vector<int> m_Parents; // node index the best known path comes from
+		std::vector<int> m_Origins; // first node after the start on the best known path, used by EnhancedDijkstra
+		std::vector<NodeState> m_States;
+		std::vector<unsigned int> m_Generations;
+		unsigned int m_Generation = 0;
+
+		IndexedPriorityQueue m_OpenList;
+	};
+
+	inline void SearchContext::Reset(int nrOfNodes)
+	{
+		m_OpenList.Clear();
+
+		if (nrOfNodes > GetNrOfNodes())
+		{
+			m_CostsSoFar.resize(nrOfNodes);
+			m_EstimatedTotalCosts.resize(nrOfNodes);
+			m_Parents.resize(nrOfNodes);
+			m_Origins.resize(nrOfNodes);
+			m_States.resize(nrOfNodes);
+			m_Generations.resize(nrOfNodes, 0);
+			m_OpenList.Resize(nrOfNodes);
+		}
+
+		//Generation 0 is never used by a search, so on wrap around every record is stamped with it again
+		++m_Generation;
+		if (m_Generation == 0)
+		{
+			std::fill(m_Generations.begin(), m_Generations.end(), 0);
+			m_Generation = 1;
+		}
+	}
+
+	inline void SearchContext::SetRecord(int idx, float costSoFar, float estimatedTotalCost, int parentIdx, int originIdx)
+	{
+		assert(idx >= 0 && idx < GetNrOfNodes() && "<SearchContext::SetRecord>: invalid node index");
+
+		m_CostsSoFar[idx] = costSoFar;
+		m_EstimatedTotalCosts[idx] = estimatedTotalCost;
+		m_Parents[idx] = parentIdx;
+		m_Origins[idx] = originIdx;
+		m_States[idx] = NodeState::Open;
+		m_Generations[idx] = m_Generation;
+	}
+
+	inline void SearchContext::Open(int idx, float costSoFar, float estimatedTotalCost, int parentIdx, int originIdx)
+	{
+		SetRecord(idx, costSoFar, estimatedTotalCost, parentIdx, originIdx);
+		m_OpenList.PushOrDecreaseKey(idx, estimatedTotalCost);
+	}
+
+	inline int SearchContext::CloseBest()
+	{
+		const int idx = m_OpenList.Pop();
+		m_States[idx] = NodeState::Closed;
+		return idx;
+	}
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include <cassert>
+#include "../EGraphEnums.h"
+
+namespace Elite
+{
+	// Start or goal of a query that isn't a node of the graph, e.g. an agent position inside a navmesh triangle.
+	// For the duration of a single search it behaves like a node linked to a handful of graph nodes
+	// (the portals of its triangle), the connection cost being the straight distance to them.
+	// The graph itself is never modified.
+	struct SearchEndpoint
+	{
+		enum { max_links = 4 };
+
+		SearchEndpoint() = default;
+		explicit SearchEndpoint(const Vector2& pos) : position{ pos } {}
+
+		void AddLink(int nodeIdx)
+		{
+			assert(nrOfLinks < max_links && "<SearchEndpoint::AddLink>: too many links");
+			links[nrOfLinks++] = nodeIdx;
+		}
+
+		bool IsLinkedTo(int nodeIdx) const
+		{
+			for (int i{}; i < nrOfLinks; ++i)
+			{
+				if (links[i] == nodeIdx)
+					return true;
+			}
+			return false;
+		}
+
+		Vector2 position = {};
+		int links[max_links] = { invalid_node_index, invalid_node_index, invalid_node_index, invalid_node_index };
+		int nrOfLinks = 0;
+	};
+}
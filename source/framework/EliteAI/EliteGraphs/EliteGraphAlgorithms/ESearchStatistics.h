@@ -0,0 +1,190 @@
+#pragma once
+#include <ostream>
+#include <cfloat>
+#include <cmath>
+#include <algorithm>
+#include <chrono>
+
+namespace Elite
+{
+	//=== Options ===
+	//Off by default, define USE_SEARCH_STATISTICS in the project or on the command line (/DUSE_SEARCH_STATISTICS) to count and time
+	//every search. Without it SEARCH_STATISTIC(...) expands to nothing and every counter stays 0
+
+#ifdef USE_SEARCH_STATISTICS
+	#define SEARCH_STATISTIC(expression) expression
+#else
+	#define SEARCH_STATISTIC(expression)
+#endif
+
+	// Work done by a single search, all zero when the statistics are compiled out
+	struct SearchStatistics
+	{
+		int nrOfExpandedNodes = 0; // nodes taken from the open list, a reopened node counts every time
+		int nrOfRelaxedEdges = 0; // edges that were followed, whether or not they improved the path to their node
+		int nrOfPrunedEdges = 0; // edges skipped because the goal is outside of their bounding box
+		int peakOpenListSize = 0;
+	};
+
+	// Wall-clock time (in seconds) spent in every step of a path query on a navmesh
+	struct PathQueryTimings
+	{
+		float triangleLookupTime = 0.f;
+		float searchTime = 0.f;
+		float findPortalsTime = 0.f;
+		float optimizePortalsTime = 0.f;
+	};
+
+	// Measures the time in between two laps, the first lap starts at construction
+	class StatisticsTimer final
+	{
+	public:
+		//Seconds since the previous lap
+		float Lap()
+		{
+			const auto now = Clock::now();
+			const float seconds = std::chrono::duration<float>(now - m_LapStart).count();
+			m_LapStart = now;
+			return seconds;
+		}
+
+	private:
+		using Clock = std::chrono::high_resolution_clock;
+		Clock::time_point m_LapStart = Clock::now();
+	};
+
+	// Counts samples in power of two buckets: bucket 0 holds [0, 1), bucket i holds [2^(i-1), 2^i).
+	// Percentiles are estimated as the upper bound of the bucket they fall in, so they are off by at most a factor 2.
+	class Histogram final
+	{
+	public:
+		enum { nr_of_buckets = 32 };
+
+		void Add(float value);
+		void Reset() { *this = Histogram{}; }
+
+		int GetNrOfSamples() const { return m_NrOfSamples; }
+		int GetBucketCount(int bucket) const { return m_Buckets[bucket]; }
+		float GetMin() const { return m_NrOfSamples > 0 ? m_Min : 0.f; }
+		float GetMax() const { return m_NrOfSamples > 0 ? m_Max : 0.f; }
+		float GetMean() const { return m_NrOfSamples > 0 ? static_cast<float>(m_Sum / m_NrOfSamples) : 0.f; }
+		float GetPercentile(float percentile) const;
+
+		// One line: name, samples, min, mean, max, p50, p99 and the non empty buckets as upper bound:count
+		void Write(std::ostream& out, const char* name) const;
+
+	private:
+		int m_Buckets[nr_of_buckets] = {};
+		int m_NrOfSamples = 0;
+		double m_Sum = 0.0;
+		float m_Min = FLT_MAX;
+		float m_Max = 0.f;
+
+		static float GetBucketUpperBound(int bucket) { return static_cast<float>(1u << bucket); }
+	};
+
+	// Aggregates the statistics of many path queries, counters as they are and timings in microseconds
+	class SearchStatisticsRecorder final
+	{
+	public:
+		void Record(const SearchStatistics& statistics, const PathQueryTimings& timings);
+		void Reset() { *this = SearchStatisticsRecorder{}; }
+
+		const SearchStatistics& GetLastStatistics() const { return m_LastStatistics; }
+		const PathQueryTimings& GetLastTimings() const { return m_LastTimings; }
+		int GetNrOfQueries() const { return m_ExpandedNodes.GetNrOfSamples(); }
+
+		const Histogram& GetExpandedNodes() const { return m_ExpandedNodes; }
+		const Histogram& GetRelaxedEdges() const { return m_RelaxedEdges; }
+		const Histogram& GetPrunedEdges() const { return m_PrunedEdges; }
+		const Histogram& GetPeakOpenListSize() const { return m_PeakOpenListSize; }
+		const Histogram& GetTriangleLookupTime() const { return m_TriangleLookupTime; }
+		const Histogram& GetSearchTime() const { return m_SearchTime; }
+		const Histogram& GetFindPortalsTime() const { return m_FindPortalsTime; }
+		const Histogram& GetOptimizePortalsTime() const { return m_OptimizePortalsTime; }
+
+		// One line per histogram, see Histogram::Write
+		void Write(std::ostream& out) const;
+
+	private:
+		SearchStatistics m_LastStatistics = {};
+		PathQueryTimings m_LastTimings = {};
+		Histogram m_ExpandedNodes;
+		Histogram m_RelaxedEdges;
+		Histogram m_PrunedEdges;
+		Histogram m_PeakOpenListSize;
+		Histogram m_TriangleLookupTime;
+		Histogram m_SearchTime;
+		Histogram m_FindPortalsTime;
+		Histogram m_OptimizePortalsTime;
+	};
+
+	inline void Histogram::Add(float value)
+	{
+		value = std::max(value, 0.f);
+		int bucket{};
+		while (bucket < nr_of_buckets - 1 && value >= GetBucketUpperBound(bucket))
+			++bucket;
+
+		++m_Buckets[bucket];
+		++m_NrOfSamples;
+		m_Sum += value;
+		m_Min = std::min(m_Min, value);
+		m_Max = std::max(m_Max, value);
+	}
+
+	inline float Histogram::GetPercentile(float percentile) const
+	{
+		if (m_NrOfSamples == 0)
+			return 0.f;
+
+		//The sample the percentile falls on, counted from 1
+		const int rank = std::max(1, static_cast<int>(std::ceil(percentile / 100.f * m_NrOfSamples)));
+		int nrOfSamples{};
+		for (int bucket{}; bucket < nr_of_buckets; ++bucket)
+		{
+			nrOfSamples += m_Buckets[bucket];
+			if (nrOfSamples >= rank)
+				return std::min(GetBucketUpperBound(bucket), m_Max);
+		}
+		return m_Max;
+	}
+
+	inline void Histogram::Write(std::ostream& out, const char* name) const
+	{
+		out << name << ": samples " << m_NrOfSamples << ", min " << GetMin() << ", mean " << GetMean() << ", max " << GetMax()
+			<< ", p50 " << GetPercentile(50.f) << ", p99 " << GetPercentile(99.f) << ", buckets";
+		for (int bucket{}; bucket < nr_of_buckets; ++bucket)
+		{
+			if (m_Buckets[bucket] > 0)
+				out << ' ' << GetBucketUpperBound(bucket) << ':' << m_Buckets[bucket];
+		}
+		out << '\n';
+	}
+
+	inline void SearchStatisticsRecorder::Record(const SearchStatistics& statistics, const PathQueryTimings& timings)
+	{
+		m_LastStatistics = statistics;
+		m_LastTimings = timings;
+		m_ExpandedNodes.Add(static_cast<float>(statistics.nrOfExpandedNodes));
+		m_RelaxedEdges.Add(static_cast<float>(statistics.nrOfRelaxedEdges));
+		m_PrunedEdges.Add(static_cast<float>(statistics.nrOfPrunedEdges));
+		m_PeakOpenListSize.Add(static_cast<float>(statistics.peakOpenListSize));
+		m_TriangleLookupTime.Add(timings.triangleLookupTime * 1e6f);
+		m_SearchTime.Add(timings.searchTime * 1e6f);
+		m_FindPortalsTime.Add(timings.findPortalsTime * 1e6f);
+		m_OptimizePortalsTime.Add(timings.optimizePortalsTime * 1e6f);
+	}
+
+	inline void SearchStatisticsRecorder::Write(std::ostream& out) const
+	{
+		m_ExpandedNodes.Write(out, "expanded nodes");
+		m_RelaxedEdges.Write(out, "relaxed edges");
+		m_PrunedEdges.Write(out, "pruned edges");
+		m_PeakOpenListSize.Write(out, "peak open list size");
+		m_TriangleLookupTime.Write(out, "triangle lookup us");
+		m_SearchTime.Write(out, "search us");
+		m_FindPortalsTime.Write(out, "find portals us");
+		m_OptimizePortalsTime.Write(out, "optimize portals us");
+	}
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include "framework/EliteAI/EliteGraphs/EIGraph.h"
+#include "framework/EliteAI/EliteGraphs/ECSRGraph.h"
+
+namespace Elite
+{
+	// Stable 64-bit FNV-1a hash of everything precomputed graph data depends on: the amount of nodes,
+	// which ones are valid, their positions and every connection (in connection list order) with its cost.
+	// Two graphs with the same fingerprint have the same node and edge numbering, a CSR snapshot has the fingerprint of its graph.
+	template<class T_NodeType, class T_ConnectionType>
+	uint64_t ComputeGraphFingerprint(const GraphView<T_NodeType, T_ConnectionType>& graph)
+	{
+		uint64_t hash{ 14695981039346656037ull };
+		const auto add = [&hash](const void* pData, size_t size)
+		{
+			const unsigned char* pBytes{ static_cast<const unsigned char*>(pData) };
+			for (size_t i{}; i < size; ++i)
+			{
+				hash ^= pBytes[i];
+				hash *= 1099511628211ull;
+			}
+		};
+
+		const int32_t nrOfNodes{ graph.GetNrOfNodes() };
+		add(&nrOfNodes, sizeof(nrOfNodes));
+		for (int idx{}; idx < nrOfNodes; ++idx)
+		{
+			const unsigned char isValid{ graph.IsNodeValid(idx) };
+			add(&isValid, sizeof(isValid));
+			if (!isValid)
+				continue;
+
+			const Vector2 position{ graph.GetNodePos(idx) };
+			add(&position.x, sizeof(position.x));
+			add(&position.y, sizeof(position.y));
+
+			const int32_t nrOfConnections{ graph.GetNrOfConnections(idx) };
+			add(&nrOfConnections, sizeof(nrOfConnections));
+			graph.ForEachConnection(idx, [&add](int, int32_t to, float cost, T_ConnectionType*)
+				{
+					add(&to, sizeof(to));
+					add(&cost, sizeof(cost));
+				});
+		}
+		return hash;
+	}
+
+	template<class T_NodeType, class T_ConnectionType>
+	uint64_t ComputeGraphFingerprint(const IGraph<T_NodeType, T_ConnectionType>* pGraph)
+	{
+		return ComputeGraphFingerprint(GraphView<T_NodeType, T_ConnectionType>{ pGraph });
+	}
+}
@@ -33,41 +33,41 @@ namespace Elite
 			//Container
 			std::vector<Portal> vPortals = {};
 
-			vPortals.push_back(Portal(Line(nodePath[0]->GetPosition(), nodePath[0]->GetPosition())));
-
-			//For each node received, get it's corresponding line
-			for (size_t i = 1; i < nodePath.size() - 1; ++i)
-			{
-				//Local variables
-				auto pNode = nodePath[i]; //Store node, except last node, because this is our target node!
-				auto pLine = navMeshPolygon->GetLines()[pNode->GetLineIndex()];
-
-				//Redetermine it's "orientation" based on the required path (left-right vs right-left) - p1 should be right point
-				auto centerLine = (pLine->p1 + pLine->p2) / 2.0f;
-				auto previousPosition = i == 0 ? nodePath[0]->GetPosition() : nodePath[i - 1]->GetPosition();
-				auto cp = Cross((centerLine - previousPosition), (pLine->p1 - previousPosition));
-				Line portalLine = {};
-				if (cp > 0)//Left
-					portalLine = Line(pLine->p2, pLine->p1);
-				else //Right
-					portalLine = Line(pLine->p1, pLine->p2);
-
-				//Store portal
-				vPortals.push_back(Portal(portalLine));
-			}
-			//Add degenerate portal to force end evaluation
-			vPortals.push_back(Portal(Line(nodePath[nodePath.size() - 1]->GetPosition(), nodePath[nodePath.size() - 1]->GetPosition())));
+			//Every node except the first and the last one lies on a portal, those two are the start and target of the path
+			const size_t nrOfPortalNodes = nodePath.size() > 2 ? nodePath.size() - 2 : 0;
+			AddPortals(nodePath[0]->GetPosition(), nodePath.data() + 1, nrOfPortalNodes, nodePath[nodePath.size() - 1]->GetPosition(), navMeshPolygon, vPortals);
 
 			return vPortals;
 		}
 
+		//Same as above for a path between two positions, nodePath only contains the portal nodes in between (see SearchEndpoint).
+		//vPortals is cleared first, so it can be reused between queries.
+		static void FindPortals(
+			const Elite::Vector2& startPos,
+			const std::vector<NavGraphNode*>& nodePath,
+			const Elite::Vector2& endPos,
+			Polygon* navMeshPolygon,
+			std::vector<Portal>& vPortals)
+		{
+			vPortals.clear();
+			AddPortals(startPos, nodePath.data(), nodePath.size(), endPos, navMeshPolygon, vPortals);
+		}
+
 		static std::vector<Elite::Vector2> OptimizePortals(const std::vector<Portal>& portals)
 		{
+			std::vector<Elite::Vector2> vPath = {};
+			OptimizePortals(portals, vPath);
+			return vPath;
+		}
+
+		//vPath is cleared first, so it can be reused between queries
+		static void OptimizePortals(const std::vector<Portal>& portals, std::vector<Elite::Vector2>& vPath)
+		{
+			vPath.clear();
 			if (portals.empty())
-				return std::vector<Elite::Vector2>{};
+				return;
 
 			//P2 == right point of portal, P1 == left point of portal
-			std::vector<Elite::Vector2> vPath = {};
 			auto apex = portals[0].Line.p1;
 			auto apexIndex = 0, leftLegIndex = 1, rightLegIndex = 1;
 			auto rightLeg = portals[rightLegIndex].Line.p2 - apex;
@@ -159,9 +159,42 @@ namespace Elite
 
 			// Add last path point (You can use the last portal p1 or p2 points as both are equal to the endPoint of the path
 			vPath.push_back(portals.back().Line.p1);
-			return vPath;
 		}
 	private:
+		static void AddPortals(
+			const Elite::Vector2& startPos,
+			NavGraphNode* const* pPortalNodes,
+			size_t nrOfPortalNodes,
+			const Elite::Vector2& endPos,
+			Polygon* navMeshPolygon,
+			std::vector<Portal>& vPortals)
+		{
+			vPortals.push_back(Portal(Line(startPos, startPos)));
+
+			//For each node received, get it's corresponding line
+			for (size_t i = 0; i < nrOfPortalNodes; ++i)
+			{
+				//Local variables
+				auto pNode = pPortalNodes[i];
+				auto pLine = navMeshPolygon->GetLines()[pNode->GetLineIndex()];
+
+				//Redetermine it's "orientation" based on the required path (left-right vs right-left) - p1 should be right point
+				auto centerLine = (pLine->p1 + pLine->p2) / 2.0f;
+				auto previousPosition = i == 0 ? startPos : pPortalNodes[i - 1]->GetPosition();
+				auto cp = Cross((centerLine - previousPosition), (pLine->p1 - previousPosition));
+				Line portalLine = {};
+				if (cp > 0)//Left
+					portalLine = Line(pLine->p2, pLine->p1);
+				else //Right
+					portalLine = Line(pLine->p1, pLine->p2);
+
+				//Store portal
+				vPortals.push_back(Portal(portalLine));
+			}
+			//Add degenerate portal to force end evaluation
+			vPortals.push_back(Portal(Line(endPos, endPos)));
+		}
+
 		SSFA() {};
 		~SSFA() {};
 	};
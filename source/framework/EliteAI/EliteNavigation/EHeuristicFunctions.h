@@ -12,6 +12,12 @@ namespace Elite
 {
 	namespace HeuristicFunctions
 	{
+		//No estimate, turns A* into Dijkstra
+		static float Zero(float, float)
+		{
+			return 0.f;
+		}
+
 		//Manhattan distance
 		static float Manhattan(float x, float y)
 		{
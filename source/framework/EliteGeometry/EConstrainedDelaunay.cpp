@@ -0,0 +1,752 @@
+/*=============================================================================*/
+// Copyright 2021 Elite Engine
+/*=============================================================================*/
+// EConstrainedDelaunay.cpp: Implementation of the constrained Delaunay triangulation.
+/*=============================================================================*/
+#include "stdafx.h"
+#include "EConstrainedDelaunay.h"
+
+namespace
+{
+	//Upper bound of flips and splits per point, the triangulation gives up instead of looping on broken input
+	const int max_work_per_point = 256;
+}
+
+void Elite::ConstrainedDelaunay::AddContour(const std::list<Vector2>& contour)
+{
+	m_Contours.emplace_back(contour.begin(), contour.end());
+}
+
+void Elite::ConstrainedDelaunay::AddSegment(const Vector2& from, const Vector2& to)
+{
+	m_Contours.push_back({ from, to });
+}
+
+void Elite::ConstrainedDelaunay::Clear()
+{
+	m_Contours.clear();
+	m_Points.clear();
+	m_Faces.clear();
+	m_VertexFaces.clear();
+	m_LastFace = 0;
+	m_WalkCounter = 0;
+}
+
+bool Elite::ConstrainedDelaunay::Triangulate(std::vector<std::array<Vector2, 3>>& triangles)
+{
+	triangles.clear();
+	if (m_Contours.empty() || m_Contours[0].size() < 3 || !Build())
+		return false;
+
+	std::vector<std::array<double, 4>> bounds; //min x, min y, max x, max y per contour
+	bounds.reserve(m_Contours.size());
+	for (const auto& contour : m_Contours)
+	{
+		std::array<double, 4> b{ DBL_MAX, DBL_MAX, -DBL_MAX, -DBL_MAX };
+		for (const Vector2& p : contour)
+		{
+			b[0] = min(b[0], static_cast<double>(p.x)); b[1] = min(b[1], static_cast<double>(p.y));
+			b[2] = max(b[2], static_cast<double>(p.x)); b[3] = max(b[3], static_cast<double>(p.y));
+		}
+		bounds.push_back(b);
+	}
+	KeepInsideFaces(triangles, [&](const Point& p)
+	{
+		for (size_t c{}; c < m_Contours.size(); ++c)
+		{
+			const bool isOutsideBounds = p.x < bounds[c][0] || p.y < bounds[c][1] || p.x > bounds[c][2] || p.y > bounds[c][3];
+			if (c == 0 && (isOutsideBounds || !IsInsideContour(m_Contours[c], p)))
+				return false;
+			if (c != 0 && !isOutsideBounds && IsInsideContour(m_Contours[c], p))
+				return false;
+		}
+		return true;
+	});
+	return !triangles.empty();
+}
+
+bool Elite::ConstrainedDelaunay::Triangulate(std::vector<std::array<Vector2, 3>>& triangles, const std::function<bool(const Vector2&)>& isInside)
+{
+	triangles.clear();
+	if (m_Contours.empty() || !Build())
+		return false;
+
+	KeepInsideFaces(triangles, [&isInside](const Point& p)
+	{ return isInside(Vector2{ static_cast<float>(p.x), static_cast<float>(p.y) }); });
+	return true;
+}
+
+bool Elite::ConstrainedDelaunay::Build()
+{
+	m_Points.clear();
+	m_Faces.clear();
+	m_VertexFaces.clear();
+
+	//Gather all points, remembering which contour point they are
+	size_t nrOfPoints{};
+	for (const auto& contour : m_Contours)
+		nrOfPoints += contour.size();
+
+	std::vector<std::pair<int, int>> order; //contour, point in contour
+	order.reserve(nrOfPoints);
+	for (int c{}; c < static_cast<int>(m_Contours.size()); ++c)
+		for (int p{}; p < static_cast<int>(m_Contours[c].size()); ++p)
+			order.emplace_back(c, p);
+
+	CreateSuperTriangle();
+
+	//Insert in serpentine grid order so every walk starts next to the previous point
+	Vector2 minPos = m_Contours[0][0];
+	Vector2 maxPos = minPos;
+	for (const auto& contour : m_Contours)
+	{
+		for (const Vector2& p : contour)
+		{
+			minPos.x = min(minPos.x, p.x); minPos.y = min(minPos.y, p.y);
+			maxPos.x = max(maxPos.x, p.x); maxPos.y = max(maxPos.y, p.y);
+		}
+	}
+	const int gridSize = max(1, static_cast<int>(sqrt(static_cast<float>(nrOfPoints) / 4.f)));
+	const Vector2 extent = maxPos - minPos;
+	auto getCell = [&](const std::pair<int, int>& o)
+	{
+		const Vector2& p = m_Contours[o.first][o.second];
+		const int column = extent.x > 0.f ? min(gridSize - 1, static_cast<int>((p.x - minPos.x) / extent.x * gridSize)) : 0;
+		const int row = extent.y > 0.f ? min(gridSize - 1, static_cast<int>((p.y - minPos.y) / extent.y * gridSize)) : 0;
+		return std::make_pair(row, (row % 2) ? gridSize - 1 - column : column);
+	};
+	std::stable_sort(order.begin(), order.end(),
+		[&getCell](const std::pair<int, int>& a, const std::pair<int, int>& b) { return getCell(a) < getCell(b); });
+
+	std::vector<std::vector<int>> contourVertices(m_Contours.size());
+	for (size_t c{}; c < m_Contours.size(); ++c)
+		contourVertices[c].resize(m_Contours[c].size());
+	for (const auto& o : order)
+	{
+		const Vector2& p = m_Contours[o.first][o.second];
+		const int v = InsertPoint({ p.x, p.y });
+		if (v < 0)
+			return false;
+		contourVertices[o.first][o.second] = v;
+	}
+
+	//Recover all contour edges, segments aren't closed
+	for (const auto& vertices : contourVertices)
+	{
+		const size_t nrOfEdges = vertices.size() == 2 ? 1 : vertices.size();
+		for (size_t i{}; i < nrOfEdges; ++i)
+		{
+			if (!InsertConstraint(vertices[i], vertices[(i + 1) % vertices.size()]))
+				return false;
+		}
+	}
+
+	return true;
+}
+
+void Elite::ConstrainedDelaunay::CreateSuperTriangle()
+{
+	double minX = m_Contours[0][0].x, maxX = minX, minY = m_Contours[0][0].y, maxY = minY;
+	for (const auto& contour : m_Contours)
+	{
+		for (const Vector2& p : contour)
+		{
+			minX = min(minX, static_cast<double>(p.x)); maxX = max(maxX, static_cast<double>(p.x));
+			minY = min(minY, static_cast<double>(p.y)); maxY = max(maxY, static_cast<double>(p.y));
+		}
+	}
+	const double size = max(max(maxX - minX, maxY - minY), 1.0);
+	const double centerX = (minX + maxX) * 0.5;
+	const double centerY = (minY + maxY) * 0.5;
+
+	//Far enough to never be inside the circumcircle of a triangle of real points that matters
+	m_Points.push_back({ centerX - 20.0 * size, centerY - 10.0 * size });
+	m_Points.push_back({ centerX + 20.0 * size, centerY - 10.0 * size });
+	m_Points.push_back({ centerX, centerY + 20.0 * size });
+	m_VertexFaces.assign(nr_of_super_vertices, 0);
+	AddFace(0, 1, 2);
+	m_LastFace = 0;
+}
+
+int Elite::ConstrainedDelaunay::InsertPoint(const Point& p)
+{
+	int edge{ -1 }, vertex{ -1 };
+	const int f = Locate(p, edge, vertex);
+	if (f < 0)
+		return -1;
+	if (vertex >= 0)
+		return vertex; //duplicate point
+
+	const int v = static_cast<int>(m_Points.size());
+	m_Points.push_back(p);
+	m_VertexFaces.push_back(f);
+	if (edge >= 0)
+		SplitEdge(f, edge, v);
+	else
+		SplitFace(f, v);
+	return v;
+}
+
+int Elite::ConstrainedDelaunay::Locate(const Point& p, int& edge, int& vertex)
+{
+	//Stochastic walk, starting at a random edge every step so it can't cycle
+	int f = m_LastFace;
+	const int maxSteps = static_cast<int>(m_Faces.size()) * 4 + 16;
+	for (int step{}; step < maxSteps; ++step)
+	{
+		const Face& face = m_Faces[f];
+		const int start = static_cast<int>(++m_WalkCounter % 3);
+		int next{ -1 };
+		for (int k{}; k < 3; ++k)
+		{
+			const int i = (start + k) % 3;
+			const Point& a = m_Points[face.vertices[(i + 1) % 3]];
+			const Point& b = m_Points[face.vertices[(i + 2) % 3]];
+			if (Orient(a, b, p) < 0.0)
+			{
+				next = face.neighbours[i];
+				break;
+			}
+		}
+		if (next < 0)
+		{
+			//Inside or on the border of this face
+			edge = -1;
+			vertex = -1;
+			for (int i{}; i < 3; ++i)
+			{
+				const Point& q = m_Points[face.vertices[i]];
+				if (q.x == p.x && q.y == p.y)
+				{
+					vertex = face.vertices[i];
+					return f;
+				}
+			}
+			for (int i{}; i < 3; ++i)
+			{
+				if (Orient(m_Points[face.vertices[(i + 1) % 3]], m_Points[face.vertices[(i + 2) % 3]], p) == 0.0)
+					edge = i;
+			}
+			m_LastFace = f;
+			return f;
+		}
+		f = next;
+	}
+	return -1;
+}
+
+void Elite::ConstrainedDelaunay::SplitFace(int f, int v)
+{
+	//(a, b, c) becomes (a, b, v), (b, c, v) and (c, a, v)
+	const Face old = m_Faces[f];
+	const int a = old.vertices[0], b = old.vertices[1], c = old.vertices[2];
+	const int f1 = AddFace(b, c, v);
+	const int f2 = AddFace(c, a, v);
+
+	SetFace(f, { a, b, v }, { f1, f2, old.neighbours[2] }, { false, false, old.isConstrained[2] });
+	SetFace(f1, { b, c, v }, { f2, f, old.neighbours[0] }, { false, false, old.isConstrained[0] });
+	SetFace(f2, { c, a, v }, { f, f1, old.neighbours[1] }, { false, false, old.isConstrained[1] });
+	ReplaceNeighbour(old.neighbours[0], f, f1);
+	ReplaceNeighbour(old.neighbours[1], f, f2);
+
+	m_VertexFaces[a] = f; m_VertexFaces[b] = f; m_VertexFaces[c] = f1; m_VertexFaces[v] = f;
+
+	std::vector<std::pair<int, int>> edges{ { f, 2 }, { f1, 2 }, { f2, 2 } };
+	Legalize(edges);
+}
+
+void Elite::ConstrainedDelaunay::SplitEdge(int f, int edge, int v)
+{
+	//v is on the edge (a, b) of (p, a, b), shared with (q, b, a)
+	const Face oldF = m_Faces[f];
+	const int p = oldF.vertices[edge];
+	const int a = oldF.vertices[(edge + 1) % 3];
+	const int b = oldF.vertices[(edge + 2) % 3];
+	const int u = oldF.neighbours[edge];
+	const bool isConstrained = oldF.isConstrained[edge];
+
+	const int f1 = AddFace(p, v, b);
+	if (u < 0)
+	{
+		//Border of the super triangle, can only happen for points on its hull
+		SetFace(f, { p, a, v }, { -1, f1, oldF.neighbours[(edge + 2) % 3] }, { isConstrained, false, oldF.isConstrained[(edge + 2) % 3] });
+		SetFace(f1, { p, v, b }, { -1, oldF.neighbours[(edge + 1) % 3], f }, { isConstrained, oldF.isConstrained[(edge + 1) % 3], false });
+		ReplaceNeighbour(oldF.neighbours[(edge + 1) % 3], f, f1);
+		m_VertexFaces[p] = f; m_VertexFaces[a] = f; m_VertexFaces[v] = f; m_VertexFaces[b] = f1;
+		std::vector<std::pair<int, int>> edges{ { f, 2 }, { f1, 1 } };
+		Legalize(edges);
+		return;
+	}
+
+	const Face oldU = m_Faces[u];
+	const int j = GetNeighbourEdge(f, edge);
+	const int q = oldU.vertices[j];
+	const int u1 = AddFace(q, v, a);
+
+	SetFace(f, { p, a, v }, { u1, f1, oldF.neighbours[(edge + 2) % 3] }, { isConstrained, false, oldF.isConstrained[(edge + 2) % 3] });
+	SetFace(f1, { p, v, b }, { u, oldF.neighbours[(edge + 1) % 3], f }, { isConstrained, oldF.isConstrained[(edge + 1) % 3], false });
+	SetFace(u, { q, b, v }, { f1, u1, oldU.neighbours[(j + 2) % 3] }, { isConstrained, false, oldU.isConstrained[(j + 2) % 3] });
+	SetFace(u1, { q, v, a }, { f, oldU.neighbours[(j + 1) % 3], u }, { isConstrained, oldU.isConstrained[(j + 1) % 3], false });
+	ReplaceNeighbour(oldF.neighbours[(edge + 1) % 3], f, f1);
+	ReplaceNeighbour(oldU.neighbours[(j + 1) % 3], u, u1);
+
+	m_VertexFaces[p] = f; m_VertexFaces[a] = f; m_VertexFaces[v] = f; m_VertexFaces[b] = f1; m_VertexFaces[q] = u;
+
+	std::vector<std::pair<int, int>> edges{ { f, 2 }, { f1, 1 }, { u, 2 }, { u1, 1 } };
+	Legalize(edges);
+}
+
+void Elite::ConstrainedDelaunay::Legalize(std::vector<std::pair<int, int>>& edges)
+{
+	//Every entry is a face and the edge opposite of the new point, flip until all of them are locally Delaunay
+	int budget = max_work_per_point;
+	while (!edges.empty() && budget-- > 0)
+	{
+		const int f = edges.back().first;
+		const int edge = edges.back().second;
+		edges.pop_back();
+
+		const Face& face = m_Faces[f];
+		const int u = face.neighbours[edge];
+		if (u < 0 || face.isConstrained[edge])
+			continue;
+
+		const int q = m_Faces[u].vertices[GetNeighbourEdge(f, edge)];
+		if (!IsInCircle(m_Points[face.vertices[0]], m_Points[face.vertices[1]], m_Points[face.vertices[2]], m_Points[q]))
+			continue;
+
+		//After the flip the new point is vertex 0 of f and vertex 2 of u
+		Flip(f, edge);
+		edges.emplace_back(f, 0);
+		edges.emplace_back(u, 2);
+	}
+}
+
+void Elite::ConstrainedDelaunay::Flip(int f, int edge)
+{
+	//(p, a, b) and (q, b, a) become (p, a, q) and (q, b, p)
+	const Face oldF = m_Faces[f];
+	const int u = oldF.neighbours[edge];
+	const int j = GetNeighbourEdge(f, edge);
+	const Face oldU = m_Faces[u];
+
+	const int p = oldF.vertices[edge];
+	const int a = oldF.vertices[(edge + 1) % 3];
+	const int b = oldF.vertices[(edge + 2) % 3];
+	const int q = oldU.vertices[j];
+
+	SetFace(f, { p, a, q }, { oldU.neighbours[(j + 1) % 3], u, oldF.neighbours[(edge + 2) % 3] },
+		{ oldU.isConstrained[(j + 1) % 3], false, oldF.isConstrained[(edge + 2) % 3] });
+	SetFace(u, { q, b, p }, { oldF.neighbours[(edge + 1) % 3], f, oldU.neighbours[(j + 2) % 3] },
+		{ oldF.isConstrained[(edge + 1) % 3], false, oldU.isConstrained[(j + 2) % 3] });
+	ReplaceNeighbour(oldU.neighbours[(j + 1) % 3], u, f);
+	ReplaceNeighbour(oldF.neighbours[(edge + 1) % 3], f, u);
+
+	m_VertexFaces[p] = f; m_VertexFaces[a] = f; m_VertexFaces[q] = u; m_VertexFaces[b] = u;
+}
+
+bool Elite::ConstrainedDelaunay::InsertConstraint(int a, int b)
+{
+	//Segments still to recover, split where they run through a vertex or cross another constraint
+	std::vector<std::pair<int, int>> segments{ { a, b } };
+	int budget = max_work_per_point * 4;
+	while (!segments.empty())
+	{
+		if (budget-- <= 0)
+			return false;
+
+		const int from = segments.back().first;
+		const int to = segments.back().second;
+		segments.pop_back();
+		if (from == to)
+			continue;
+
+		int f{}, edge{};
+		if (FindEdge(from, to, f, edge))
+		{
+			SetConstrained(f, edge);
+			continue;
+		}
+
+		const Point& pFrom = m_Points[from];
+		const Point& pTo = m_Points[to];
+
+		//Find the face around from that the segment leaves through
+		int start{ -1 }, splitVertex{ -1 };
+		int current = m_VertexFaces[from];
+		for (int i{}, count = static_cast<int>(m_Faces.size()); i < count && start < 0 && splitVertex < 0; ++i)
+		{
+			const Face& face = m_Faces[current];
+			const int k = GetLocalIndex(current, from);
+			const int v1 = face.vertices[(k + 1) % 3];
+			const int v2 = face.vertices[(k + 2) % 3];
+			const double o1 = Orient(pFrom, pTo, m_Points[v1]);
+			const double o2 = Orient(pFrom, pTo, m_Points[v2]);
+			auto isAhead = [&](int v)
+			{ return (m_Points[v].x - pFrom.x) * (pTo.x - pFrom.x) + (m_Points[v].y - pFrom.y) * (pTo.y - pFrom.y) > 0.0; };
+
+			if (o1 == 0.0 && isAhead(v1))
+				splitVertex = v1;
+			else if (o2 == 0.0 && isAhead(v2))
+				splitVertex = v2;
+			else if (o1 < 0.0 && o2 > 0.0)
+				start = current;
+			else
+			{
+				current = face.neighbours[(k + 1) % 3];
+				if (current < 0)
+					return false;
+			}
+		}
+		if (splitVertex >= 0)
+		{
+			segments.emplace_back(splitVertex, to);
+			segments.emplace_back(from, splitVertex);
+			continue;
+		}
+		if (start < 0)
+			return false;
+
+		//Walk along the segment and collect the crossed edges (right, left vertex)
+		std::vector<std::pair<int, int>> crossed;
+		f = start;
+		edge = GetLocalIndex(f, from);
+		bool isSplit{ false };
+		while (true)
+		{
+			const Face& face = m_Faces[f];
+			const int right = face.vertices[(edge + 1) % 3];
+			const int left = face.vertices[(edge + 2) % 3];
+			if (face.isConstrained[edge])
+			{
+				//Crossing another constraint, add the intersection as a point on both of them
+				const Point& r = m_Points[right];
+				const Point& l = m_Points[left];
+				const double denominator = (pTo.x - pFrom.x) * (l.y - r.y) - (pTo.y - pFrom.y) * (l.x - r.x);
+				const double t = ((r.x - pFrom.x) * (l.y - r.y) - (r.y - pFrom.y) * (l.x - r.x)) / denominator;
+				Point intersection{ pFrom.x + t * (pTo.x - pFrom.x), pFrom.y + t * (pTo.y - pFrom.y) };
+
+				//Points are floats in the end, round now so the split edges stay where they'll be drawn
+				intersection = { static_cast<double>(static_cast<float>(intersection.x)), static_cast<double>(static_cast<float>(intersection.y)) };
+				int v{ -1 };
+				if (intersection.x == r.x && intersection.y == r.y)
+					v = right;
+				else if (intersection.x == l.x && intersection.y == l.y)
+					v = left;
+				else
+				{
+					v = static_cast<int>(m_Points.size());
+					m_Points.push_back(intersection);
+					m_VertexFaces.push_back(f);
+					SplitEdge(f, edge, v);
+				}
+				if (v == from || v == to)
+					return false;
+				segments.emplace_back(v, to);
+				segments.emplace_back(from, v);
+				isSplit = true;
+				break;
+			}
+
+			crossed.emplace_back(right, left);
+			const int u = face.neighbours[edge];
+			const int j = GetNeighbourEdge(f, edge);
+			const int w = m_Faces[u].vertices[j];
+			if (w == to)
+				break;
+
+			const double o = Orient(pFrom, pTo, m_Points[w]);
+			if (o == 0.0)
+			{
+				//Runs through a vertex, recover both halves
+				segments.emplace_back(w, to);
+				segments.emplace_back(from, w);
+				isSplit = true;
+				break;
+			}
+			//u is (w, left, right), leave through (right, w) when w is left of the segment, else through (w, left)
+			f = u;
+			edge = o > 0.0 ? (j + 1) % 3 : (j + 2) % 3;
+		}
+		if (isSplit)
+			continue;
+
+		//Flip the crossed edges away
+		auto isCrossingSegment = [&](int v1, int v2)
+		{
+			const Point& p1 = m_Points[v1];
+			const Point& p2 = m_Points[v2];
+			const double o1 = Orient(pFrom, pTo, p1);
+			const double o2 = Orient(pFrom, pTo, p2);
+			const double o3 = Orient(p1, p2, pFrom);
+			const double o4 = Orient(p1, p2, pTo);
+			return ((o1 < 0.0 && o2 > 0.0) || (o1 > 0.0 && o2 < 0.0)) && ((o3 < 0.0 && o4 > 0.0) || (o3 > 0.0 && o4 < 0.0));
+		};
+
+		std::vector<std::pair<int, int>> newEdges;
+		size_t next{};
+		const int nrOfCrossed = static_cast<int>(crossed.size());
+		int flipBudget = nrOfCrossed * nrOfCrossed * 4 + max_work_per_point;
+		while (next < crossed.size())
+		{
+			if (flipBudget-- <= 0)
+				return false;
+
+			const auto crossedEdge = crossed[next++];
+			if (!FindEdge(crossedEdge.first, crossedEdge.second, f, edge))
+				return false;
+
+			const int p = m_Faces[f].vertices[edge];
+			const int q = m_Faces[m_Faces[f].neighbours[edge]].vertices[GetNeighbourEdge(f, edge)];
+			const double oFirst = Orient(m_Points[p], m_Points[q], m_Points[crossedEdge.first]);
+			const double oSecond = Orient(m_Points[p], m_Points[q], m_Points[crossedEdge.second]);
+			if (!((oFirst < 0.0 && oSecond > 0.0) || (oFirst > 0.0 && oSecond < 0.0)))
+			{
+				//Not convex yet, try again after the others
+				crossed.push_back(crossedEdge);
+				continue;
+			}
+
+			Flip(f, edge);
+			if (isCrossingSegment(p, q))
+				crossed.emplace_back(p, q);
+			else
+				newEdges.emplace_back(p, q);
+		}
+
+		if (!FindEdge(from, to, f, edge))
+			return false;
+		SetConstrained(f, edge);
+
+		//Restore the Delaunay property of the new edges
+		bool isFlipped{ true };
+		int restoreBudget = static_cast<int>(newEdges.size()) * max_work_per_point;
+		while (isFlipped && restoreBudget-- > 0)
+		{
+			isFlipped = false;
+			for (auto& newEdge : newEdges)
+			{
+				if (!FindEdge(newEdge.first, newEdge.second, f, edge))
+					continue;
+				const Face& face = m_Faces[f];
+				const int u = face.neighbours[edge];
+				if (u < 0 || face.isConstrained[edge])
+					continue;
+				const int q = m_Faces[u].vertices[GetNeighbourEdge(f, edge)];
+				if (!IsInCircle(m_Points[face.vertices[0]], m_Points[face.vertices[1]], m_Points[face.vertices[2]], m_Points[q]))
+					continue;
+
+				const int p = face.vertices[edge];
+				Flip(f, edge);
+				newEdge = { p, q };
+				isFlipped = true;
+			}
+		}
+	}
+	return true;
+}
+
+bool Elite::ConstrainedDelaunay::FindEdge(int a, int b, int& f, int& edge) const
+{
+	//Rotate around a, counter clockwise first and then clockwise when the fan is open (super vertices)
+	const int first = m_VertexFaces[a];
+	for (int direction{ 1 }; direction <= 2; ++direction)
+	{
+		int current = first;
+		do
+		{
+			const Face& face = m_Faces[current];
+			const int k = GetLocalIndex(current, a);
+			if (face.vertices[(k + 1) % 3] == b)
+			{
+				f = current;
+				edge = (k + 2) % 3;
+				return true;
+			}
+			if (face.vertices[(k + 2) % 3] == b)
+			{
+				f = current;
+				edge = (k + 1) % 3;
+				return true;
+			}
+			current = face.neighbours[(k + direction) % 3];
+		} while (current >= 0 && current != first);
+
+		if (current == first)
+			return false;
+	}
+	return false;
+}
+
+void Elite::ConstrainedDelaunay::SetConstrained(int f, int edge)
+{
+	m_Faces[f].isConstrained[edge] = true;
+	const int u = m_Faces[f].neighbours[edge];
+	if (u >= 0)
+		m_Faces[u].isConstrained[GetNeighbourEdge(f, edge)] = true;
+}
+
+void Elite::ConstrainedDelaunay::KeepInsideFaces(std::vector<std::array<Vector2, 3>>& triangles, const std::function<bool(const Point&)>& isInside) const
+{
+	//Constrained edges cut the faces into regions that are either completely walkable or not,
+	//so only one point per region has to be tested. That's the incenter of the fattest face of the region,
+	//the point furthest away from the constraints, so rounding doesn't put it on the wrong side of one
+	std::vector<int> region(m_Faces.size(), -1);
+	std::vector<int> regionFace; //fattest face
+	std::vector<double> regionInradius;
+	std::vector<bool> regionHasSuperVertex;
+	std::vector<int> stack;
+	auto getInradius = [this](const Face& face, Point& incenter)
+	{
+		const Point& p1 = m_Points[face.vertices[0]];
+		const Point& p2 = m_Points[face.vertices[1]];
+		const Point& p3 = m_Points[face.vertices[2]];
+		const double a = sqrt((p2.x - p3.x) * (p2.x - p3.x) + (p2.y - p3.y) * (p2.y - p3.y));
+		const double b = sqrt((p3.x - p1.x) * (p3.x - p1.x) + (p3.y - p1.y) * (p3.y - p1.y));
+		const double c = sqrt((p1.x - p2.x) * (p1.x - p2.x) + (p1.y - p2.y) * (p1.y - p2.y));
+		const double perimeter = a + b + c;
+		if (perimeter <= 0.0)
+		{
+			incenter = p1;
+			return 0.0;
+		}
+		incenter = { (a * p1.x + b * p2.x + c * p3.x) / perimeter, (a * p1.y + b * p2.y + c * p3.y) / perimeter };
+		return abs(Orient(p1, p2, p3)) / perimeter;
+	};
+
+	for (int f{}; f < static_cast<int>(m_Faces.size()); ++f)
+	{
+		if (region[f] >= 0)
+			continue;
+
+		const int currentRegion = static_cast<int>(regionFace.size());
+		regionFace.push_back(f);
+		regionInradius.push_back(-1.0);
+		regionHasSuperVertex.push_back(false);
+
+		region[f] = currentRegion;
+		stack.push_back(f);
+		while (!stack.empty())
+		{
+			const int currentFace = stack.back();
+			const Face& current = m_Faces[currentFace];
+			stack.pop_back();
+
+			for (int v : current.vertices)
+			{
+				if (v < nr_of_super_vertices)
+					regionHasSuperVertex[currentRegion] = true;
+			}
+			Point incenter;
+			const double inradius = getInradius(current, incenter);
+			if (inradius > regionInradius[currentRegion])
+			{
+				regionInradius[currentRegion] = inradius;
+				regionFace[currentRegion] = currentFace;
+			}
+
+			for (int i{}; i < 3; ++i)
+			{
+				const int u = current.neighbours[i];
+				if (u < 0 || current.isConstrained[i] || region[u] >= 0)
+					continue;
+				region[u] = currentRegion;
+				stack.push_back(u);
+			}
+		}
+	}
+
+	//Regions touching the super triangle are outside of everything
+	std::vector<bool> isRegionInside(regionFace.size(), false);
+	for (size_t r{}; r < regionFace.size(); ++r)
+	{
+		if (regionHasSuperVertex[r])
+			continue;
+		Point incenter;
+		getInradius(m_Faces[regionFace[r]], incenter);
+		isRegionInside[r] = isInside(incenter);
+	}
+
+	for (int f{}; f < static_cast<int>(m_Faces.size()); ++f)
+	{
+		if (!isRegionInside[region[f]])
+			continue;
+		const Face& face = m_Faces[f];
+		const Point& p1 = m_Points[face.vertices[0]];
+		const Point& p2 = m_Points[face.vertices[1]];
+		const Point& p3 = m_Points[face.vertices[2]];
+		triangles.push_back({ Vector2{ static_cast<float>(p1.x), static_cast<float>(p1.y) },
+			Vector2{ static_cast<float>(p2.x), static_cast<float>(p2.y) },
+			Vector2{ static_cast<float>(p3.x), static_cast<float>(p3.y) } });
+	}
+}
+
+int Elite::ConstrainedDelaunay::AddFace(int v0, int v1, int v2)
+{
+	m_Faces.push_back({ { v0, v1, v2 }, { -1, -1, -1 }, { false, false, false } });
+	return static_cast<int>(m_Faces.size()) - 1;
+}
+
+void Elite::ConstrainedDelaunay::SetFace(int f, const std::array<int, 3>& vertices, const std::array<int, 3>& neighbours, const std::array<bool, 3>& isConstrained)
+{
+	m_Faces[f] = { vertices, neighbours, isConstrained };
+}
+
+void Elite::ConstrainedDelaunay::ReplaceNeighbour(int f, int oldNeighbour, int newNeighbour)
+{
+	if (f < 0)
+		return;
+	for (int& n : m_Faces[f].neighbours)
+	{
+		if (n == oldNeighbour)
+		{
+			n = newNeighbour;
+			return;
+		}
+	}
+}
+
+int Elite::ConstrainedDelaunay::GetLocalIndex(int f, int v) const
+{
+	const Face& face = m_Faces[f];
+	return face.vertices[0] == v ? 0 : (face.vertices[1] == v ? 1 : 2);
+}
+
+int Elite::ConstrainedDelaunay::GetNeighbourEdge(int f, int edge) const
+{
+	//Edge index of the shared edge as seen from the neighbour
+	const Face& neighbour = m_Faces[m_Faces[f].neighbours[edge]];
+	return neighbour.neighbours[0] == f ? 0 : (neighbour.neighbours[1] == f ? 1 : 2);
+}
+
+double Elite::ConstrainedDelaunay::Orient(const Point& a, const Point& b, const Point& c)
+{
+	//> 0 when c is left of a->b
+	return (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+}
+
+bool Elite::ConstrainedDelaunay::IsInCircle(const Point& a, const Point& b, const Point& c, const Point& d)
+{
+	//a, b, c counter clockwise
+	const double adx = a.x - d.x, ady = a.y - d.y;
+	const double bdx = b.x - d.x, bdy = b.y - d.y;
+	const double cdx = c.x - d.x, cdy = c.y - d.y;
+	const double ad = adx * adx + ady * ady;
+	const double bd = bdx * bdx + bdy * bdy;
+	const double cd = cdx * cdx + cdy * cdy;
+	return adx * (bdy * cd - bd * cdy) - ady * (bdx * cd - bd * cdx) + ad * (bdx * cdy - bdy * cdx) > 0.0;
+}
+
+bool Elite::ConstrainedDelaunay::IsInsideContour(const std::vector<Vector2>& contour, const Point& p)
+{
+	//Even-odd rule
+	bool isInside{ false };
+	for (size_t i{}, j = contour.size() - 1; i < contour.size(); j = i++)
+	{
+		const double xi = contour[i].x, yi = contour[i].y;
+		const double xj = contour[j].x, yj = contour[j].y;
+		if ((yi > p.y) != (yj > p.y) && p.x < (xj - xi) * (p.y - yi) / (yj - yi) + xi)
+			isInside = !isInside;
+	}
+	return isInside;
+}
@@ -0,0 +1,80 @@
+/*=============================================================================*/
+// Copyright 2021 Elite Engine
+/*=============================================================================*/
+// EConstrainedDelaunay.h: Constrained Delaunay triangulation of a contour with holes.
+/*=============================================================================*/
+#ifndef ELITE_CONSTRAINED_DELAUNAY
+#define	ELITE_CONSTRAINED_DELAUNAY
+
+#include <array>
+#include <functional>
+#include <list>
+#include <vector>
+
+namespace Elite
+{
+	// Incremental constrained Delaunay triangulation: the points of all contours are inserted in spatial order
+	// (Lawson flips), then every contour edge is recovered by flipping the edges it crosses.
+	// Contours that cross each other are split at their intersections, so overlapping holes need no merging.
+	// The first contour is the outer shape, a triangle is kept when it's inside of it and outside of all the others.
+	class ConstrainedDelaunay final
+	{
+	public:
+		void AddContour(const std::list<Vector2>& contour);
+		void AddSegment(const Vector2& from, const Vector2& to); // open constraint, only used by the predicate overload
+		void Clear();
+
+		// Output triangles are counter clockwise. False when the triangulation gave up (degenerate input), triangles is empty then
+		bool Triangulate(std::vector<std::array<Vector2, 3>>& triangles);
+		// Keeps the regions between the constraints for which isInside(point in the region) is true, instead of using the contours.
+		// Keeping no triangles isn't a failure here
+		bool Triangulate(std::vector<std::array<Vector2, 3>>& triangles, const std::function<bool(const Vector2&)>& isInside);
+
+	private:
+		struct Point final
+		{
+			double x, y;
+		};
+
+		// Neighbours[i] and IsConstrained[i] belong to the edge opposite of Vertices[i]
+		struct Face final
+		{
+			std::array<int, 3> vertices;
+			std::array<int, 3> neighbours;
+			std::array<bool, 3> isConstrained;
+		};
+
+		enum { nr_of_super_vertices = 3 };
+
+		std::vector<std::vector<Vector2>> m_Contours; // segments are contours of two points that aren't closed
+		std::vector<Point> m_Points;
+		std::vector<Face> m_Faces;
+		std::vector<int> m_VertexFaces; // a face of every vertex
+		int m_LastFace = 0;
+		unsigned int m_WalkCounter = 0;
+
+		bool Build();
+		void CreateSuperTriangle();
+		int InsertPoint(const Point& p);
+		int Locate(const Point& p, int& edge, int& vertex);
+		void SplitFace(int f, int v);
+		void SplitEdge(int f, int edge, int v);
+		void Legalize(std::vector<std::pair<int, int>>& edges);
+		void Flip(int f, int edge);
+		bool InsertConstraint(int a, int b);
+		bool FindEdge(int a, int b, int& f, int& edge) const;
+		void SetConstrained(int f, int edge);
+		void KeepInsideFaces(std::vector<std::array<Vector2, 3>>& triangles, const std::function<bool(const Point&)>& isInside) const;
+
+		int AddFace(int v0, int v1, int v2);
+		void SetFace(int f, const std::array<int, 3>& vertices, const std::array<int, 3>& neighbours, const std::array<bool, 3>& isConstrained);
+		void ReplaceNeighbour(int f, int oldNeighbour, int newNeighbour);
+		int GetLocalIndex(int f, int v) const;
+		int GetNeighbourEdge(int f, int edge) const;
+
+		static double Orient(const Point& a, const Point& b, const Point& c);
+		static bool IsInCircle(const Point& a, const Point& b, const Point& c, const Point& d);
+		static bool IsInsideContour(const std::vector<Vector2>& contour, const Point& p);
+	};
+}
+#endif
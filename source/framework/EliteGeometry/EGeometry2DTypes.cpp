@@ -9,6 +9,93 @@
 #include "EGeometry2DTypes.h"
 #include "EGeometry2DUtilities.h"
 
+namespace
+{
+	//Key of a line that doesn't depend on its direction, -0 is folded into 0 so equal coordinates get the same key
+	struct LineKey final
+	{
+		float x1, y1, x2, y2;
+
+		bool operator==(const LineKey& other) const
+		{ return x1 == other.x1 && y1 == other.y1 && x2 == other.x2 && y2 == other.y2; }
+	};
+
+	struct LineKeyHash final
+	{
+		size_t operator()(const LineKey& key) const
+		{
+			const std::hash<float> hash{};
+			size_t h = hash(key.x1);
+			h = h * 31 + hash(key.y1);
+			h = h * 31 + hash(key.x2);
+			return h * 31 + hash(key.y2);
+		}
+	};
+
+	LineKey MakeLineKey(const Elite::Vector2& a, const Elite::Vector2& b)
+	{
+		const float ax = a.x + 0.f, ay = a.y + 0.f, bx = b.x + 0.f, by = b.y + 0.f;
+		if (ax < bx || (ax == bx && ay <= by))
+			return LineKey{ ax, ay, bx, by };
+		return LineKey{ bx, by, ax, ay };
+	}
+
+	//Even-odd rule
+	bool IsInsideContour(const std::list<Elite::Vector2>& contour, const Elite::Vector2& p)
+	{
+		bool isInside{ false };
+		if (contour.empty())
+			return isInside;
+		for (auto i = contour.begin(), j = std::prev(contour.end()); i != contour.end(); j = i++)
+		{
+			if ((i->y > p.y) != (j->y > p.y) && p.x < (j->x - i->x) * (p.y - i->y) / (j->y - i->y) + i->x)
+				isInside = !isInside;
+		}
+		return isInside;
+	}
+
+	//Points on the edges are inside. In double, PointInTriangle accepts points next to long thin triangles
+	bool IsInsideTriangle(const Elite::Triangle& t, const Elite::Vector2& p)
+	{
+		const auto orient = [](const Elite::Vector2& a, const Elite::Vector2& b, const Elite::Vector2& c)
+		{ return (static_cast<double>(b.x) - a.x) * (static_cast<double>(c.y) - a.y) - (static_cast<double>(b.y) - a.y) * (static_cast<double>(c.x) - a.x); };
+		const double area = orient(t.p1, t.p2, t.p3);
+		const double o1 = orient(t.p1, t.p2, p), o2 = orient(t.p2, t.p3, p), o3 = orient(t.p3, t.p1, p);
+		if (area > 0.0)
+			return o1 >= 0.0 && o2 >= 0.0 && o3 >= 0.0;
+		if (area < 0.0)
+			return o1 <= 0.0 && o2 <= 0.0 && o3 <= 0.0;
+		return false;
+	}
+
+	//Distance to the closest point instead of DistanceSquarePointToLine, that one cancels out on long lines
+	float DistanceSquaredToSegment(const Elite::Vector2& p1, const Elite::Vector2& p2, const Elite::Vector2& point)
+	{
+		const Elite::Vector2 segment = p2 - p1;
+		const float lengthSquared = Elite::Dot(segment, segment);
+		if (lengthSquared <= 0.f)
+			return Elite::DistanceSquared(p1, point);
+		const float t = Elite::Clamp(Elite::Dot(point - p1, segment) / lengthSquared, 0.f, 1.f);
+		return Elite::DistanceSquared(p1 + segment * t, point);
+	}
+
+	//Crossing or closer than margin
+	bool AreSegmentsTouching(const Elite::Vector2& a, const Elite::Vector2& b, const Elite::Vector2& c, const Elite::Vector2& d, float margin)
+	{
+		const float o1 = Elite::Cross(b - a, c - a), o2 = Elite::Cross(b - a, d - a);
+		const float o3 = Elite::Cross(d - c, a - c), o4 = Elite::Cross(d - c, b - c);
+		if (((o1 < 0.f && o2 > 0.f) || (o1 > 0.f && o2 < 0.f)) && ((o3 < 0.f && o4 > 0.f) || (o3 > 0.f && o4 < 0.f)))
+			return true;
+
+		const float marginSquared = margin * margin;
+		return DistanceSquaredToSegment(a, b, c) <= marginSquared || DistanceSquaredToSegment(a, b, d) <= marginSquared
+			|| DistanceSquaredToSegment(c, d, a) <= marginSquared || DistanceSquaredToSegment(c, d, b) <= marginSquared;
+	}
+
+	//Triangles closer to a child than this are retriangulated with it, so rounding can't leave one out
+	const float touch_margin = 0.001f;
+}
+
 #pragma region Polygon
 #pragma region Constructors
 
@@ -76,6 +163,36 @@ void Elite::Polygon::RemoveChild(const Polygon& p)
 	if (child != m_vChildren.end())
 		m_vChildren.erase(child);
 }
+
+bool Elite::Polygon::AddChildIncremental(const Polygon& p, TriangulationUpdate& update)
+{
+	update = {};
+	AddChild(p);
+	if (!m_isTriangulated)
+		return false;
+
+	std::vector<int> triangles;
+	GetTrianglesTouching(p, triangles);
+	return RetriangulateArea(triangles, nullptr, update);
+}
+
+bool Elite::Polygon::RemoveChildIncremental(const Polygon& p, TriangulationUpdate& update)
+{
+	update = {};
+	const auto child = std::find(m_vChildren.begin(), m_vChildren.end(), p);
+	if (child == m_vChildren.end())
+		return m_isTriangulated;
+
+	const Polygon removedChild = *child;
+	m_vChildren.erase(child);
+	if (!m_isTriangulated)
+		return false;
+
+	//The triangles around the child share its edges or points
+	std::vector<int> triangles;
+	GetTrianglesTouching(removedChild, triangles);
+	return RetriangulateArea(triangles, &removedChild, update);
+}
 #pragma endregion //ChildFunctionality
 //----------------------------------------------------------
 #pragma region GeneralFunctions
@@ -165,6 +282,38 @@ bool Elite::Polygon::OverlappingYAxis(const Polygon& poly) const
 
 std::vector<Elite::Triangle*> Elite::Polygon::GetAdjacentTriangles(const Triangle* t) const
 {
+#ifdef USE_TRIANGLE_METADATA
+	//Triangles sharing two points share a line, so only the triangles on the lines of a triangle of this polygon have to be checked.
+	//Sorted they come in the same order as the search below. Degenerate triangles (left by the splits) match on a single point, they keep the search
+	if (IsOwnTriangle(t) && t->p1 != t->p2 && t->p2 != t->p3 && t->p3 != t->p1)
+	{
+		std::vector<int> candidates;
+		for (int lineIdx : t->metaData.IndexLines)
+			candidates.insert(candidates.end(), m_LineTriangles.begin() + m_LineTrianglesFirst[lineIdx], m_LineTriangles.begin() + m_LineTrianglesFirst[lineIdx + 1]);
+		std::sort(candidates.begin(), candidates.end());
+		candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+		std::vector<Triangle*> adjTriangles;
+		for (int idx : candidates)
+		{
+			const auto ct = m_vpTriangles[idx];
+			if (t == ct) //If same triangle, ignore
+				continue;
+
+			//Only adjacent of two points match!
+			auto matchingVerts = 0;
+			for (const auto& p : { t->p1, t->p2, t->p3 })
+			{
+				if (p == ct->p1 || p == ct->p2 || p == ct->p3)
+					++matchingVerts;
+			}
+			if (matchingVerts == 2)
+				adjTriangles.push_back(ct);
+		}
+		return adjTriangles;
+	}
+#endif
+
 	//For this triangle, go over all triangles and look if any of it's edges matches the edges of a triangle,
 	//in other words, two points overlap. If two points match, it's an adjacent triangle
 	std::vector<Triangle*> adjTriangles;
@@ -196,26 +345,26 @@ std::vector<Elite::Triangle*> Elite::Polygon::GetAdjacentTrianglesOnLine(const T
 	std::vector<Triangle*> adjTriangles;
 
 #ifdef USE_TRIANGLE_METADATA
-	//Start by getting index of line in matrix
+	//Start by getting index of line in matrix, lines of this polygon already know it
 	auto lRev = Line(l.p2, l.p1);
-	const auto it = std::find_if(m_vpLines.begin(), m_vpLines.end(), [&](const Line* rl)
-	{ return (*rl == l || *rl == lRev); });
-	if (it == m_vpLines.end())
+	int lineIndex = l.index;
+	if (lineIndex < 0 || lineIndex >= static_cast<int>(m_vpLines.size()) || !(*m_vpLines[lineIndex] == l || *m_vpLines[lineIndex] == lRev))
 	{
-		std::cout << "WARNING: line not found!" << std::endl;
-		return adjTriangles;
+		const auto it = std::find_if(m_vpLines.begin(), m_vpLines.end(), [&](const Line* rl)
+		{ return (*rl == l || *rl == lRev); });
+		if (it == m_vpLines.end())
+		{
+			std::cout << "WARNING: line not found!" << std::endl;
+			return adjTriangles;
+		}
+		lineIndex = it - m_vpLines.begin();
 	}
-	const int lineIndex = it - m_vpLines.begin();
 
-	//Go over all the triangles and compare lines
-	for (auto ct : m_vpTriangles)
+	//The triangles using the line were stored when triangulating
+	for (int i = m_LineTrianglesFirst[lineIndex]; i < m_LineTrianglesFirst[lineIndex + 1]; ++i)
 	{
-		if (t == ct) //If same triangle, ignore
-			continue;
-
-		if (ct->metaData.IndexLines[0] == lineIndex
-			|| ct->metaData.IndexLines[1] == lineIndex
-			|| ct->metaData.IndexLines[2] == lineIndex)
+		const auto ct = m_vpTriangles[m_LineTriangles[i]];
+		if (t != ct) //If same triangle, ignore
 			adjTriangles.push_back(ct);
 	}
 #endif
@@ -224,6 +373,28 @@ std::vector<Elite::Triangle*> Elite::Polygon::GetAdjacentTrianglesOnLine(const T
 
 
 const Elite::Triangle* Elite::Polygon::GetTriangleFromPosition(const Vector2& position, bool onLineAllowed /*= false*/) const
+{
+	//No grid yet (not triangulated), fall back to testing every triangle
+	if (m_TriangleGridFirst.empty())
+		return GetTriangleFromPositionLinear(position, onLineAllowed);
+
+	//No triangle can contain a position outside of the grid, this also rejects NaN
+	if (!(position.x >= m_TriangleGridMin.x && position.x <= m_TriangleGridMax.x
+		&& position.y >= m_TriangleGridMin.y && position.y <= m_TriangleGridMax.y))
+		return nullptr;
+
+	//A cell lists its triangles in ascending order, so the first hit is also the one the linear search finds
+	const int cell = GetTriangleGridRow(position.y) * m_TriangleGridColumns + GetTriangleGridColumn(position.x);
+	for (int i = m_TriangleGridFirst[cell]; i < m_TriangleGridFirst[cell + 1]; ++i)
+	{
+		const auto t = m_vpTriangles[m_TriangleGridTriangles[i]];
+		if (PointInTriangle(position, t->p1, t->p2, t->p3, onLineAllowed))
+			return t;
+	}
+	return nullptr;
+}
+
+const Elite::Triangle* Elite::Polygon::GetTriangleFromPositionLinear(const Vector2& position, bool onLineAllowed /*= false*/) const
 {
 	for (size_t i = 0; i < m_vpTriangles.size(); i++)
 	{
@@ -237,107 +408,47 @@ const Elite::Triangle* Elite::Polygon::GetTriangleFromPosition(const Vector2& po
 const std::vector<const Elite::Triangle*> Elite::Polygon::GetTrianglesFromLineIndex(unsigned int lineIndex) const
 {
 	std::vector<const Triangle*> vpFoundTriangles = {};
-	for (auto pT : m_vpTriangles)
-	{
-		if (pT->metaData.IndexLines[0] == lineIndex ||
-			pT->metaData.IndexLines[1] == lineIndex ||
-			pT->metaData.IndexLines[2] == lineIndex)
-		{
-			vpFoundTriangles.push_back(pT);
-		}
-	}
+	for (int i = 0; i < GetAmountTrianglesOnLine(lineIndex); ++i)
+		vpFoundTriangles.push_back(m_vpTriangles[m_LineTriangles[m_LineTrianglesFirst[lineIndex] + i]]);
 	return vpFoundTriangles;
 }
+
+int Elite::Polygon::GetAmountTrianglesOnLine(unsigned int lineIndex) const
+{
+	if (lineIndex + 1 >= m_LineTrianglesFirst.size())
+		return 0;
+	return m_LineTrianglesFirst[lineIndex + 1] - m_LineTrianglesFirst[lineIndex];
+}
 #endif
 
 
 #pragma endregion //GettersInformation
 //----------------------------------------------------------
 #pragma region TriangulationFunctions
-const std::vector<Elite::Triangle*>& Elite::Polygon::Triangulate()
+const std::vector<Elite::Triangle*>& Elite::Polygon::Triangulate(TriangulationEngine engine)
 {
 	//Check winding
 	OrientateWithChildren(Winding::CCW);
-
-	//TODO: CHECK FOR OVERLAPPING POLYGONS AND MERGE WHEN REQUIRED
-	for (auto child : m_vChildren)
-	{
-		//Check for overlap, if so merge, create new child and remove old ones!
-		//FILL IN FUNCTIONS!
-	}
-
-	//Sort the children. Start by sorting from top to bottom (verices are what matters, not the "center" pos of the polygon!)
-	std::sort(m_vChildren.begin(), m_vChildren.end(),
-		[](const Polygon& p1, const Polygon& p2)
-	{ return p1.GetPosVertMaxYPos() > p2.GetPosVertMaxYPos(); });
-
-	//Copy children as backup after sort
-	const auto children = m_vChildren;
-	
-	//THEN, we check two elements, if the don't overlap horizontally you don't do anything, else you swap them based on right most object
-	for (auto i = 0; i < static_cast<int>(m_vChildren.size()) - 1; ++i)
-	{
-		if (m_vChildren[i].OverlappingYAxis(m_vChildren[i + 1]))
-		{
-			//Swap if i.y < i+1.y
-			if (m_vChildren[i].GetPosVertMaxXPos() < m_vChildren[i + 1].GetPosVertMaxXPos())
-			{
-				const auto temp = m_vChildren[i];
-				m_vChildren[i] = m_vChildren[i + 1];
-				m_vChildren[i + 1] = temp;
-			}
-		}
-	}
-
-	//First split polygon
-	while (m_vChildren.size() != 0)
-		Split();
+	m_vContour = m_vPoints;
 
 	//Triangle list - Clear first (if already containing triangles)
 	for (auto t : m_vpTriangles)
 		SAFE_DELETE(t);
 	m_vpTriangles.clear();
 
-	std::list<Vector2> copyPoints;
-	copyPoints.assign(m_vPoints.begin(), m_vPoints.end()); //Copy
+	if (engine != TriangulationEngine::ConstrainedDelaunay || !TriangulateConstrainedDelaunay())
+		TriangulateEarClipping();
 
-	//For each ear, remove ear and push verts, recheck earness (including convexness obviously :-))!
-	while (copyPoints.size() > 3)
-	{
-		list<Vector2>::const_iterator earListIt = copyPoints.end();
-		for (auto it = copyPoints.begin(); it != copyPoints.end(); ++it)
-		{
-			if (earListIt != copyPoints.end())
-				break;
-			if (IsConvexInPolygon(copyPoints, it) && IsEar(copyPoints, it))
-				earListIt = it;
-		}
-
-		//Push triangle
-		Vector2 current, prev, next;
-		GetTriangle(copyPoints, earListIt, current, prev, next);
-		Triangle* t = new Triangle(prev, current, next);
-		m_vpTriangles.push_back(t);
-
-		//Remove current from pointslist
-		const auto currentIt = std::find(copyPoints.begin(), copyPoints.end(), current);
-		copyPoints.erase(currentIt); //remove
-	}
-	//Add the remaining 3 vertices to the triangulated polygon
-	std::vector<Vector2> tempCopy;
-	for (const auto p : copyPoints)
-		tempCopy.push_back(p);
-	Triangle* lastTriangle = new Triangle(tempCopy[0], tempCopy[1], tempCopy[2]);
-	m_vpTriangles.push_back(lastTriangle);
+	BuildTriangleGrid();
 
 	//Flag as triangulated for later use
 	m_isTriangulated = true; 
 
 #ifdef USE_TRIANGLE_METADATA
 	GenerateLineMatrix();
+	GenerateAdjacency();
 #endif
 
-	m_vChildren = children;
 	return m_vpTriangles;
 }
 
@@ -439,52 +550,572 @@ bool Elite::Polygon::IsEar(const list<Vector2>& l, const list<Vector2>::const_it
 void Elite::Polygon::GenerateLineMatrix()
 {
 #ifdef USE_TRIANGLE_METADATA
+	//Lines are looked up by their end points instead of being compared with every line found so far.
+	//Shared lines have identical end points, the triangles copy them from the points of the polygon.
+	//When lines are equal the last one wins
+	std::unordered_map<LineKey, int, LineKeyHash> lineIndices;
+	lineIndices.reserve(m_vpLines.size() + m_vpTriangles.size() * 2);
+	for (auto i = 0; i < static_cast<int>(m_vpLines.size()); ++i)
+		lineIndices[MakeLineKey(m_vpLines[i]->p1, m_vpLines[i]->p2)] = i;
+
 	//Go over all the triangles
 	for (auto t : m_vpTriangles)
 	{
 		//Go over all the lines of the triangle, search if they are already in the matrix
 		//If not add them and store it's index in the triangles meta data
-		const Line l1{ t->p1, t->p2 };
-		const Line l1rev{ t->p2, t->p1 };
-		const Line l2{ t->p2, t->p3 };
-		const Line l2rev{ t->p3, t->p2 };
-		const Line l3{ t->p3, t->p1 };
-		const Line l3rev{ t->p1, t->p3 };
-		for (auto i = 0; i < static_cast<int>(m_vpLines.size()); ++i)
+		const std::array<Vector2, 3> points{ { t->p1, t->p2, t->p3 } };
+		std::array<LineKey, 3> keys;
+		for (int j = 0; j < 3; ++j)
 		{
-			const auto l = m_vpLines[i];
-			if (*l == l1 || *l == l1rev)
-				t->metaData.IndexLines[0] = i;
-			if (*l == l2 || *l == l2rev)
-				t->metaData.IndexLines[1] = i;
-			if (*l == l3 || *l == l3rev)
-				t->metaData.IndexLines[2] = i;
+			keys[j] = MakeLineKey(points[j], points[(j + 1) % 3]);
+			const auto it = lineIndices.find(keys[j]);
+			if (it != lineIndices.end())
+				t->metaData.IndexLines[j] = it->second;
 		}
 		//Not found, add to matrix
-		if (t->metaData.IndexLines[0] == -1)
+		for (int j = 0; j < 3; ++j)
 		{
+			if (t->metaData.IndexLines[j] != -1)
+				continue;
+
 			const int index = m_vpLines.size();
-			m_vpLines.push_back(new Line(t->p1, t->p2, index));
-			t->metaData.IndexLines[0] = index;
+			m_vpLines.push_back(new Line(points[j], points[(j + 1) % 3], index));
+			t->metaData.IndexLines[j] = index;
+			lineIndices[keys[j]] = index;
 		}
-		if (t->metaData.IndexLines[1] == -1)
+	}
+#endif
+}
+
+void Elite::Polygon::GenerateAdjacency()
+{
+#ifdef USE_TRIANGLE_METADATA
+	//Store the triangles using every line in triangle order. Two in a clean triangulation,
+	//but the lines along the splits to the children can be shared by more
+	m_LineTrianglesFirst.assign(m_vpLines.size() + 1, 0);
+	for (int i = 0; i < static_cast<int>(m_vpTriangles.size()); ++i)
+	{
+		const auto& lines = m_vpTriangles[i]->metaData.IndexLines;
+		m_vpTriangles[i]->metaData.IndexTriangle = i;
+		for (int j = 0; j < 3; ++j)
 		{
-			const int index = m_vpLines.size();
-			m_vpLines.push_back(new Line(t->p2, t->p3, index));
-			t->metaData.IndexLines[1] = index;
+			//A line that a degenerate triangle uses twice counts once
+			if (std::find(lines.begin(), lines.begin() + j, lines[j]) == lines.begin() + j)
+				++m_LineTrianglesFirst[lines[j] + 1];
 		}
-		if (t->metaData.IndexLines[2] == -1)
+	}
+	for (size_t i = 1; i < m_LineTrianglesFirst.size(); ++i)
+		m_LineTrianglesFirst[i] += m_LineTrianglesFirst[i - 1];
+
+	m_LineTriangles.resize(m_LineTrianglesFirst.back());
+	std::vector<int> nextOnLine(m_LineTrianglesFirst.begin(), m_LineTrianglesFirst.end() - 1);
+	for (int i = 0; i < static_cast<int>(m_vpTriangles.size()); ++i)
+	{
+		const auto& lines = m_vpTriangles[i]->metaData.IndexLines;
+		for (int j = 0; j < 3; ++j)
 		{
-			const int index = m_vpLines.size();
-			m_vpLines.push_back(new Line(t->p3, t->p1, index));
-			t->metaData.IndexLines[2] = index;
+			if (std::find(lines.begin(), lines.begin() + j, lines[j]) == lines.begin() + j)
+				m_LineTriangles[nextOnLine[lines[j]]++] = i;
 		}
 	}
 #endif
 }
+
+bool Elite::Polygon::IsOwnTriangle(const Triangle* t) const
+{
+#ifdef USE_TRIANGLE_METADATA
+	const int idx = t ? t->metaData.IndexTriangle : -1;
+	return idx >= 0 && idx < static_cast<int>(m_vpTriangles.size()) && m_vpTriangles[idx] == t;
+#else
+	return false;
+#endif
+}
+
+void Elite::Polygon::BuildTriangleGrid()
+{
+	m_TriangleGridFirst.clear();
+	m_TriangleGridTriangles.clear();
+	if (m_vpTriangles.empty())
+		return;
+
+	//Grow the bounding boxes exactly like PointInTriangleBoundingBox does, so every triangle is listed in all cells it can be hit in
+	const int nrOfTriangles = static_cast<int>(m_vpTriangles.size());
+	std::vector<Vector2> boxMin, boxMax;
+	boxMin.reserve(nrOfTriangles);
+	boxMax.reserve(nrOfTriangles);
+	m_TriangleGridMin = { FLT_MAX, FLT_MAX };
+	m_TriangleGridMax = { -FLT_MAX, -FLT_MAX };
+	for (const auto t : m_vpTriangles)
+	{
+		boxMin.push_back({ min(t->p1.x, min(t->p2.x, t->p3.x)) - FLT_EPSILON, min(t->p1.y, min(t->p2.y, t->p3.y)) - FLT_EPSILON });
+		boxMax.push_back({ max(t->p1.x, max(t->p2.x, t->p3.x)) + FLT_EPSILON, max(t->p1.y, max(t->p2.y, t->p3.y)) + FLT_EPSILON });
+		m_TriangleGridMin = { min(m_TriangleGridMin.x, boxMin.back().x), min(m_TriangleGridMin.y, boxMin.back().y) };
+		m_TriangleGridMax = { max(m_TriangleGridMax.x, boxMax.back().x), max(m_TriangleGridMax.y, boxMax.back().y) };
+	}
+
+	//Square cells, about one triangle per cell
+	const Vector2 size = m_TriangleGridMax - m_TriangleGridMin;
+	float cellSize = sqrtf(size.x * size.y / nrOfTriangles);
+	if (cellSize <= 0.f)
+		cellSize = max(max(size.x, size.y) / nrOfTriangles, FLT_EPSILON);
+	const int maxCellsPerAxis = 1024;
+	m_TriangleGridInvCellSize = 1.f / cellSize;
+	m_TriangleGridColumns = Clamp(static_cast<int>(size.x * m_TriangleGridInvCellSize) + 1, 1, maxCellsPerAxis);
+	m_TriangleGridRows = Clamp(static_cast<int>(size.y * m_TriangleGridInvCellSize) + 1, 1, maxCellsPerAxis);
+
+	//Count the triangles per cell, then fill the cells in triangle order
+	m_TriangleGridFirst.assign(m_TriangleGridColumns * m_TriangleGridRows + 1, 0);
+	for (int i = 0; i < nrOfTriangles; ++i)
+	{
+		for (int row = GetTriangleGridRow(boxMin[i].y); row <= GetTriangleGridRow(boxMax[i].y); ++row)
+			for (int column = GetTriangleGridColumn(boxMin[i].x); column <= GetTriangleGridColumn(boxMax[i].x); ++column)
+				++m_TriangleGridFirst[row * m_TriangleGridColumns + column + 1];
+	}
+	for (size_t cell = 1; cell < m_TriangleGridFirst.size(); ++cell)
+		m_TriangleGridFirst[cell] += m_TriangleGridFirst[cell - 1];
+
+	m_TriangleGridTriangles.resize(m_TriangleGridFirst.back());
+	std::vector<int> nextInCell(m_TriangleGridFirst.begin(), m_TriangleGridFirst.end() - 1);
+	for (int i = 0; i < nrOfTriangles; ++i)
+	{
+		for (int row = GetTriangleGridRow(boxMin[i].y); row <= GetTriangleGridRow(boxMax[i].y); ++row)
+			for (int column = GetTriangleGridColumn(boxMin[i].x); column <= GetTriangleGridColumn(boxMax[i].x); ++column)
+				m_TriangleGridTriangles[nextInCell[row * m_TriangleGridColumns + column]++] = i;
+	}
+}
+
+int Elite::Polygon::GetTriangleGridColumn(float x) const
+{
+	return Clamp(static_cast<int>((x - m_TriangleGridMin.x) * m_TriangleGridInvCellSize), 0, m_TriangleGridColumns - 1);
+}
+
+int Elite::Polygon::GetTriangleGridRow(float y) const
+{
+	return Clamp(static_cast<int>((y - m_TriangleGridMin.y) * m_TriangleGridInvCellSize), 0, m_TriangleGridRows - 1);
+}
 #pragma endregion //PrivateGeneralFunctions
 //----------------------------------------------------------
 #pragma region PrivateTriangulationFunctions
+void Elite::Polygon::TriangulateEarClipping()
+{
+	//TODO: CHECK FOR OVERLAPPING POLYGONS AND MERGE WHEN REQUIRED
+	for (auto child : m_vChildren)
+	{
+		//Check for overlap, if so merge, create new child and remove old ones!
+		//FILL IN FUNCTIONS!
+	}
+
+	//Sort the children. Start by sorting from top to bottom (verices are what matters, not the "center" pos of the polygon!)
+	std::sort(m_vChildren.begin(), m_vChildren.end(),
+		[](const Polygon& p1, const Polygon& p2)
+	{ return p1.GetPosVertMaxYPos() > p2.GetPosVertMaxYPos(); });
+
+	//Copy children as backup after sort
+	const auto children = m_vChildren;
+	
+	//THEN, we check two elements, if the don't overlap horizontally you don't do anything, else you swap them based on right most object
+	for (auto i = 0; i < static_cast<int>(m_vChildren.size()) - 1; ++i)
+	{
+		if (m_vChildren[i].OverlappingYAxis(m_vChildren[i + 1]))
+		{
+			//Swap if i.y < i+1.y
+			if (m_vChildren[i].GetPosVertMaxXPos() < m_vChildren[i + 1].GetPosVertMaxXPos())
+			{
+				const auto temp = m_vChildren[i];
+				m_vChildren[i] = m_vChildren[i + 1];
+				m_vChildren[i + 1] = temp;
+			}
+		}
+	}
+
+	//First split polygon
+	while (m_vChildren.size() != 0)
+		Split();
+
+	std::list<Vector2> copyPoints;
+	copyPoints.assign(m_vPoints.begin(), m_vPoints.end()); //Copy
+
+	//For each ear, remove ear and push verts, recheck earness (including convexness obviously :-))!
+	while (copyPoints.size() > 3)
+	{
+		list<Vector2>::const_iterator earListIt = copyPoints.end();
+		for (auto it = copyPoints.begin(); it != copyPoints.end(); ++it)
+		{
+			if (earListIt != copyPoints.end())
+				break;
+			if (IsConvexInPolygon(copyPoints, it) && IsEar(copyPoints, it))
+				earListIt = it;
+		}
+		if (earListIt == copyPoints.end())
+		{
+			std::cout << "<Polygon::Triangulate>: no ear left, the split polygon intersects itself" << std::endl;
+			break;
+		}
+
+		//Push triangle
+		Vector2 current, prev, next;
+		GetTriangle(copyPoints, earListIt, current, prev, next);
+		Triangle* t = new Triangle(prev, current, next);
+		m_vpTriangles.push_back(t);
+
+		//Remove current from pointslist
+		const auto currentIt = std::find(copyPoints.begin(), copyPoints.end(), current);
+		copyPoints.erase(currentIt); //remove
+	}
+	//Add the remaining 3 vertices to the triangulated polygon
+	if (copyPoints.size() == 3)
+	{
+		std::vector<Vector2> tempCopy;
+		for (const auto p : copyPoints)
+			tempCopy.push_back(p);
+		Triangle* lastTriangle = new Triangle(tempCopy[0], tempCopy[1], tempCopy[2]);
+		m_vpTriangles.push_back(lastTriangle);
+	}
+
+	m_vChildren = children;
+}
+
+bool Elite::Polygon::TriangulateConstrainedDelaunay()
+{
+	//The shape itself isn't split, so the points and children stay as they are
+	ConstrainedDelaunay triangulation{};
+	triangulation.AddContour(m_vPoints);
+	AddChildContours(triangulation);
+
+	std::vector<std::array<Vector2, 3>> triangles;
+	if (!triangulation.Triangulate(triangles))
+	{
+		std::cout << "<Polygon::Triangulate>: constrained Delaunay triangulation failed, using ear clipping" << std::endl;
+		return false;
+	}
+
+	m_vpTriangles.reserve(triangles.size());
+	for (const auto& t : triangles)
+		m_vpTriangles.push_back(new Triangle(t[0], t[1], t[2]));
+	return true;
+}
+
+void Elite::Polygon::AddChildContours(ConstrainedDelaunay& triangulation) const
+{
+	//Children of children are holes as well, the same as after Split()
+	for (const auto& child : m_vChildren)
+	{
+		triangulation.AddContour(child.m_vPoints);
+		child.AddChildContours(triangulation);
+	}
+}
+
+void Elite::Polygon::GetTrianglesTouching(const Polygon& shape, std::vector<int>& triangles) const
+{
+	triangles.clear();
+	if (shape.m_vPoints.empty())
+		return;
+
+	Vector2 shapeMin{ FLT_MAX, FLT_MAX }, shapeMax{ -FLT_MAX, -FLT_MAX };
+	for (const Vector2& p : shape.m_vPoints)
+	{
+		shapeMin = { min(shapeMin.x, p.x - touch_margin), min(shapeMin.y, p.y - touch_margin) };
+		shapeMax = { max(shapeMax.x, p.x + touch_margin), max(shapeMax.y, p.y + touch_margin) };
+	}
+
+	//Candidates from the cells of the triangle grid under the shape
+	std::vector<int> candidates;
+	if (m_TriangleGridFirst.empty())
+	{
+		for (int i = 0; i < static_cast<int>(m_vpTriangles.size()); ++i)
+			candidates.push_back(i);
+	}
+	else
+	{
+		for (int row = GetTriangleGridRow(shapeMin.y); row <= GetTriangleGridRow(shapeMax.y); ++row)
+		{
+			for (int column = GetTriangleGridColumn(shapeMin.x); column <= GetTriangleGridColumn(shapeMax.x); ++column)
+			{
+				const int cell = row * m_TriangleGridColumns + column;
+				candidates.insert(candidates.end(), m_TriangleGridTriangles.begin() + m_TriangleGridFirst[cell], m_TriangleGridTriangles.begin() + m_TriangleGridFirst[cell + 1]);
+			}
+		}
+		std::sort(candidates.begin(), candidates.end());
+		candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+	}
+
+	for (int idx : candidates)
+	{
+		const auto t = m_vpTriangles[idx];
+		const std::array<Vector2, 3> points{ { t->p1, t->p2, t->p3 } };
+		if (max(t->p1.x, max(t->p2.x, t->p3.x)) < shapeMin.x || min(t->p1.x, min(t->p2.x, t->p3.x)) > shapeMax.x
+			|| max(t->p1.y, max(t->p2.y, t->p3.y)) < shapeMin.y || min(t->p1.y, min(t->p2.y, t->p3.y)) > shapeMax.y)
+			continue;
+
+		//Touching when a point of one is inside of the other, or when their edges touch
+		bool isTouching = IsInsideContour(shape.m_vPoints, t->p1) || PointInTriangle(shape.m_vPoints.front(), t->p1, t->p2, t->p3, true);
+		for (auto it = shape.m_vPoints.begin(); it != shape.m_vPoints.end() && !isTouching; ++it)
+		{
+			const auto next = std::next(it) != shape.m_vPoints.end() ? std::next(it) : shape.m_vPoints.begin();
+			for (int j = 0; j < 3 && !isTouching; ++j)
+				isTouching = AreSegmentsTouching(*it, *next, points[j], points[(j + 1) % 3], touch_margin);
+		}
+		if (isTouching)
+			triangles.push_back(idx);
+	}
+}
+
+bool Elite::Polygon::RetriangulateArea(const std::vector<int>& triangles, const Polygon* pRemovedChild, TriangulationUpdate& update)
+{
+	if (triangles.empty() && !pRemovedChild)
+		return true;
+
+	//Bounds of the area
+	update.boundsMin = { FLT_MAX, FLT_MAX };
+	update.boundsMax = { -FLT_MAX, -FLT_MAX };
+	auto addToBounds = [&update](const Vector2& p)
+	{
+		update.boundsMin = { min(update.boundsMin.x, p.x), min(update.boundsMin.y, p.y) };
+		update.boundsMax = { max(update.boundsMax.x, p.x), max(update.boundsMax.y, p.y) };
+	};
+	for (int idx : triangles)
+	{
+		addToBounds(m_vpTriangles[idx]->p1);
+		addToBounds(m_vpTriangles[idx]->p2);
+		addToBounds(m_vpTriangles[idx]->p3);
+	}
+	if (pRemovedChild)
+	{
+		for (const Vector2& p : pRemovedChild->m_vPoints)
+			addToBounds(p);
+	}
+	auto isOverlapping = [&update](const Vector2& boxMin, const Vector2& boxMax)
+	{ return !(boxMax.x < update.boundsMin.x || boxMin.x > update.boundsMax.x || boxMax.y < update.boundsMin.y || boxMin.y > update.boundsMax.y); };
+
+	ConstrainedDelaunay triangulation{};
+
+	//Lines shared with the triangles around the area stay the same
+	std::unordered_map<int, int> areaUses;
+	for (int idx : triangles)
+	{
+		const auto& lines = m_vpTriangles[idx]->metaData.IndexLines;
+		for (int j = 0; j < 3; ++j)
+		{
+			if (std::find(lines.begin(), lines.begin() + j, lines[j]) == lines.begin() + j)
+				++areaUses[lines[j]];
+		}
+	}
+	std::vector<int> borderLines;
+	for (const auto& uses : areaUses)
+	{
+		if (GetAmountTrianglesOnLine(uses.first) > uses.second)
+			borderLines.push_back(uses.first);
+	}
+	std::sort(borderLines.begin(), borderLines.end());
+	for (int lineIdx : borderLines)
+		triangulation.AddSegment(m_vpLines[lineIdx]->p1, m_vpLines[lineIdx]->p2);
+
+	//The outer shape and the children can run through the area
+	for (auto it = m_vContour.begin(); it != m_vContour.end(); ++it)
+	{
+		const auto next = std::next(it) != m_vContour.end() ? std::next(it) : m_vContour.begin();
+		if (isOverlapping({ min(it->x, next->x), min(it->y, next->y) }, { max(it->x, next->x), max(it->y, next->y) }))
+			triangulation.AddSegment(*it, *next);
+	}
+
+	std::vector<const std::list<Vector2>*> holes;
+	std::vector<const Polygon*> children;
+	for (const auto& child : m_vChildren)
+		children.push_back(&child);
+	while (!children.empty())
+	{
+		const Polygon* pChild = children.back();
+		children.pop_back();
+		if (pChild->m_vPoints.size() < 3)
+			continue;
+
+		Vector2 childMin{ FLT_MAX, FLT_MAX }, childMax{ -FLT_MAX, -FLT_MAX };
+		for (const Vector2& p : pChild->m_vPoints)
+		{
+			childMin = { min(childMin.x, p.x), min(childMin.y, p.y) };
+			childMax = { max(childMax.x, p.x), max(childMax.y, p.y) };
+		}
+		if (!isOverlapping(childMin, childMax))
+			continue;
+
+		//Children of children are holes as well, like in AddChildContours
+		triangulation.AddContour(pChild->m_vPoints);
+		holes.push_back(&pChild->m_vPoints);
+		for (const auto& grandChild : pChild->m_vChildren)
+			children.push_back(&grandChild);
+	}
+
+	//Keep what's inside of the area, minus the children
+	std::vector<std::array<Vector2, 3>> newTriangles;
+	const bool isTriangulated = triangulation.Triangulate(newTriangles, [&](const Vector2& p)
+	{
+		if (!IsInsideContour(m_vContour, p))
+			return false;
+		for (const auto pHole : holes)
+		{
+			if (IsInsideContour(*pHole, p))
+				return false;
+		}
+		if (pRemovedChild && IsInsideContour(pRemovedChild->m_vPoints, p))
+			return true;
+		for (int idx : triangles)
+		{
+			if (IsInsideTriangle(*m_vpTriangles[idx], p))
+				return true;
+		}
+		return false;
+	});
+
+	if (!isTriangulated)
+	{
+		std::cout << "<Polygon::RetriangulateArea>: local triangulation failed, triangulating the whole polygon" << std::endl;
+		update = {};
+		for (auto l : m_vpLines)
+			SAFE_DELETE(l);
+		m_vpLines.clear();
+		m_vPoints = m_vContour;
+		Triangulate(TriangulationEngine::ConstrainedDelaunay);
+		return false;
+	}
+
+	ReplaceTriangles(triangles, newTriangles, update);
+	return true;
+}
+
+void Elite::Polygon::ReplaceTriangles(const std::vector<int>& triangles, const std::vector<std::array<Vector2, 3>>& newTriangles, TriangulationUpdate& update)
+{
+#ifdef USE_TRIANGLE_METADATA
+	//Lines used by the triangles around the area keep their index, the others are freed
+	std::unordered_map<int, int> removedUses;
+	for (int idx : triangles)
+	{
+		const auto& lines = m_vpTriangles[idx]->metaData.IndexLines;
+		update.removedTriangleLines.push_back(lines);
+		for (int j = 0; j < 3; ++j)
+		{
+			if (std::find(lines.begin(), lines.begin() + j, lines[j]) == lines.begin() + j)
+				++removedUses[lines[j]];
+		}
+	}
+	std::unordered_map<LineKey, int, LineKeyHash> lineIndices;
+	for (const auto& uses : removedUses)
+	{
+		if (GetAmountTrianglesOnLine(uses.first) > uses.second)
+			lineIndices[MakeLineKey(m_vpLines[uses.first]->p1, m_vpLines[uses.first]->p2)] = uses.first;
+		else
+			update.removedLines.push_back(uses.first);
+	}
+	std::sort(update.removedLines.begin(), update.removedLines.end());
+
+	//New triangles take the places of the removed ones first
+	std::vector<Triangle*> addedTriangles;
+	addedTriangles.reserve(newTriangles.size());
+	for (size_t i = 0; i < newTriangles.size(); ++i)
+	{
+		Triangle* t = new Triangle(newTriangles[i][0], newTriangles[i][1], newTriangles[i][2]);
+		addedTriangles.push_back(t);
+		if (i < triangles.size())
+		{
+			SAFE_DELETE(m_vpTriangles[triangles[i]]);
+			m_vpTriangles[triangles[i]] = t;
+		}
+		else
+			m_vpTriangles.push_back(t);
+	}
+	//The places left over are filled with the last triangles, from the back so those are never removed ones
+	for (size_t i = triangles.size(); i > newTriangles.size(); --i)
+	{
+		const int idx = triangles[i - 1];
+		SAFE_DELETE(m_vpTriangles[idx]);
+		m_vpTriangles[idx] = m_vpTriangles.back();
+		m_vpTriangles.pop_back();
+	}
+
+	//Lines of the new triangles, a new line gets the index of a removed one when there is one
+	size_t nrOfReusedLines = 0;
+	for (auto t : addedTriangles)
+	{
+		const std::array<Vector2, 3> points{ { t->p1, t->p2, t->p3 } };
+		for (int j = 0; j < 3; ++j)
+		{
+			const LineKey key = MakeLineKey(points[j], points[(j + 1) % 3]);
+			const auto it = lineIndices.find(key);
+			if (it != lineIndices.end())
+			{
+				t->metaData.IndexLines[j] = it->second;
+				continue;
+			}
+
+			int index;
+			if (nrOfReusedLines < update.removedLines.size())
+			{
+				index = update.removedLines[nrOfReusedLines++];
+				SAFE_DELETE(m_vpLines[index]);
+				m_vpLines[index] = new Line(points[j], points[(j + 1) % 3], index);
+			}
+			else
+			{
+				index = m_vpLines.size();
+				m_vpLines.push_back(new Line(points[j], points[(j + 1) % 3], index));
+			}
+			t->metaData.IndexLines[j] = index;
+			lineIndices[key] = index;
+		}
+	}
+
+	//Fill the holes of the removed lines that weren't reused with the last lines, so the indices stay packed
+	std::vector<bool> isHole(m_vpLines.size(), false);
+	for (size_t i = nrOfReusedLines; i < update.removedLines.size(); ++i)
+		isHole[update.removedLines[i]] = true;
+	std::unordered_map<int, int> movedTo;
+	for (size_t i = nrOfReusedLines; i < update.removedLines.size(); ++i)
+	{
+		const int hole = update.removedLines[i];
+		while (!m_vpLines.empty() && isHole[m_vpLines.size() - 1])
+		{
+			SAFE_DELETE(m_vpLines.back());
+			m_vpLines.pop_back();
+		}
+		if (hole >= static_cast<int>(m_vpLines.size()))
+			break;
+
+		const int last = m_vpLines.size() - 1;
+		SAFE_DELETE(m_vpLines[hole]);
+		m_vpLines[hole] = m_vpLines[last];
+		m_vpLines[hole]->index = hole;
+		m_vpLines.pop_back();
+		isHole[hole] = false;
+		movedTo[last] = hole;
+		update.movedLines.push_back({ last, hole });
+	}
+	if (!movedTo.empty())
+	{
+		for (auto t : m_vpTriangles)
+		{
+			for (int& lineIdx : t->metaData.IndexLines)
+			{
+				const auto it = movedTo.find(lineIdx);
+				if (it != movedTo.end())
+					lineIdx = it->second;
+			}
+		}
+	}
+
+	for (const auto& line : lineIndices)
+	{
+		const auto it = movedTo.find(line.second);
+		update.changedLines.push_back(it != movedTo.end() ? it->second : line.second);
+	}
+	std::sort(update.changedLines.begin(), update.changedLines.end());
+
+	GenerateAdjacency();
+	BuildTriangleGrid();
+
+	for (auto t : addedTriangles)
+		update.addedTriangles.push_back(t->metaData.IndexTriangle);
+#endif
+}
+
 void Elite::Polygon::FindMutualVisibleVertices(const Polygon& outer, const Polygon& inner, Vector2& pOuter, Vector2& pInner)
 {
 	//1. Find vertex with the biggest x value of the inner polygon AND biggest x value of outer polygon (used for size ray)
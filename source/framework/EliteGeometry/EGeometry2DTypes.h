@@ -8,6 +8,7 @@
 #define	ELITE_GEOMETRY_TYPES
 
 #include "EGeometry2DUtilities.h"
+#include "EConstrainedDelaunay.h"
 #include <array>
 
 
@@ -46,6 +47,7 @@ namespace Elite
 	struct TriangleMetaData final
 	{
 		std::array<int, 3> IndexLines{ {-1, -1, -1} };
+		int IndexTriangle = -1; //Index in the triangles of the polygon
 	};
 
 	struct Triangle final
@@ -105,6 +107,26 @@ namespace Elite
 #pragma endregion //Triangle
 
 #pragma region Polygon
+	//Algorithm used by Polygon::Triangulate, both give the same kind of triangles, lines and metadata
+	enum class TriangulationEngine
+	{
+		EarClipping, //splits the children into the outer shape and clips ears, quadratic in the amount of vertices
+		ConstrainedDelaunay //see EConstrainedDelaunay.h, O(n log n) expected and overlapping children are allowed
+	};
+
+	//What Polygon::AddChildIncremental and RemoveChildIncremental changed, so users of the lines (like NavGraph) can patch themselves.
+	//Removed lines are applied first, then the moves, so a new line can get the index of a removed one
+	struct TriangulationUpdate final
+	{
+		std::vector<std::array<int, 3>> removedTriangleLines; //Lines of every removed triangle, indices from before the update
+		std::vector<int> removedLines; //Lines without triangles now, indices from before the update
+		std::vector<std::pair<int, int>> movedLines; //Old and new index of lines moved into the holes left by the removed lines
+		std::vector<int> changedLines; //New lines and the lines around the retriangulated area, indices after the update
+		std::vector<int> addedTriangles; //Indices after the update
+		Vector2 boundsMin = {}; //Retriangulated area
+		Vector2 boundsMax = {};
+	};
+
 	class Polygon final
 	{
 	public:
@@ -121,6 +143,10 @@ namespace Elite
 		Polygon* AddChild(std::list<Vector2>& vertices);
 		void AddChild(const Polygon& p);
 		void RemoveChild(const Polygon& p);
+		//Only retriangulates the triangles touching the child, lines keep their index unless they're in update.movedLines.
+		//False when the polygon isn't triangulated or the local triangulation failed, the polygon is fully triangulated again then
+		bool AddChildIncremental(const Polygon& p, TriangulationUpdate& update);
+		bool RemoveChildIncremental(const Polygon& p, TriangulationUpdate& update);
 
 		//General functions
 		Vector2 GetCenterPoint() const;
@@ -143,15 +169,18 @@ namespace Elite
 		std::vector<Triangle*> GetAdjacentTriangles(const Triangle* t) const;
 		std::vector<Triangle*> GetAdjacentTrianglesOnLine(const Triangle* t, const Line& l) const;
 
+		//Uses the triangle grid built by Triangulate(), returns the same triangle as the linear search
 		const Triangle* GetTriangleFromPosition(const Vector2& position, bool onLineAllowed = false) const;
+		const Triangle* GetTriangleFromPositionLinear(const Vector2& position, bool onLineAllowed = false) const;
 #ifdef USE_TRIANGLE_METADATA
 		const std::vector<const Triangle*> GetTrianglesFromLineIndex(unsigned int lineIndex) const;
+		int GetAmountTrianglesOnLine(unsigned int lineIndex) const;
 #endif
 
 
 
 		//Triangulation functions
-		const std::vector<Triangle*>& Triangulate();
+		const std::vector<Triangle*>& Triangulate(TriangulationEngine engine = TriangulationEngine::EarClipping);
 		void OrientateWithChildren(Winding winding);
 		void ExpandShape(float amount);
 
@@ -163,18 +192,41 @@ namespace Elite
 		//=== Datamembers ===
 		std::vector<Polygon> m_vChildren; //Inner shapes of this polygon
 		std::list<Vector2> m_vPoints; //Points that define this polygon
+		std::list<Vector2> m_vContour; //Outer shape when triangulated, ear clipping splits the children into m_vPoints
 		std::vector<Triangle*> m_vpTriangles; //Triangles create for this polygon, used for rendering
 		std::vector<Line*> m_vpLines; //Lines constructing this polygon!
+		std::vector<int> m_LineTrianglesFirst; //Offset of every line in m_LineTriangles, plus the end of the last line
+		std::vector<int> m_LineTriangles; //Indices of the triangles using each line, in ascending order
 		bool m_isTriangulated = false;
 
+		//Uniform grid over the bounding boxes of the triangles, every cell lists the indices of the triangles overlapping it in ascending order
+		Vector2 m_TriangleGridMin = {};
+		Vector2 m_TriangleGridMax = {};
+		float m_TriangleGridInvCellSize = 0.f;
+		int m_TriangleGridColumns = 0;
+		int m_TriangleGridRows = 0;
+		std::vector<int> m_TriangleGridFirst; //Offset of every cell in m_TriangleGridTriangles, plus the end of the last cell
+		std::vector<int> m_TriangleGridTriangles;
+
 		//=== Functions ===
 		//Private General Functions
 		void GetTriangle(const list<Vector2>& l, const list<Vector2>::const_iterator p, Vector2& currentTip, Vector2& previous, Vector2& next) const;
 		bool IsConvexInPolygon(const list<Vector2>& l, const list<Vector2>::const_iterator p) const;
 		bool IsEar(const list<Vector2>& l, const list<Vector2>::const_iterator p) const;
 		void GenerateLineMatrix();
+		void GenerateAdjacency();
+		bool IsOwnTriangle(const Triangle* t) const;
+		void BuildTriangleGrid();
+		int GetTriangleGridColumn(float x) const;
+		int GetTriangleGridRow(float y) const;
 
 		//Private Triangulation Functions
+		void TriangulateEarClipping();
+		bool TriangulateConstrainedDelaunay();
+		void AddChildContours(ConstrainedDelaunay& triangulation) const;
+		void GetTrianglesTouching(const Polygon& shape, std::vector<int>& triangles) const;
+		bool RetriangulateArea(const std::vector<int>& triangles, const Polygon* pRemovedChild, TriangulationUpdate& update);
+		void ReplaceTriangles(const std::vector<int>& triangles, const std::vector<std::array<Vector2, 3>>& newTriangles, TriangulationUpdate& update);
 		void FindMutualVisibleVertices(const Polygon& outer, const Polygon& inner, Vector2& pOuter, Vector2& pInner);
 		void Split();
 	};
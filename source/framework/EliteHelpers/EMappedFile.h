@@ -0,0 +1,44 @@
+/*=============================================================================*/
+// Copyright 2021 Elite Engine
+/*=============================================================================*/
+// EMappedFile.h: read-only view of a whole file, mapped into memory by the OS.
+/*=============================================================================*/
+#ifndef ELITE_MAPPED_FILE
+#define	ELITE_MAPPED_FILE
+
+#include <string>
+#include <cstddef>
+
+namespace Elite
+{
+	class MappedFile final
+	{
+	public:
+		//=== Constructors & Destructors ===
+		MappedFile() = default;
+		~MappedFile() { Close(); }
+
+		//=== Functions ===
+		// Maps the whole file read-only, pages are only read from disk when they are touched
+		bool Open(const std::string& path);
+		void Close();
+
+		bool IsOpen() const { return m_pData != nullptr; }
+		const unsigned char* GetData() const { return m_pData; }
+		size_t GetSize() const { return m_Size; }
+
+	private:
+		//=== Datamembers ===
+		const unsigned char* m_pData = nullptr;
+		size_t m_Size = 0;
+#ifdef _WIN32
+		void* m_FileHandle = nullptr;
+		void* m_MappingHandle = nullptr;
+#endif
+
+		//C++ make the class non-copyable
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+	};
+}
+#endif
@@ -0,0 +1,135 @@
+/*=============================================================================*/
+// Copyright 2021 Elite Engine
+/*=============================================================================*/
+// EThreadPool.h: fixed set of worker threads that split a range of independent items between them.
+/*=============================================================================*/
+#ifndef ELITE_THREAD_POOL
+#define	ELITE_THREAD_POOL
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <vector>
+#include <cassert>
+
+namespace Elite
+{
+	class ThreadPool final
+	{
+	public:
+		//=== Constructors & Destructors ===
+		// nrOfWorkers includes the thread calling ParallelFor, 0 means one worker per hardware thread
+		explicit ThreadPool(unsigned int nrOfWorkers = 0);
+		~ThreadPool();
+
+		//=== Functions ===
+		// Calls job(workerIdx, itemIdx) once for every item in [0, nrOfItems) and blocks until all of them are done.
+		// Items are handed out one by one to whichever worker is free, the calling thread works along as worker 0.
+		// workerIdx is in [0, GetNrOfWorkers()) and lets a job use per-worker scratch data without locking.
+		void ParallelFor(int nrOfItems, const std::function<void(unsigned int workerIdx, int itemIdx)>& job);
+
+		unsigned int GetNrOfWorkers() const { return static_cast<unsigned int>(m_Threads.size()) + 1; }
+
+	private:
+		//=== Datamembers ===
+		std::vector<std::thread> m_Threads;
+
+		std::mutex m_Mutex;
+		std::condition_variable m_JobAvailable;
+		std::condition_variable m_JobFinished;
+
+		const std::function<void(unsigned int, int)>* m_pJob = nullptr;
+		int m_NrOfItems = 0;
+		std::atomic<int> m_NextItem{ 0 };
+		unsigned int m_NrOfBusyThreads = 0;
+		unsigned int m_JobId = 0;
+		bool m_IsShuttingDown = false;
+
+		//=== Internal Functions ===
+		void WorkerLoop(unsigned int workerIdx);
+		void RunItems(unsigned int workerIdx);
+
+		//C++ make the class non-copyable
+		ThreadPool(const ThreadPool&) = delete;
+		ThreadPool& operator=(const ThreadPool&) = delete;
+	};
+
+	inline ThreadPool::ThreadPool(unsigned int nrOfWorkers)
+	{
+		if (nrOfWorkers == 0)
+			nrOfWorkers = std::thread::hardware_concurrency();
+		if (nrOfWorkers == 0) //hardware_concurrency is allowed to return 0 when it can't tell
+			nrOfWorkers = 1;
+
+		m_Threads.reserve(nrOfWorkers - 1);
+		for (unsigned int i = 1; i < nrOfWorkers; ++i)
+			m_Threads.emplace_back(&ThreadPool::WorkerLoop, this, i);
+	}
+
+	inline ThreadPool::~ThreadPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_IsShuttingDown = true;
+		}
+		m_JobAvailable.notify_all();
+
+		for (auto& thread : m_Threads)
+			thread.join();
+	}
+
+	inline void ThreadPool::ParallelFor(int nrOfItems, const std::function<void(unsigned int workerIdx, int itemIdx)>& job)
+	{
+		if (nrOfItems <= 0)
+			return;
+
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			assert(m_pJob == nullptr && "<ThreadPool::ParallelFor>: ParallelFor is not reentrant");
+
+			m_pJob = &job;
+			m_NrOfItems = nrOfItems;
+			m_NextItem = 0;
+			m_NrOfBusyThreads = static_cast<unsigned int>(m_Threads.size());
+			++m_JobId;
+		}
+		m_JobAvailable.notify_all();
+
+		RunItems(0);
+
+		//Wait until every worker let go of the job
+		std::unique_lock<std::mutex> lock(m_Mutex);
+		m_JobFinished.wait(lock, [this]() { return m_NrOfBusyThreads == 0; });
+		m_pJob = nullptr;
+	}
+
+	inline void ThreadPool::WorkerLoop(unsigned int workerIdx)
+	{
+		unsigned int lastJobId = 0;
+		while (true)
+		{
+			{
+				std::unique_lock<std::mutex> lock(m_Mutex);
+				m_JobAvailable.wait(lock, [this, lastJobId]() { return m_IsShuttingDown || m_JobId != lastJobId; });
+				if (m_IsShuttingDown)
+					return;
+				lastJobId = m_JobId;
+			}
+
+			RunItems(workerIdx);
+
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			if (--m_NrOfBusyThreads == 0)
+				m_JobFinished.notify_one();
+		}
+	}
+
+	inline void ThreadPool::RunItems(unsigned int workerIdx)
+	{
+		for (int item = m_NextItem++; item < m_NrOfItems; item = m_NextItem++)
+			(*m_pJob)(workerIdx, item);
+	}
+}
+#endif
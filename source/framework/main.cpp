@@ -25,6 +25,15 @@ int main(int argc, char* argv[])
 {
 	std::srand(uint32_t(time(nullptr)));
 
+#ifdef FasterAStar
+	//Headless: GPP_Framework.exe --benchmark <results.csv|results.json> [nrOfQueries]
+	if (argc >= 3 && string(argv[1]) == "--benchmark")
+		return PathfindingBenchmarks::RunSearchBenchmarks(argv[2], argc >= 4 ? stoi(string(argv[3])) : 1000);
+	//Headless: GPP_Framework.exe --grid-benchmark <results.csv|results.json> [nrOfQueries]
+	if (argc >= 3 && string(argv[1]) == "--grid-benchmark")
+		return PathfindingBenchmarks::RunGridSearchBenchmarks(argv[2], argc >= 4 ? stoi(string(argv[3])) : 1000);
+#endif
+
 	int x{}, y{};
 	bool runExeWithCoordinates{ argc == 3 };
 
@@ -14,14 +14,14 @@ using namespace Elite;
 #include "framework\EliteAI\EliteGraphs\EliteGraphAlgorithms\EBFS.h"
 #include "framework\EliteAI\EliteGraphs\EliteGraphAlgorithms\EDijkstra.h"
 
-#include "Binary.h"
-
 //Statics
 bool App_FasterAStar::sShowPolygon = true;
 bool App_FasterAStar::sShowGraph = false;
 bool App_FasterAStar::sDrawPortals = false;
 bool App_FasterAStar::sDrawFinalPath = true;
 bool App_FasterAStar::sDrawNonOptimisedPath = false;
+bool App_FasterAStar::sUseQuantizedBoxes = false;
+bool App_FasterAStar::sUsePathCache = true;
 
 //Destructor
 App_FasterAStar::~App_FasterAStar()
@@ -29,7 +29,10 @@ App_FasterAStar::~App_FasterAStar()
 	for (auto pNC : m_vNavigationColliders)
 		SAFE_DELETE(pNC);
 	m_vNavigationColliders.clear();
+	SAFE_DELETE(m_pDoor);
 
+	SAFE_DELETE(m_pBatchPathfinder);
+	SAFE_DELETE(m_pPathFinder);
 	SAFE_DELETE(m_pNavGraph);
 	SAFE_DELETE(m_pSeekBehavior);
 	SAFE_DELETE(m_pArriveBehavior);
@@ -56,6 +59,7 @@ void App_FasterAStar::Start()
 	{ { -60, 30 },{ -60, -30 },{ 60, -30 },{ 60, 30 } };
 
 	m_pNavGraph = new Elite::NavGraph(Elite::Polygon(baseBox), m_AgentRadius);
+	m_pPathFinder = new AStar<NavGraphNode, GraphConnection2D>(m_pNavGraph, Elite::HeuristicFunctions::Manhattan);
 
 	//----------- AGENT ------------
 	m_pSeekBehavior = new Seek();
@@ -70,12 +74,9 @@ void App_FasterAStar::Start()
 	m_pAgent->SetMass(0.1f);
 
 	m_pOptimizedGraph = new OptimizedGraph<Elite::NavGraphNode, Elite::GraphConnection2D>(m_pNavGraph);
-	//----------- COMPUTE OPTIMIZED GRAPH ------------
-	//m_pOptimizedGraph->ComputeBoundingBoxes(m_pNavGraph->GetNavMeshPolygon());
-
-	//----------- SAVE BOUNDING BOX ------------
-	//SaveBoundingBoxes("projects/App_FasterAStar/Resources/bb.bin");
-	LoadBoundingBoxes("projects/App_FasterAStar/Resources/bb.bin");
+	m_pBatchPathfinder = new BatchPathfinder(m_pNavGraph, m_pOptimizedGraph, Elite::HeuristicFunctions::Manhattan);
+	//----------- LOAD OR COMPUTE OPTIMIZED GRAPH ------------
+	LoadBoundingBoxes("projects/App_FasterAStar/Resources/goalbounds.gbf");
 }
 
 void App_FasterAStar::Update(float deltaTime)
@@ -86,7 +87,7 @@ void App_FasterAStar::Update(float deltaTime)
 		auto mouseData = INPUTMANAGER->GetMouseData(Elite::InputType::eMouseButton, Elite::InputMouseButton::eMiddle);
 		Elite::Vector2 mouseTarget = DEBUGRENDERER2D->GetActiveCamera()->ConvertScreenToWorld(
 			Elite::Vector2((float)mouseData.X, (float)mouseData.Y));
-		m_vPath = FindPath(m_pAgent->GetPosition(), mouseTarget);
+		FindPath(m_pAgent->GetPosition(), mouseTarget, m_vPath);
 	}
 	
 	//Check if a path exist and move to the following point
@@ -115,12 +116,38 @@ void App_FasterAStar::Update(float deltaTime)
 	if (m_Save)
 	{
 		m_Save = false;
-		SaveBoundingBoxes("projects/App_FasterAStar/Resources/bb.bin");
+		SaveBoundingBoxes("projects/App_FasterAStar/Resources/goalbounds.gbf");
 	}
 	if (m_Load)
 	{
 		m_Load = false;
-		LoadBoundingBoxes("projects/App_FasterAStar/Resources/bb.bin");
+		LoadBoundingBoxes("projects/App_FasterAStar/Resources/goalbounds.gbf");
+	}
+	if (m_Benchmark)
+	{
+		m_Benchmark = false;
+		RunBenchmarks();
+	}
+	if (m_ToggleDoor)
+	{
+		m_ToggleDoor = false;
+		ToggleDoor();
+	}
+	if (m_RunBatch)
+	{
+		m_RunBatch = false;
+		RunBatch(1000);
+	}
+	if (m_DumpStatistics)
+	{
+		m_DumpStatistics = false;
+		std::cout << "Search statistics, " << m_SearchStatistics.GetNrOfQueries() << " searches" << std::endl;
+		m_SearchStatistics.Write(std::cout);
+	}
+	if (m_pOptimizedGraph->ApplyFinishedRebake() && m_SaveWhenBaked)
+	{
+		m_SaveWhenBaked = false;
+		SaveBoundingBoxes("projects/App_FasterAStar/Resources/goalbounds.gbf");
 	}
 
 	m_pAgent->Update(deltaTime);
@@ -179,18 +206,101 @@ void App_FasterAStar::Render(float deltaTime) const
 
 void App_FasterAStar::SaveBoundingBoxes(const std::string& path)
 {
-	Binary::SaveToFile(path, *m_pOptimizedGraph);
+	//Store the 16-bit boxes alongside the float ones
+	if (m_pOptimizedGraph->GetQuantizedBoundingBoxTable().IsEmpty())
+		m_pOptimizedGraph->QuantizeBoundingBoxes(m_pNavGraph->GetNavMeshPolygon());
+
+	if (!m_pOptimizedGraph->SaveBoundingBoxes(path, m_pNavGraph->GetNavMeshPolygon()))
+		std::cout << "Failed to save the bounding boxes to " << path << std::endl;
 }
 
 void App_FasterAStar::LoadBoundingBoxes(const std::string& path)
 {
-	Binary::LoadFromFile(path, *m_pOptimizedGraph);
+	switch (m_pOptimizedGraph->LoadBoundingBoxes(path))
+	{
+	case BoundingBoxLoadResult::Loaded:
+		return;
+	case BoundingBoxLoadResult::Failed:
+		std::cout << "No valid goal bounds file at " << path << ", rebaking" << std::endl;
+		break;
+	case BoundingBoxLoadResult::Stale:
+		std::cout << "The navmesh changed since " << path << " was baked, rebaking" << std::endl;
+		break;
+	}
+
+	//Stale or missing boxes are baked in the background and saved, so the next run can load them again.
+	//Until then A* runs without pruning
+	m_pOptimizedGraph->ComputeBoundingBoxesAsync(m_pNavGraph->GetNavMeshPolygon());
+	m_SaveWhenBaked = true;
+}
+
+void App_FasterAStar::RunBenchmarks()
+{
+	//Every node position is used as goal
+	std::vector<Elite::Vector2> goals{};
+	goals.reserve(m_pNavGraph->GetNrOfNodes());
+	for (int i{}; i < m_pNavGraph->GetNrOfNodes(); ++i)
+		goals.push_back(m_pNavGraph->GetNodePos(i));
+
+	m_BoundingBoxTestResult = PathfindingBenchmarks::BenchmarkBoundingBoxTest(m_pOptimizedGraph->GetBoundingBoxTable(), goals, 100);
+	m_TriangleLookupResult = PathfindingBenchmarks::BenchmarkTriangleLookup(*m_pNavGraph->GetNavMeshPolygon(), 100000);
+
+	m_TriangulationResults.clear();
+	for (int nrOfObstacles : { 10, 100, 400 })
+		m_TriangulationResults.push_back(PathfindingBenchmarks::BenchmarkTriangulation(nrOfObstacles));
 }
 
-std::vector<Elite::Vector2> App_FasterAStar::FindPath(Elite::Vector2 startPos, Elite::Vector2 endPos)
+void App_FasterAStar::RunBatch(int nrOfQueries)
 {
-	//Create the path to return
-	std::vector<Elite::Vector2> finalPath{};
+	//Random start and goal positions within the bounds of the navmesh, the ones inside obstacles are reported as such
+	const Elite::Polygon* pNavMesh = m_pNavGraph->GetNavMeshPolygon();
+	std::mt19937 generator{ 0 };
+	std::uniform_real_distribution<float> xDistribution{ pNavMesh->GetPosVertMinXPos(), pNavMesh->GetPosVertMaxXPos() };
+	std::uniform_real_distribution<float> yDistribution{ pNavMesh->GetPosVertMinYPos(), pNavMesh->GetPosVertMaxYPos() };
+
+	m_BatchQueries.resize(nrOfQueries);
+	for (PathQuery& query : m_BatchQueries)
+	{
+		query.start = { xDistribution(generator), yDistribution(generator) };
+		query.goal = { xDistribution(generator), yDistribution(generator) };
+	}
+
+	m_BatchStatistics = m_pBatchPathfinder->FindPaths(m_BatchQueries, m_BatchPaths);
+	std::cout << "Batch pathfinding: " << m_BatchStatistics.nrOfQueries << " queries (" << m_BatchStatistics.nrOfPathsFound << " found) on "
+		<< m_BatchStatistics.nrOfWorkers << " threads in " << m_BatchStatistics.time << "s, " << m_BatchStatistics.queriesPerSecond << " queries/s" << std::endl;
+}
+
+void App_FasterAStar::ToggleDoor()
+{
+	//Only the navmesh around the door changes, the goal bounds it affects are rebaked in the background
+	m_pOptimizedGraph->BeginGraphUpdate();
+	NavGraphUpdate update{};
+	if (m_pDoor)
+	{
+		const Elite::Polygon shape{ m_pDoor->GetShape() };
+		SAFE_DELETE(m_pDoor);
+		update = m_pNavGraph->RemoveNavigationCollider(shape);
+	}
+	else
+	{
+		m_pDoor = new NavigationColliderElement(Elite::Vector2(-5.f, 10.f), 26.0f, 1.0f);
+		update = m_pNavGraph->AddNavigationCollider(m_pDoor->GetShape());
+	}
+	m_pOptimizedGraph->EndGraphUpdate(update.changedNodes, update.addedNodes, update.removedNodes, m_pNavGraph->GetNavMeshPolygon());
+
+	//The current path was found on the old graph
+	m_vPath.clear();
+	m_NodePath.clear();
+	m_Portals.clear();
+	m_DebugNodePositions.clear();
+}
+
+void App_FasterAStar::FindPath(Elite::Vector2 startPos, Elite::Vector2 endPos, std::vector<Elite::Vector2>& finalPath)
+{
+	//Reuse the path to return
+	finalPath.clear();
+	SEARCH_STATISTIC(PathQueryTimings timings{});
+	SEARCH_STATISTIC(StatisticsTimer timer{});
 
 	//Get the start and endTriangle
 	const Triangle* pStartTriangle{};
@@ -201,66 +311,67 @@ std::vector<Elite::Vector2> App_FasterAStar::FindPath(Elite::Vector2 startPos, E
 		pEndTriangle = m_pNavGraph->GetNavMeshPolygon()->GetTriangleFromPosition(endPos);
 	}
 
+	SEARCH_STATISTIC(timings.triangleLookupTime = timer.Lap());
+
 	//If we have valid start/end triangles and they are not the same
 	if (!pStartTriangle || !pEndTriangle)
-		return finalPath;
+		return;
 	if (pStartTriangle == pEndTriangle)
 	{
 		finalPath.push_back(endPos);
-		return finalPath;
+		return;
 	}
 
 	//=> Start looking for a path
-	//Copy the graph
-	auto graphClone = m_pNavGraph->Clone();
+	//The agent's position and the target are virtual endpoints linked to the portals of their triangle, the graph stays untouched
+	const SearchEndpoint start{ m_pNavGraph->GetSearchEndpoint(startPos, pStartTriangle) };
+	const SearchEndpoint end{ m_pNavGraph->GetSearchEndpoint(endPos, pEndTriangle) };
 
-	//Create extra node for the Start Node (Agent's position)
-	NavGraphNode* pStartNode(new NavGraphNode(graphClone->GetNextFreeNodeIndex(), -1, startPos));
-	graphClone->AddNode(pStartNode);
-	for (int lineIdx : pStartTriangle->metaData.IndexLines)
+	//Run A star, unless a path between these triangles was found before
+	//CALCULATEPATH
+	const PathCache::Corridor* pCorridor = sUsePathCache ? m_PathCache.Find(pStartTriangle, pEndTriangle, m_pNavGraph->GetVersion()) : nullptr;
+	bool isPathFound{};
+	if (pCorridor)
 	{
-		int nodeIdx{ m_pNavGraph->GetNodeIdxFromLineIdx(lineIdx) };
-		if (nodeIdx != invalid_node_index)
-		{
-			GraphConnection2D* pConnection{ new GraphConnection2D(pStartNode->GetIndex(), nodeIdx) };
-			pConnection->SetCost(Elite::Distance(graphClone->GetNode(nodeIdx)->GetPosition(), graphClone->GetNodePos(pStartNode)));
-			graphClone->AddConnection(pConnection);
-		}
+		isPathFound = pCorridor->isPathFound;
+		m_NodePath.clear();
+		for (int nodeIdx : pCorridor->portalNodes)
+			m_NodePath.push_back(m_pNavGraph->GetNode(nodeIdx));
 	}
-
-	//Create extra node for the End Node
-	NavGraphNode* pEndNode(new NavGraphNode(graphClone->GetNextFreeNodeIndex(), -1, endPos));
-	graphClone->AddNode(pEndNode);
-	for (int lineIdx : pEndTriangle->metaData.IndexLines)
+	else
 	{
-		int nodeIdx{ m_pNavGraph->GetNodeIdxFromLineIdx(lineIdx) };
-		if (nodeIdx != invalid_node_index)
-		{
-			GraphConnection2D* pConnection{ new GraphConnection2D(pEndNode->GetIndex(), nodeIdx) };
-			pConnection->SetCost(Elite::Distance(graphClone->GetNode(nodeIdx)->GetPosition(), graphClone->GetNodePos(pEndNode)));
-			graphClone->AddConnection(pConnection);
-		}
+		isPathFound = m_pPathFinder->FindPath(start, end, m_NodePath, m_pOptimizedGraph);
+		if (sUsePathCache)
+			m_PathCache.Insert(pStartTriangle, pEndTriangle, m_pNavGraph->GetVersion(), m_NodePath, isPathFound);
+		if (isPathFound)
+			std::cout << "New Path Calculated" << std::endl;
 	}
+	SEARCH_STATISTIC(timings.searchTime = timer.Lap());
 
-	//Run A star on new graph
-	//CALCULATEPATH
-	//If we have nodes and the target is not the startNode, find a path!
-	auto aStarPathFinder = AStar<NavGraphNode, GraphConnection2D>(graphClone.get(), Elite::HeuristicFunctions::Manhattan);
-	auto m_vPath = aStarPathFinder.FindPath(pStartNode, pEndNode, m_pOptimizedGraph);
-	std::cout << "New Path Calculated" << std::endl;
+	//A cache hit didn't search at all
+	SEARCH_STATISTIC(const SearchStatistics searchStatistics = pCorridor ? SearchStatistics{} : m_pPathFinder->GetLastSearchStatistics());
+	if (!isPathFound)
+	{
+		SEARCH_STATISTIC(m_SearchStatistics.Record(searchStatistics, timings));
+		return;
+	}
 
 	m_DebugNodePositions.clear();
-	for (auto pNode : m_vPath)
+	m_DebugNodePositions.push_back(startPos);
+	for (auto pNode : m_NodePath)
 	{
-		finalPath.push_back(pNode->GetPosition());
+		m_DebugNodePositions.push_back(pNode->GetPosition());
 	}
-	m_DebugNodePositions = finalPath;
+	m_DebugNodePositions.push_back(endPos);
 
-	//Extra: Run optimizer on new graph, Make sure the A star path is fine before uncommenting this!
-	m_Portals = SSFA::FindPortals(m_vPath, m_pNavGraph->GetNavMeshPolygon());
-	finalPath = SSFA::OptimizePortals(m_Portals);
+	//Extra: Run optimizer on the path, always with the exact start and end position
+	SEARCH_STATISTIC(timer.Lap());
+	SSFA::FindPortals(startPos, m_NodePath, endPos, m_pNavGraph->GetNavMeshPolygon(), m_Portals);
+	SEARCH_STATISTIC(timings.findPortalsTime = timer.Lap());
+	SSFA::OptimizePortals(m_Portals, finalPath);
+	SEARCH_STATISTIC(timings.optimizePortalsTime = timer.Lap());
 
-	return finalPath;
+	SEARCH_STATISTIC(m_SearchStatistics.Record(searchStatistics, timings));
 }
 
 void App_FasterAStar::UpdateImGui()
@@ -294,6 +405,30 @@ void App_FasterAStar::UpdateImGui()
 		ImGui::Indent();
 		ImGui::Text("%.3f ms/frame", 1000.0f / ImGui::GetIO().Framerate);
 		ImGui::Text("%.1f FPS", ImGui::GetIO().Framerate);
+#ifdef USE_SEARCH_STATISTICS
+		if (m_SearchStatistics.GetNrOfQueries() > 0)
+		{
+			const SearchStatistics& lastStatistics = m_SearchStatistics.GetLastStatistics();
+			const PathQueryTimings& lastTimings = m_SearchStatistics.GetLastTimings();
+			ImGui::Text("Last search");
+			ImGui::Indent();
+			ImGui::Text("%d expanded", lastStatistics.nrOfExpandedNodes);
+			ImGui::Text("%d relaxed", lastStatistics.nrOfRelaxedEdges);
+			ImGui::Text("%d pruned", lastStatistics.nrOfPrunedEdges);
+			ImGui::Text("%d peak open", lastStatistics.peakOpenListSize);
+			ImGui::Text("lookup %.3f ms", lastTimings.triangleLookupTime * 1000.f);
+			ImGui::Text("search %.3f ms", lastTimings.searchTime * 1000.f);
+			ImGui::Text("portals %.3f ms", lastTimings.findPortalsTime * 1000.f);
+			ImGui::Text("funnel %.3f ms", lastTimings.optimizePortalsTime * 1000.f);
+			ImGui::Unindent();
+			ImGui::Text("%d searches", m_SearchStatistics.GetNrOfQueries());
+			ImGui::Indent();
+			ImGui::Text("p50 %.0f us", m_SearchStatistics.GetSearchTime().GetPercentile(50.f));
+			ImGui::Text("p99 %.0f us", m_SearchStatistics.GetSearchTime().GetPercentile(99.f));
+			ImGui::Unindent();
+			m_DumpStatistics = ImGui::Button("Dump Stats", ImVec2(70, 15.f));
+		}
+#endif
 		ImGui::Unindent();
 
 		ImGui::Spacing();
@@ -303,6 +438,53 @@ void App_FasterAStar::UpdateImGui()
 
 		m_Save = ImGui::Button("Save", ImVec2(50, 15.f));
 		m_Load = ImGui::Button("Load", ImVec2(50, 15.f));
+		m_Benchmark = ImGui::Button("Benchmark", ImVec2(70, 15.f));
+		m_ToggleDoor = ImGui::Button(m_pDoor ? "Open Door" : "Close Door", ImVec2(70, 15.f));
+		m_RunBatch = ImGui::Button("Batch 1000", ImVec2(70, 15.f));
+		if (m_pOptimizedGraph->IsRebaking())
+			ImGui::Text("Baking %d/%d", m_pOptimizedGraph->GetNrOfRebakedSources(), m_pOptimizedGraph->GetNrOfDirtySources());
+		if (m_BoundingBoxTestResult.nrOfRuns > 0)
+		{
+			ImGui::Text("Box test");
+			ImGui::Indent();
+			ImGui::Text("scalar %.3f ms", m_BoundingBoxTestResult.scalarTime * 1000.f);
+			ImGui::Text("simd   %.3f ms", m_BoundingBoxTestResult.simdTime * 1000.f);
+			ImGui::Unindent();
+		}
+		if (m_TriangleLookupResult.nrOfQueries > 0)
+		{
+			ImGui::Text("Triangle lookup");
+			ImGui::Indent();
+			ImGui::Text("linear %.3f ms", m_TriangleLookupResult.linearTime * 1000.f);
+			ImGui::Text("grid   %.3f ms", m_TriangleLookupResult.gridTime * 1000.f);
+			ImGui::Unindent();
+		}
+		if (sUsePathCache)
+		{
+			const PathCacheStatistics& cacheStatistics = m_PathCache.GetStatistics();
+			ImGui::Text("Path cache");
+			ImGui::Indent();
+			ImGui::Text("%d hits, %d misses", cacheStatistics.nrOfHits, cacheStatistics.nrOfMisses);
+			ImGui::Text("%d/%d entries", static_cast<int>(m_PathCache.GetSize()), static_cast<int>(m_PathCache.GetCapacity()));
+			ImGui::Unindent();
+		}
+		if (m_BatchStatistics.nrOfQueries > 0)
+		{
+			ImGui::Text("Batch paths");
+			ImGui::Indent();
+			ImGui::Text("%d/%d found", m_BatchStatistics.nrOfPathsFound, m_BatchStatistics.nrOfQueries);
+			ImGui::Text("%.3f ms, %d threads", m_BatchStatistics.time * 1000.f, m_BatchStatistics.nrOfWorkers);
+			ImGui::Text("%.0f queries/s", m_BatchStatistics.queriesPerSecond);
+			ImGui::Unindent();
+		}
+		if (!m_TriangulationResults.empty())
+		{
+			ImGui::Text("Triangulation");
+			ImGui::Indent();
+			for (const auto& result : m_TriangulationResults)
+				ImGui::Text("%d: ear %.2f ms, cdt %.2f ms", result.nrOfObstacles, result.earClippingTime * 1000.f, result.delaunayTime * 1000.f);
+			ImGui::Unindent();
+		}
 		
 		ImGui::Spacing();
 		ImGui::Separator();
@@ -314,6 +496,14 @@ void App_FasterAStar::UpdateImGui()
 		ImGui::Checkbox("Show Portals", &sDrawPortals);
 		ImGui::Checkbox("Show Path Nodes", &sDrawNonOptimisedPath);
 		ImGui::Checkbox("Show Final Path", &sDrawFinalPath);
+		if (ImGui::Checkbox("Path Cache", &sUsePathCache))
+			m_PathCache.Clear();
+		if (ImGui::Checkbox("16-bit Boxes", &sUseQuantizedBoxes))
+		{
+			if (sUseQuantizedBoxes && m_pOptimizedGraph->GetQuantizedBoundingBoxTable().IsEmpty())
+				m_pOptimizedGraph->QuantizeBoundingBoxes(m_pNavGraph->GetNavMeshPolygon());
+			m_pOptimizedGraph->SetBoundingBoxPrecision(sUseQuantizedBoxes ? BoundingBoxPrecision::Quantized16 : BoundingBoxPrecision::Float);
+		}
 		ImGui::Spacing();
 		ImGui::Spacing();
 
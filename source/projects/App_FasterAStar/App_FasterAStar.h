@@ -8,7 +8,11 @@
 
 #include "framework\EliteAI\EliteGraphs\EliteGraphUtilities\EGraphRenderer.h"
 #include "framework\EliteAI\EliteNavigation\Algorithms\EPathSmoothing.h"
+#include "framework\EliteAI\EliteGraphs\EliteGraphAlgorithms\EAStar.h"
 #include "OptimizedGraph.h"
+#include "PathfindingBenchmarks.h"
+#include "BatchPathfinder.h"
+#include "PathCache.h"
 
 class NavigationColliderElement;
 class SteeringAgent;
@@ -48,10 +52,18 @@ private:
 
 	// --Level--
 	std::vector<NavigationColliderElement*> m_vNavigationColliders = {};
+	NavigationColliderElement* m_pDoor = nullptr; // toggled at runtime, nullptr while open
 	OptimizedGraph< Elite::NavGraphNode, Elite::GraphConnection2D>* m_pOptimizedGraph;
 
 	// --Pathfinder--
 	std::vector<Elite::Vector2> m_vPath;
+	Elite::AStar<Elite::NavGraphNode, Elite::GraphConnection2D>* m_pPathFinder = nullptr;
+	std::vector<Elite::NavGraphNode*> m_NodePath; // reused by every FindPath call
+	PathCache m_PathCache{};
+	Elite::SearchStatisticsRecorder m_SearchStatistics{}; // every FindPath that got to the search, empty when USE_SEARCH_STATISTICS is off
+	BatchPathfinder* m_pBatchPathfinder = nullptr;
+	std::vector<PathQuery> m_BatchQueries;
+	PathArena m_BatchPaths; // reused by every batch
 
 	// --Graph--
 	Elite::NavGraph* m_pNavGraph = nullptr;
@@ -65,12 +77,27 @@ private:
 	static bool sDrawPortals;
 	static bool sDrawFinalPath;
 	static bool sDrawNonOptimisedPath;
+	static bool sUseQuantizedBoxes;
+	static bool sUsePathCache;
 
 	void UpdateImGui();
-	std::vector<Elite::Vector2> FindPath(Elite::Vector2 startPos, Elite::Vector2 endPos);
+	void FindPath(Elite::Vector2 startPos, Elite::Vector2 endPos, std::vector<Elite::Vector2>& finalPath);
+
+	void RunBenchmarks();
+	void RunBatch(int nrOfQueries);
+	void ToggleDoor();
 
 	bool m_Save{ false };
 	bool m_Load{ false };
+	bool m_Benchmark{ false };
+	bool m_ToggleDoor{ false };
+	bool m_RunBatch{ false };
+	bool m_DumpStatistics{ false };
+	bool m_SaveWhenBaked{ false }; // the background bake of a missing or stale goal bounds file is saved once it is done
+	PathfindingBenchmarks::BoundingBoxTestResult m_BoundingBoxTestResult{};
+	PathfindingBenchmarks::TriangleLookupResult m_TriangleLookupResult{};
+	std::vector<PathfindingBenchmarks::TriangulationResult> m_TriangulationResults{};
+	BatchStatistics m_BatchStatistics{};
 private:
 	//C++ make the class non-copyable
 	App_FasterAStar(const App_FasterAStar&) = delete;
@@ -0,0 +1,99 @@
+#include "stdafx.h"
+#include "BatchPathfinder.h"
+
+using namespace Elite;
+
+BatchPathfinder::BatchPathfinder(NavGraph* pNavGraph, OptimizedGraph<NavGraphNode, GraphConnection2D>* pOptimizedGraph,
+	Heuristic hFunction, unsigned int nrOfWorkers)
+	: m_pNavGraph{ pNavGraph }
+	, m_pOptimizedGraph{ pOptimizedGraph }
+	, m_ThreadPool{ nrOfWorkers }
+{
+	for (unsigned int i{}; i < m_ThreadPool.GetNrOfWorkers(); ++i)
+		m_vpWorkerContexts.push_back(new WorkerContext(pNavGraph, hFunction));
+}
+
+BatchPathfinder::~BatchPathfinder()
+{
+	for (auto pContext : m_vpWorkerContexts)
+		SAFE_DELETE(pContext);
+	m_vpWorkerContexts.clear();
+}
+
+BatchStatistics BatchPathfinder::FindPaths(const std::vector<PathQuery>& queries, PathArena& arena)
+{
+	using Clock = std::chrono::high_resolution_clock;
+	const auto batchStart = Clock::now();
+
+	const int nrOfQueries = static_cast<int>(queries.size());
+	arena.Clear();
+	arena.results.resize(nrOfQueries);
+	m_QueryWorkers.resize(nrOfQueries);
+	for (auto pContext : m_vpWorkerContexts)
+		pContext->points.clear();
+
+	//Every query only writes its own result slot and the points buffer of the worker answering it
+	m_ThreadPool.ParallelFor(nrOfQueries, [this, &queries, &arena](unsigned int workerIdx, int i)
+		{
+			m_QueryWorkers[i] = workerIdx;
+			FindPath(queries[i], *m_vpWorkerContexts[workerIdx], arena.results[i]);
+		});
+
+	//Gather the paths in query order, firstPoint still points into the worker's buffer until here
+	BatchStatistics statistics{};
+	for (int i{}; i < nrOfQueries; ++i)
+	{
+		PathQueryResult& result = arena.results[i];
+		const std::vector<Vector2>& workerPoints = m_vpWorkerContexts[m_QueryWorkers[i]]->points;
+		const int firstPoint = static_cast<int>(arena.points.size());
+		arena.points.insert(arena.points.end(), workerPoints.begin() + result.firstPoint, workerPoints.begin() + result.firstPoint + result.nrOfPoints);
+		result.firstPoint = firstPoint;
+
+		if (result.status == PathQueryStatus::Found)
+			++statistics.nrOfPathsFound;
+	}
+	const auto batchEnd = Clock::now();
+
+	statistics.nrOfQueries = nrOfQueries;
+	statistics.nrOfWorkers = m_ThreadPool.GetNrOfWorkers();
+	statistics.time = std::chrono::duration<float>(batchEnd - batchStart).count();
+	statistics.queriesPerSecond = statistics.time > 0.f ? nrOfQueries / statistics.time : 0.f;
+	return statistics;
+}
+
+void BatchPathfinder::FindPath(const PathQuery& query, WorkerContext& context, PathQueryResult& result) const
+{
+	result = {};
+	result.firstPoint = static_cast<int>(context.points.size());
+
+	//Same steps as App_FasterAStar::FindPath, with the scratch space of this worker
+	Polygon* pNavMesh = m_pNavGraph->GetNavMeshPolygon();
+	const Triangle* pStartTriangle = pNavMesh->GetTriangleFromPosition(query.start);
+	const Triangle* pGoalTriangle = pNavMesh->GetTriangleFromPosition(query.goal);
+	if (!pStartTriangle || !pGoalTriangle)
+	{
+		result.status = PathQueryStatus::OutsideNavMesh;
+		return;
+	}
+	if (pStartTriangle == pGoalTriangle)
+	{
+		context.points.push_back(query.goal);
+		result.nrOfPoints = 1;
+		result.status = PathQueryStatus::Found;
+		return;
+	}
+
+	const SearchEndpoint start{ m_pNavGraph->GetSearchEndpoint(query.start, pStartTriangle) };
+	const SearchEndpoint goal{ m_pNavGraph->GetSearchEndpoint(query.goal, pGoalTriangle) };
+	if (!context.pathfinder.FindPath(start, goal, context.nodePath, m_pOptimizedGraph))
+	{
+		result.status = PathQueryStatus::NoPath;
+		return;
+	}
+
+	SSFA::FindPortals(query.start, context.nodePath, query.goal, pNavMesh, context.portals);
+	SSFA::OptimizePortals(context.portals, context.path);
+	context.points.insert(context.points.end(), context.path.begin(), context.path.end());
+	result.nrOfPoints = static_cast<int>(context.path.size());
+	result.status = PathQueryStatus::Found;
+}
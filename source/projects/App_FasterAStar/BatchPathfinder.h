@@ -0,0 +1,91 @@
+#pragma once
+#include <vector>
+#include "framework/EliteAI/EliteGraphs/ENavGraph.h"
+#include "framework/EliteAI/EliteGraphs/EliteGraphAlgorithms/EAStar.h"
+#include "framework/EliteAI/EliteNavigation/Algorithms/EPathSmoothing.h"
+#include "framework/EliteHelpers/EThreadPool.h"
+#include "OptimizedGraph.h"
+
+struct PathQuery
+{
+	Elite::Vector2 start = {};
+	Elite::Vector2 goal = {};
+};
+
+enum class PathQueryStatus
+{
+	Found,
+	NoPath, // both endpoints are on the navmesh but not connected
+	OutsideNavMesh // the start or the goal isn't inside any triangle
+};
+
+struct PathQueryResult
+{
+	int firstPoint = 0; // into PathArena::points
+	int nrOfPoints = 0;
+	PathQueryStatus status = PathQueryStatus::NoPath;
+};
+
+// Caller owned storage for the smoothed paths of a batch, all paths are stored back to back in one buffer.
+// Reusing the same arena for every batch means it stops allocating once it has grown to the largest batch.
+struct PathArena
+{
+	std::vector<Elite::Vector2> points;
+	std::vector<PathQueryResult> results; // one per query, in query order
+
+	void Clear() { points.clear(); results.clear(); }
+	const Elite::Vector2* GetPath(int queryIdx) const { return points.data() + results[queryIdx].firstPoint; }
+};
+
+struct BatchStatistics
+{
+	int nrOfQueries = 0;
+	int nrOfPathsFound = 0;
+	unsigned int nrOfWorkers = 0;
+	float time = 0.f; // seconds for the whole batch
+	float queriesPerSecond = 0.f;
+};
+
+// Answers many path queries at once: the queries are split over a pool of worker threads, every worker
+// has its own A*, search context and funnel scratch space, so the graph itself is only ever read.
+// The NavGraph and the OptimizedGraph must not change while FindPaths runs, i.e. don't toggle obstacles or
+// call ApplyFinishedRebake from another thread (a rebake running in the background is fine, it only works on a snapshot).
+class BatchPathfinder final
+{
+public:
+	using NodePathfinder = Elite::AStar<Elite::NavGraphNode, Elite::GraphConnection2D>;
+
+	//nrOfWorkers includes the calling thread, 0 means one worker per hardware thread
+	BatchPathfinder(Elite::NavGraph* pNavGraph, OptimizedGraph<Elite::NavGraphNode, Elite::GraphConnection2D>* pOptimizedGraph,
+		Elite::Heuristic hFunction, unsigned int nrOfWorkers = 0);
+	~BatchPathfinder();
+
+	//Overwrites the arena with one result per query, blocks until every query is answered
+	BatchStatistics FindPaths(const std::vector<PathQuery>& queries, PathArena& arena);
+
+	unsigned int GetNrOfWorkers() const { return m_ThreadPool.GetNrOfWorkers(); }
+
+private:
+	struct WorkerContext
+	{
+		WorkerContext(Elite::NavGraph* pNavGraph, Elite::Heuristic hFunction) : pathfinder{ pNavGraph, hFunction } {}
+
+		NodePathfinder pathfinder;
+		std::vector<Elite::NavGraphNode*> nodePath;
+		std::vector<Elite::Portal> portals;
+		std::vector<Elite::Vector2> path;
+		std::vector<Elite::Vector2> points; // paths of the queries this worker answered, gathered into the arena afterwards
+	};
+
+	void FindPath(const PathQuery& query, WorkerContext& context, PathQueryResult& result) const;
+
+	Elite::NavGraph* m_pNavGraph = nullptr;
+	OptimizedGraph<Elite::NavGraphNode, Elite::GraphConnection2D>* m_pOptimizedGraph = nullptr;
+	Elite::ThreadPool m_ThreadPool;
+	std::vector<WorkerContext*> m_vpWorkerContexts;
+	std::vector<unsigned int> m_QueryWorkers; // which worker answered each query of the current batch
+
+	//C++ make the class non-copyable
+	BatchPathfinder(const BatchPathfinder&) = delete;
+	BatchPathfinder& operator=(const BatchPathfinder&) = delete;
+};
@@ -0,0 +1,264 @@
+#pragma once
+#include <vector>
+#include <cfloat>
+#include <cassert>
+#include <memory>
+#include "framework/EliteHelpers/EMappedFile.h"
+
+//Widest instruction set the compiler is allowed to use, the scalar test is always available
+#if defined(__AVX2__)
+#define BOUNDING_BOX_TABLE_AVX2
+#define BOUNDING_BOX_TABLE_SSE2
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BOUNDING_BOX_TABLE_SSE2
+#include <emmintrin.h>
+#endif
+
+// Goal bounding boxes of every edge of a graph, flattened into one array per side (structure of arrays).
+// Edges are numbered like a CSR adjacency: the edges of node i are [GetFirstEdge(i), GetFirstEdge(i + 1)),
+// in the order of the node's connection list. Looking up the box of an edge is a single index, no search.
+// The arrays are either owned by the table or live in a mapped goal bounds file (see Attach).
+class BoundingBoxTable final
+{
+public:
+	BoundingBoxTable() { PointAtStorage(); }
+	BoundingBoxTable(const BoundingBoxTable& other) { *this = other; }
+	BoundingBoxTable& operator=(const BoundingBoxTable& other);
+	// Takes over the arrays without copying them, other is left empty
+	BoundingBoxTable(BoundingBoxTable&& other) { *this = std::move(other); }
+	BoundingBoxTable& operator=(BoundingBoxTable&& other);
+
+	// Starts a new table, nodes have to be added in index order
+	void Clear()
+	{
+		m_pMappedFile.reset();
+		m_FirstEdge.assign(1, 0);
+		m_Left.clear();
+		m_Right.clear();
+		m_Bottom.clear();
+		m_Top.clear();
+		PointAtStorage();
+	}
+	void Reserve(int nrOfNodes, int nrOfEdges)
+	{
+		m_FirstEdge.reserve(nrOfNodes + 1);
+		m_Left.reserve(nrOfEdges);
+		m_Right.reserve(nrOfEdges);
+		m_Bottom.reserve(nrOfEdges);
+		m_Top.reserve(nrOfEdges);
+	}
+
+	// Closes the edges of the current node, the next AddEdge calls belong to the next node
+	void EndNode()
+	{
+		m_FirstEdge.push_back(static_cast<int>(m_Left.size()));
+		PointAtStorage();
+	}
+	void AddEdge(float left, float right, float bottom, float top)
+	{
+		assert(!m_pMappedFile && "<BoundingBoxTable::AddEdge>: an attached table is read-only");
+		m_Left.push_back(left);
+		m_Right.push_back(right);
+		m_Bottom.push_back(bottom);
+		m_Top.push_back(top);
+	}
+	// Box that contains nothing, for edges that aren't on any optimal path
+	void AddEmptyEdge()
+	{
+		AddEdge(FLT_MAX, -FLT_MAX, FLT_MAX, -FLT_MAX);
+	}
+
+	// Reads the arrays in place, pMappedFile keeps them alive for as long as the table uses them
+	void Attach(std::shared_ptr<const Elite::MappedFile> pMappedFile, int nrOfNodes, int nrOfEdges,
+		const int* pFirstEdge, const float* pLeft, const float* pRight, const float* pBottom, const float* pTop);
+	// Copies the arrays out of the mapped file and lets go of it, e.g. before that file is overwritten
+	void Detach();
+
+	bool IsEmpty() const { return m_NrOfEdges == 0; }
+	int GetNrOfNodes() const { return m_NrOfNodes; }
+	int GetNrOfEdges() const { return m_NrOfEdges; }
+	int GetFirstEdge(int nodeIdx) const { return m_pFirstEdge[nodeIdx]; }
+	void GetBox(int edgeIdx, float& left, float& right, float& bottom, float& top) const
+	{
+		left = m_pLeft[edgeIdx];
+		right = m_pRight[edgeIdx];
+		bottom = m_pBottom[edgeIdx];
+		top = m_pTop[edgeIdx];
+	}
+
+	// Raw arrays, GetNrOfNodes() + 1 edge offsets and GetNrOfEdges() sides
+	const int* GetFirstEdges() const { return m_pFirstEdge; }
+	const float* GetLeftSides() const { return m_pLeft; }
+	const float* GetRightSides() const { return m_pRight; }
+	const float* GetBottomSides() const { return m_pBottom; }
+	const float* GetTopSides() const { return m_pTop; }
+
+	bool IsInside(int edgeIdx, float x, float y) const
+	{
+		assert(edgeIdx >= 0 && edgeIdx < GetNrOfEdges() && "<BoundingBoxTable::IsInside>: invalid edge index");
+		return x > m_pLeft[edgeIdx] && x < m_pRight[edgeIdx] && y > m_pBottom[edgeIdx] && y < m_pTop[edgeIdx];
+	}
+
+	// Tests a batch of consecutive edges at once, bit i is set when (x, y) is inside the box of edge firstEdge + i.
+	// Uses AVX2 (8 boxes per step) or SSE2 (4 boxes per step) when the build allows it.
+	enum { max_batch_edges = 32 };
+	unsigned int GetInsideMask(int firstEdge, int nrOfEdges, float x, float y) const;
+	// Same result, one box at a time
+	unsigned int GetInsideMaskScalar(int firstEdge, int nrOfEdges, float x, float y) const;
+
+private:
+	//Storage of a table that is built in memory
+	std::vector<int> m_FirstEdge{ 0 };
+	std::vector<float> m_Left;
+	std::vector<float> m_Right;
+	std::vector<float> m_Bottom;
+	std::vector<float> m_Top;
+	std::shared_ptr<const Elite::MappedFile> m_pMappedFile; // set when the arrays live in a mapped file
+
+	//Arrays the queries read, they point into the storage above or into the mapped file
+	const int* m_pFirstEdge = nullptr;
+	const float* m_pLeft = nullptr;
+	const float* m_pRight = nullptr;
+	const float* m_pBottom = nullptr;
+	const float* m_pTop = nullptr;
+	int m_NrOfNodes = 0;
+	int m_NrOfEdges = 0;
+
+	void PointAtStorage()
+	{
+		m_pFirstEdge = m_FirstEdge.data();
+		m_pLeft = m_Left.data();
+		m_pRight = m_Right.data();
+		m_pBottom = m_Bottom.data();
+		m_pTop = m_Top.data();
+		m_NrOfNodes = static_cast<int>(m_FirstEdge.size()) - 1;
+		m_NrOfEdges = m_FirstEdge.back();
+	}
+};
+
+inline BoundingBoxTable& BoundingBoxTable::operator=(const BoundingBoxTable& other)
+{
+	if (this == &other)
+		return *this;
+
+	m_FirstEdge = other.m_FirstEdge;
+	m_Left = other.m_Left;
+	m_Right = other.m_Right;
+	m_Bottom = other.m_Bottom;
+	m_Top = other.m_Top;
+
+	if (other.m_pMappedFile)
+		Attach(other.m_pMappedFile, other.m_NrOfNodes, other.m_NrOfEdges, other.m_pFirstEdge, other.m_pLeft, other.m_pRight, other.m_pBottom, other.m_pTop);
+	else
+	{
+		m_pMappedFile.reset();
+		PointAtStorage();
+	}
+	return *this;
+}
+
+inline BoundingBoxTable& BoundingBoxTable::operator=(BoundingBoxTable&& other)
+{
+	if (this == &other)
+		return *this;
+
+	//A moved vector keeps its buffer, so the arrays stay where other's pointers point, owned or mapped
+	m_FirstEdge = std::move(other.m_FirstEdge);
+	m_Left = std::move(other.m_Left);
+	m_Right = std::move(other.m_Right);
+	m_Bottom = std::move(other.m_Bottom);
+	m_Top = std::move(other.m_Top);
+	m_pMappedFile = std::move(other.m_pMappedFile);
+	m_pFirstEdge = other.m_pFirstEdge;
+	m_pLeft = other.m_pLeft;
+	m_pRight = other.m_pRight;
+	m_pBottom = other.m_pBottom;
+	m_pTop = other.m_pTop;
+	m_NrOfNodes = other.m_NrOfNodes;
+	m_NrOfEdges = other.m_NrOfEdges;
+
+	other.Clear();
+	return *this;
+}
+
+inline void BoundingBoxTable::Attach(std::shared_ptr<const Elite::MappedFile> pMappedFile, int nrOfNodes, int nrOfEdges,
+	const int* pFirstEdge, const float* pLeft, const float* pRight, const float* pBottom, const float* pTop)
+{
+	assert(pFirstEdge[nrOfNodes] == nrOfEdges && "<BoundingBoxTable::Attach>: edge offsets don't match the amount of edges");
+
+	Clear();
+	m_pMappedFile = std::move(pMappedFile);
+	m_pFirstEdge = pFirstEdge;
+	m_pLeft = pLeft;
+	m_pRight = pRight;
+	m_pBottom = pBottom;
+	m_pTop = pTop;
+	m_NrOfNodes = nrOfNodes;
+	m_NrOfEdges = nrOfEdges;
+}
+
+inline void BoundingBoxTable::Detach()
+{
+	if (!m_pMappedFile)
+		return;
+
+	m_FirstEdge.assign(m_pFirstEdge, m_pFirstEdge + m_NrOfNodes + 1);
+	m_Left.assign(m_pLeft, m_pLeft + m_NrOfEdges);
+	m_Right.assign(m_pRight, m_pRight + m_NrOfEdges);
+	m_Bottom.assign(m_pBottom, m_pBottom + m_NrOfEdges);
+	m_Top.assign(m_pTop, m_pTop + m_NrOfEdges);
+	m_pMappedFile.reset();
+	PointAtStorage();
+}
+
+inline unsigned int BoundingBoxTable::GetInsideMask(int firstEdge, int nrOfEdges, float x, float y) const
+{
+	assert(nrOfEdges >= 0 && nrOfEdges <= max_batch_edges && "<BoundingBoxTable::GetInsideMask>: too many edges for one batch");
+	assert(firstEdge >= 0 && firstEdge + nrOfEdges <= GetNrOfEdges() && "<BoundingBoxTable::GetInsideMask>: invalid edge range");
+
+	unsigned int mask{};
+	int i{};
+
+#ifdef BOUNDING_BOX_TABLE_AVX2
+	const __m256 x8 = _mm256_set1_ps(x);
+	const __m256 y8 = _mm256_set1_ps(y);
+	for (; i + 8 <= nrOfEdges; i += 8)
+	{
+		const int e = firstEdge + i;
+		const __m256 insideX = _mm256_and_ps(_mm256_cmp_ps(x8, _mm256_loadu_ps(m_pLeft + e), _CMP_GT_OQ), _mm256_cmp_ps(x8, _mm256_loadu_ps(m_pRight + e), _CMP_LT_OQ));
+		const __m256 insideY = _mm256_and_ps(_mm256_cmp_ps(y8, _mm256_loadu_ps(m_pBottom + e), _CMP_GT_OQ), _mm256_cmp_ps(y8, _mm256_loadu_ps(m_pTop + e), _CMP_LT_OQ));
+		mask |= static_cast<unsigned int>(_mm256_movemask_ps(_mm256_and_ps(insideX, insideY))) << i;
+	}
+#endif
+#ifdef BOUNDING_BOX_TABLE_SSE2
+	const __m128 x4 = _mm_set1_ps(x);
+	const __m128 y4 = _mm_set1_ps(y);
+	for (; i + 4 <= nrOfEdges; i += 4)
+	{
+		const int e = firstEdge + i;
+		const __m128 insideX = _mm_and_ps(_mm_cmpgt_ps(x4, _mm_loadu_ps(m_pLeft + e)), _mm_cmplt_ps(x4, _mm_loadu_ps(m_pRight + e)));
+		const __m128 insideY = _mm_and_ps(_mm_cmpgt_ps(y4, _mm_loadu_ps(m_pBottom + e)), _mm_cmplt_ps(y4, _mm_loadu_ps(m_pTop + e)));
+		mask |= static_cast<unsigned int>(_mm_movemask_ps(_mm_and_ps(insideX, insideY))) << i;
+	}
+#endif
+
+	//Leftover edges
+	if (i < nrOfEdges)
+		mask |= GetInsideMaskScalar(firstEdge + i, nrOfEdges - i, x, y) << i;
+
+	return mask;
+}
+
+inline unsigned int BoundingBoxTable::GetInsideMaskScalar(int firstEdge, int nrOfEdges, float x, float y) const
+{
+	assert(nrOfEdges >= 0 && nrOfEdges <= max_batch_edges && "<BoundingBoxTable::GetInsideMaskScalar>: too many edges for one batch");
+
+	unsigned int mask{};
+	for (int i{}; i < nrOfEdges; ++i)
+	{
+		if (IsInside(firstEdge + i, x, y))
+			mask |= 1u << i;
+	}
+	return mask;
+}
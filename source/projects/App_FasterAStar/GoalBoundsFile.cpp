@@ -0,0 +1,215 @@
+#include "stdafx.h"
+#include "GoalBoundsFile.h"
+#include <cstdio>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+namespace
+{
+	uint64_t AlignOffset(uint64_t offset)
+	{
+		return (offset + GoalBoundsFile::array_alignment - 1) / GoalBoundsFile::array_alignment * GoalBoundsFile::array_alignment;
+	}
+
+	//Reserves an aligned section of size bytes and returns its offset
+	uint64_t AddSection(uint64_t& fileSize, uint64_t size)
+	{
+		const uint64_t offset{ AlignOffset(fileSize) };
+		fileSize = offset + size;
+		return offset;
+	}
+
+	void WriteSection(std::ofstream& out, uint64_t offset, const void* pData, uint64_t size)
+	{
+		//Pad up to the start of the section
+		static const char padding[GoalBoundsFile::array_alignment]{};
+		const uint64_t position{ static_cast<uint64_t>(out.tellp()) };
+		out.write(padding, static_cast<std::streamsize>(offset - position));
+		out.write(static_cast<const char*>(pData), static_cast<std::streamsize>(size));
+	}
+
+	bool IsSectionValid(const GoalBoundsFile::Header& header, uint64_t offset, uint64_t size)
+	{
+		return offset % GoalBoundsFile::array_alignment == 0 && offset >= header.headerSize && offset + size <= header.fileSize;
+	}
+
+	//Moves the finished file over path
+	bool MoveOverFile(const std::string& tmpPath, const std::string& path)
+	{
+#ifdef _WIN32
+		return MoveFileExA(tmpPath.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+		return std::rename(tmpPath.c_str(), path.c_str()) == 0;
+#endif
+	}
+
+	template<typename T>
+	const T* GetSection(const Elite::MappedFile& file, uint64_t offset)
+	{
+		return reinterpret_cast<const T*>(file.GetData() + offset);
+	}
+}
+
+bool GoalBoundsFile::Save(const std::string& path, const BoundingBoxTable& boxes, const QuantizedBoundingBoxTable& quantizedBoxes, uint64_t navMeshHash, uint64_t graphHash)
+{
+	assert((quantizedBoxes.IsEmpty() || quantizedBoxes.GetNrOfEdges() == boxes.GetNrOfEdges()) && "<GoalBoundsFile::Save>: tables belong to different graphs");
+
+	Header header{};
+	header.magic = magic;
+	header.version = version;
+	header.byteOrderMark = byte_order_mark;
+	header.headerSize = sizeof(Header);
+	header.flags = has_float_boxes;
+	header.nrOfNodes = boxes.GetNrOfNodes();
+	header.nrOfEdges = boxes.GetNrOfEdges();
+	header.navMeshHash = navMeshHash;
+	header.graphHash = graphHash;
+
+	//Lay out the sections
+	const uint64_t nrOfEdges{ static_cast<uint64_t>(header.nrOfEdges) };
+	uint64_t fileSize{ sizeof(Header) };
+	header.firstEdgeOffset = AddSection(fileSize, (header.nrOfNodes + 1) * sizeof(int32_t));
+	for (uint64_t& offset : header.floatSideOffsets)
+		offset = AddSection(fileSize, nrOfEdges * sizeof(float));
+
+	const bool hasQuantizedBoxes{ !quantizedBoxes.IsEmpty() };
+	if (hasQuantizedBoxes)
+	{
+		header.flags |= has_quantized_boxes;
+		header.quantizedBoundsMin[0] = quantizedBoxes.GetBoundsMin().x;
+		header.quantizedBoundsMin[1] = quantizedBoxes.GetBoundsMin().y;
+		header.quantizedBoundsMax[0] = quantizedBoxes.GetBoundsMax().x;
+		header.quantizedBoundsMax[1] = quantizedBoxes.GetBoundsMax().y;
+		for (uint64_t& offset : header.quantizedSideOffsets)
+			offset = AddSection(fileSize, nrOfEdges * sizeof(uint16_t));
+	}
+	header.fileSize = fileSize;
+
+	const std::string tmpPath{ path + ".tmp" };
+	std::ofstream out{ tmpPath, std::ios::out | std::ios::binary };
+	if (!out.is_open())
+		return false;
+
+	out.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+	WriteSection(out, header.firstEdgeOffset, boxes.GetFirstEdges(), (header.nrOfNodes + 1) * sizeof(int32_t));
+	const float* floatSides[4]{ boxes.GetLeftSides(), boxes.GetRightSides(), boxes.GetBottomSides(), boxes.GetTopSides() };
+	for (int i{}; i < 4; ++i)
+		WriteSection(out, header.floatSideOffsets[i], floatSides[i], nrOfEdges * sizeof(float));
+
+	if (hasQuantizedBoxes)
+	{
+		const unsigned short* quantizedSides[4]{ quantizedBoxes.GetLeftSides(), quantizedBoxes.GetRightSides(), quantizedBoxes.GetBottomSides(), quantizedBoxes.GetTopSides() };
+		for (int i{}; i < 4; ++i)
+			WriteSection(out, header.quantizedSideOffsets[i], quantizedSides[i], nrOfEdges * sizeof(uint16_t));
+	}
+
+	out.close();
+	if (!out.good() || !MoveOverFile(tmpPath, path))
+	{
+		std::remove(tmpPath.c_str());
+		return false;
+	}
+	return true;
+}
+
+bool GoalBoundsFile::Load(const std::string& path, BoundingBoxTable& boxes, QuantizedBoundingBoxTable& quantizedBoxes, Header* pHeader)
+{
+	auto pFile = std::make_shared<Elite::MappedFile>();
+	if (!pFile->Open(path))
+		return false;
+
+	//Validate everything before pointing at it
+	if (pFile->GetSize() < sizeof(Header))
+	{
+		std::cout << "GoalBoundsFile: " << path << " is too small to be a goal bounds file" << std::endl;
+		return false;
+	}
+
+	const Header& header{ *GetSection<Header>(*pFile, 0) };
+	if (header.magic != magic || header.headerSize != sizeof(Header))
+	{
+		std::cout << "GoalBoundsFile: " << path << " is not a goal bounds file" << std::endl;
+		return false;
+	}
+	if (header.byteOrderMark != byte_order_mark)
+	{
+		std::cout << "GoalBoundsFile: " << path << " was written on a machine with a different byte order" << std::endl;
+		return false;
+	}
+	if (header.version != version)
+	{
+		std::cout << "GoalBoundsFile: " << path << " has version " << header.version << ", expected " << version << std::endl;
+		return false;
+	}
+
+	const uint64_t nrOfEdges{ static_cast<uint64_t>(header.nrOfEdges) };
+	bool isValid{ header.fileSize == pFile->GetSize() && header.nrOfNodes >= 0 && header.nrOfEdges >= 0 && (header.flags & has_float_boxes) };
+	isValid = isValid && IsSectionValid(header, header.firstEdgeOffset, (static_cast<uint64_t>(header.nrOfNodes) + 1) * sizeof(int32_t));
+	for (uint64_t offset : header.floatSideOffsets)
+		isValid = isValid && IsSectionValid(header, offset, nrOfEdges * sizeof(float));
+	if (header.flags & has_quantized_boxes)
+	{
+		//The quantized tests divide by the size of the bounds
+		isValid = isValid && QuantizedBoundingBoxTable::AreBoundsValid({ header.quantizedBoundsMin[0], header.quantizedBoundsMin[1] },
+			{ header.quantizedBoundsMax[0], header.quantizedBoundsMax[1] });
+		for (uint64_t offset : header.quantizedSideOffsets)
+			isValid = isValid && IsSectionValid(header, offset, nrOfEdges * sizeof(uint16_t));
+	}
+	//The tables index the sides with these offsets without checking them, so they have to start at 0, never go back and end at nrOfEdges
+	if (isValid)
+	{
+		const int32_t* pFirstEdge{ GetSection<int32_t>(*pFile, header.firstEdgeOffset) };
+		isValid = pFirstEdge[0] == 0 && pFirstEdge[header.nrOfNodes] == header.nrOfEdges;
+		for (int32_t i{}; i < header.nrOfNodes && isValid; ++i)
+			isValid = pFirstEdge[i] <= pFirstEdge[i + 1];
+	}
+	if (!isValid)
+	{
+		std::cout << "GoalBoundsFile: " << path << " is damaged" << std::endl;
+		return false;
+	}
+
+	//Use the arrays in place
+	const int* pFirstEdge{ GetSection<int32_t>(*pFile, header.firstEdgeOffset) };
+	boxes.Attach(pFile, header.nrOfNodes, header.nrOfEdges, pFirstEdge,
+		GetSection<float>(*pFile, header.floatSideOffsets[0]), GetSection<float>(*pFile, header.floatSideOffsets[1]),
+		GetSection<float>(*pFile, header.floatSideOffsets[2]), GetSection<float>(*pFile, header.floatSideOffsets[3]));
+
+	if (header.flags & has_quantized_boxes)
+	{
+		quantizedBoxes.Attach(pFile,
+			{ header.quantizedBoundsMin[0], header.quantizedBoundsMin[1] }, { header.quantizedBoundsMax[0], header.quantizedBoundsMax[1] },
+			header.nrOfNodes, header.nrOfEdges, pFirstEdge,
+			GetSection<uint16_t>(*pFile, header.quantizedSideOffsets[0]), GetSection<uint16_t>(*pFile, header.quantizedSideOffsets[1]),
+			GetSection<uint16_t>(*pFile, header.quantizedSideOffsets[2]), GetSection<uint16_t>(*pFile, header.quantizedSideOffsets[3]));
+	}
+	else
+		quantizedBoxes.Clear();
+
+	if (pHeader)
+		*pHeader = header;
+	return true;
+}
+
+uint64_t GoalBoundsFile::HashNavMesh(const Elite::Polygon& navMesh)
+{
+	uint64_t hash{ 14695981039346656037ull };
+	const auto addBytes = [&hash](const void* pData, size_t size)
+	{
+		const unsigned char* pBytes{ static_cast<const unsigned char*>(pData) };
+		for (size_t i{}; i < size; ++i)
+		{
+			hash ^= pBytes[i];
+			hash *= 1099511628211ull;
+		}
+	};
+
+	for (const Elite::Triangle* pTriangle : navMesh.GetTriangles())
+	{
+		const Elite::Vector2 points[3]{ pTriangle->p1, pTriangle->p2, pTriangle->p3 };
+		addBytes(points, sizeof(points));
+	}
+	return hash;
+}
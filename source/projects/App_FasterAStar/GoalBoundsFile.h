@@ -0,0 +1,56 @@
+#pragma once
+#include <string>
+#include <cstdint>
+#include "BoundingBoxTable.h"
+#include "QuantizedBoundingBoxTable.h"
+
+// On-disk format of baked goal bounds: a fixed header followed by the raw table arrays, every array 64-byte aligned.
+// Loading maps the file and points the tables straight at those arrays, nothing is parsed or copied.
+// Files are only valid on a machine with the same endianness as the one that wrote them, the header says which.
+namespace GoalBoundsFile
+{
+	enum : uint32_t
+	{
+		magic = 0x444E4247, // "GBND" in a little-endian file
+		version = 3, // 2: graph fingerprint, 3: boxes cover the goal areas of their nodes
+		byte_order_mark = 0x0102, // reads back as 0x0201 on the other endianness
+		array_alignment = 64
+	};
+
+	enum Flags : uint32_t
+	{
+		has_float_boxes = 1 << 0,
+		has_quantized_boxes = 1 << 1
+	};
+
+	struct Header
+	{
+		uint32_t magic;
+		uint16_t version;
+		uint16_t byteOrderMark;
+		uint32_t headerSize;
+		uint32_t flags;
+		int32_t nrOfNodes;
+		int32_t nrOfEdges;
+		uint64_t navMeshHash; // HashNavMesh of the navmesh the boxes were baked on
+		uint64_t graphHash; // Elite::ComputeGraphFingerprint of the graph the boxes were baked on
+		float quantizedBoundsMin[2];
+		float quantizedBoundsMax[2];
+		uint64_t fileSize;
+		//Byte offsets from the start of the file, 0 when the section isn't there
+		uint64_t firstEdgeOffset; // nrOfNodes + 1 int32
+		uint64_t floatSideOffsets[4]; // left, right, bottom, top: nrOfEdges floats each
+		uint64_t quantizedSideOffsets[4]; // left, right, bottom, top: nrOfEdges uint16 each
+	};
+
+	// Writes the float boxes and, when there are any, the quantized boxes. Both have to belong to the same graph.
+	// The file is written next to path first and then replaces it, so path is never left half written.
+	// The tables must not be attached to path itself (see BoundingBoxTable::Detach).
+	bool Save(const std::string& path, const BoundingBoxTable& boxes, const QuantizedBoundingBoxTable& quantizedBoxes, uint64_t navMeshHash, uint64_t graphHash);
+	// Maps the file and attaches the tables to it, the tables stay untouched when the file is missing or invalid.
+	// A table whose section isn't in the file is cleared.
+	bool Load(const std::string& path, BoundingBoxTable& boxes, QuantizedBoundingBoxTable& quantizedBoxes, Header* pHeader = nullptr);
+
+	// FNV-1a over the triangles of the navmesh
+	uint64_t HashNavMesh(const Elite::Polygon& navMesh);
+}
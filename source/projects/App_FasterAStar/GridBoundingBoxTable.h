@@ -0,0 +1,104 @@
+#pragma once
+#include <vector>
+#include <cassert>
+#include <cstdint>
+#include <algorithm>
+
+// Goal bounding boxes of a grid, one per cell and neighbour direction, in integer cell coordinates.
+// The 8 boxes of a cell are stored next to each other, so the box of a step is found from the cell index and direction alone,
+// independent of the order or the amount of connections of the cell. A box is inclusive: it holds every cell
+// (column, row) with minColumn <= column <= maxColumn and minRow <= row <= maxRow.
+class GridBoundingBoxTable final
+{
+public:
+	// Same order as GridGraph adds its connections: the straight directions first, then the diagonals
+	enum { nr_of_directions = 8 };
+
+	struct Box
+	{
+		int16_t minColumn = 1;
+		int16_t maxColumn = 0;
+		int16_t minRow = 1;
+		int16_t maxRow = 0;
+
+		bool IsEmpty() const { return minColumn > maxColumn; }
+	};
+
+	static int GetColumnOffset(int direction)
+	{
+		static const int columnOffsets[nr_of_directions]{ 1, 0, -1, 0, 1, -1, -1, 1 };
+		return columnOffsets[direction];
+	}
+	static int GetRowOffset(int direction)
+	{
+		static const int rowOffsets[nr_of_directions]{ 0, 1, 0, -1, 1, 1, -1, -1 };
+		return rowOffsets[direction];
+	}
+	// -1 when the offset isn't a step to a neighbour
+	static int GetDirection(int columnOffset, int rowOffset)
+	{
+		if (columnOffset < -1 || columnOffset > 1 || rowOffset < -1 || rowOffset > 1)
+			return -1;
+		static const int directions[9]{ 6, 3, 7, 2, -1, 0, 5, 1, 4 };
+		return directions[(rowOffset + 1) * 3 + columnOffset + 1];
+	}
+
+	// Every box of the new table is empty
+	void Resize(int nrOfColumns, int nrOfRows)
+	{
+		assert(nrOfColumns <= INT16_MAX && nrOfRows <= INT16_MAX && "<GridBoundingBoxTable::Resize>: cell coordinates have to fit in 16 bits");
+		m_NrOfColumns = nrOfColumns;
+		m_NrOfRows = nrOfRows;
+		m_Boxes.assign(static_cast<size_t>(nrOfColumns) * nrOfRows * nr_of_directions, Box{});
+	}
+	void Clear() { Resize(0, 0); }
+
+	bool IsEmpty() const { return m_Boxes.empty(); }
+	int GetNrOfColumns() const { return m_NrOfColumns; }
+	int GetNrOfRows() const { return m_NrOfRows; }
+	int GetNrOfCells() const { return m_NrOfColumns * m_NrOfRows; }
+
+	const Box& GetBox(int cellIdx, int direction) const { return m_Boxes[GetBoxIdx(cellIdx, direction)]; }
+	// Grows the box of the step from cellIdx in direction so it holds (column, row)
+	void AddCell(int cellIdx, int direction, int column, int row)
+	{
+		Box& box = m_Boxes[GetBoxIdx(cellIdx, direction)];
+		if (box.IsEmpty())
+		{
+			box = Box{ static_cast<int16_t>(column), static_cast<int16_t>(column), static_cast<int16_t>(row), static_cast<int16_t>(row) };
+			return;
+		}
+		box.minColumn = std::min(box.minColumn, static_cast<int16_t>(column));
+		box.maxColumn = std::max(box.maxColumn, static_cast<int16_t>(column));
+		box.minRow = std::min(box.minRow, static_cast<int16_t>(row));
+		box.maxRow = std::max(box.maxRow, static_cast<int16_t>(row));
+	}
+
+	bool IsInside(int cellIdx, int direction, int column, int row) const
+	{
+		const Box& box = GetBox(cellIdx, direction);
+		return column >= box.minColumn && column <= box.maxColumn && row >= box.minRow && row <= box.maxRow;
+	}
+	// Bit d is set when (column, row) is inside the box of direction d of the cell
+	unsigned int GetInsideMask(int cellIdx, int column, int row) const
+	{
+		unsigned int mask{};
+		for (int direction{}; direction < nr_of_directions; ++direction)
+		{
+			if (IsInside(cellIdx, direction, column, row))
+				mask |= 1u << direction;
+		}
+		return mask;
+	}
+
+private:
+	int m_NrOfColumns = 0;
+	int m_NrOfRows = 0;
+	std::vector<Box> m_Boxes; // nr_of_directions per cell, in cell index order
+
+	size_t GetBoxIdx(int cellIdx, int direction) const
+	{
+		assert(cellIdx >= 0 && cellIdx < GetNrOfCells() && direction >= 0 && direction < nr_of_directions && "<GridBoundingBoxTable::GetBox>: invalid cell or direction");
+		return static_cast<size_t>(cellIdx) * nr_of_directions + direction;
+	}
+};
@@ -0,0 +1,390 @@
+#include "stdafx.h"
+#include "HierarchicalPathfinder.h"
+
+using namespace Elite;
+
+HierarchicalPathfinder::HierarchicalPathfinder(NavGraph* pNavGraph, Heuristic hFunction, float clusterSize)
+	: m_pNavGraph{ pNavGraph }
+	, m_Graph{ pNavGraph }
+	, m_Pathfinder{ pNavGraph, hFunction }
+	, m_HeuristicFunction{ hFunction }
+	, m_ClusterSize{ clusterSize }
+{
+	assert(pNavGraph && clusterSize > 0.f && "<HierarchicalPathfinder::HierarchicalPathfinder>: no graph or invalid cluster size");
+	Build();
+}
+
+void HierarchicalPathfinder::Build()
+{
+	using Clock = std::chrono::high_resolution_clock;
+	const auto buildStart = Clock::now();
+
+	ClusterTriangles();
+	ConnectEntrances();
+	m_GraphVersion = m_pNavGraph->GetVersion();
+	m_LastStatistics = {};
+
+	m_BuildTime = std::chrono::duration<float>(Clock::now() - buildStart).count();
+	std::cout << "Hierarchical pathfinding: " << GetNrOfClusters() << " clusters, " << GetNrOfEntrances() << " entrances and "
+		<< m_NrOfAbstractEdges << " abstract edges built in " << m_BuildTime << "s" << std::endl;
+}
+
+bool HierarchicalPathfinder::FindAbstractPath(const Vector2& start, const Vector2& goal, HierarchicalPath& path)
+{
+	if (!IsUpToDate())
+		Build();
+
+	path.Clear();
+	path.graphVersion = m_GraphVersion;
+	m_LastStatistics = {};
+
+	Polygon* pNavMesh = m_pNavGraph->GetNavMeshPolygon();
+	const Triangle* pStartTriangle = pNavMesh->GetTriangleFromPosition(start);
+	const Triangle* pGoalTriangle = pNavMesh->GetTriangleFromPosition(goal);
+	if (!pStartTriangle || !pGoalTriangle)
+		return false;
+
+	path.start = m_pNavGraph->GetSearchEndpoint(start, pStartTriangle);
+	path.goal = m_pNavGraph->GetSearchEndpoint(goal, pGoalTriangle);
+	if (pStartTriangle == pGoalTriangle)
+		return true;
+
+	const int startCluster = m_TriangleClusters[pStartTriangle->metaData.IndexTriangle];
+	const int goalCluster = m_TriangleClusters[pGoalTriangle->metaData.IndexTriangle];
+	if (startCluster == goalCluster)
+	{
+		//Short query, the abstract graph wouldn't save anything
+		const bool isFound = m_Pathfinder.FindPath(path.start, path.goal, path.nodePath);
+		m_LastStatistics = m_Pathfinder.GetLastSearchStatistics();
+		return isFound;
+	}
+
+	//Link the start and goal to the entrances of their cluster, connections cost the same both ways so the goal is flooded from too
+	const int nrOfNodes = m_Graph.GetNrOfNodes();
+	SearchCluster(startCluster, nrOfNodes, invalid_node_index, &path.start, nullptr);
+	CollectEntranceCosts(startCluster, m_StartCosts);
+	SearchCluster(goalCluster, nrOfNodes, invalid_node_index, &path.goal, nullptr);
+	CollectEntranceCosts(goalCluster, m_GoalCosts);
+
+	const int nrOfEntrances = GetNrOfEntrances();
+	const int startIdx = nrOfEntrances;
+	const int goalIdx = nrOfEntrances + 1;
+	auto getPosition = [this, &path, startIdx](int idx) { return idx == startIdx ? path.start.position : m_Graph.GetNodePos(m_Entrances[idx]); };
+
+	//The origin of an abstract node is the cluster of the edge it was reached over
+	auto relax = [this, &path, goalIdx, &getPosition](int fromIdx, int toIdx, float costSoFar, int cluster)
+	{
+		SEARCH_STATISTIC(++m_LastStatistics.nrOfRelaxedEdges);
+		if (m_AbstractContext.IsVisited(toIdx) && m_AbstractContext.GetCostSoFar(toIdx) <= costSoFar)
+			return;
+
+		const float heuristicCost = toIdx == goalIdx ? 0.f : GetHeuristicCost(getPosition(toIdx), path.goal.position);
+		m_AbstractContext.Open(toIdx, costSoFar, costSoFar + heuristicCost, fromIdx, cluster);
+		SEARCH_STATISTIC(m_LastStatistics.peakOpenListSize = std::max(m_LastStatistics.peakOpenListSize, m_AbstractContext.GetOpenListSize()));
+	};
+
+	m_AbstractContext.Reset(nrOfEntrances + 2);
+	m_AbstractContext.Open(startIdx, 0.f, GetHeuristicCost(path.start.position, path.goal.position), invalid_node_index);
+	bool isFound = false;
+	while (!m_AbstractContext.IsOpenListEmpty())
+	{
+		const int currentIdx = m_AbstractContext.CloseBest();
+		SEARCH_STATISTIC(++m_LastStatistics.nrOfExpandedNodes);
+		if (currentIdx == goalIdx)
+		{
+			isFound = true;
+			break;
+		}
+
+		const float currentCostSoFar = m_AbstractContext.GetCostSoFar(currentIdx);
+		if (currentIdx == startIdx)
+		{
+			for (int entrance : m_ClusterEntrances[startCluster])
+			{
+				if (m_StartCosts[entrance] < FLT_MAX)
+					relax(startIdx, entrance, m_StartCosts[entrance], startCluster);
+			}
+			continue;
+		}
+
+		for (const AbstractEdge& edge : m_AbstractEdges[currentIdx])
+			relax(currentIdx, edge.toEntrance, currentCostSoFar + edge.cost, edge.cluster);
+		if (m_GoalCosts[currentIdx] < FLT_MAX)
+			relax(currentIdx, goalIdx, currentCostSoFar + m_GoalCosts[currentIdx], goalCluster);
+	}
+	ResetEntranceCosts(startCluster, m_StartCosts);
+	ResetEntranceCosts(goalCluster, m_GoalCosts);
+	if (!isFound)
+		return false;
+
+	for (int idx = goalIdx; idx != startIdx; idx = m_AbstractContext.GetParent(idx))
+	{
+		path.segmentClusters.push_back(m_AbstractContext.GetOrigin(idx));
+		if (idx != goalIdx)
+			path.entranceNodes.push_back(m_Entrances[idx]);
+	}
+	std::reverse(path.segmentClusters.begin(), path.segmentClusters.end());
+	std::reverse(path.entranceNodes.begin(), path.entranceNodes.end());
+	return true;
+}
+
+bool HierarchicalPathfinder::RefineNextSegment(HierarchicalPath& path)
+{
+	if (path.IsRefined() || path.graphVersion != m_pNavGraph->GetVersion())
+		return false;
+
+	const int segment = path.nrOfRefinedSegments;
+	const int nrOfNodes = m_Graph.GetNrOfNodes();
+	const bool isFirstSegment = segment == 0;
+	const bool isLastSegment = segment == static_cast<int>(path.entranceNodes.size());
+	const int fromIdx = isFirstSegment ? nrOfNodes : path.entranceNodes[segment - 1];
+	const int toIdx = isLastSegment ? nrOfNodes + 1 : path.entranceNodes[segment];
+	if (!SearchCluster(path.segmentClusters[segment], fromIdx, toIdx, isFirstSegment ? &path.start : nullptr, isLastSegment ? &path.goal : nullptr))
+		return false;
+
+	//The entrance the segment starts from ends the previous segment, it's in the node path already
+	m_ReversedPath.clear();
+	for (int idx = toIdx; idx != fromIdx; idx = m_Context.GetParent(idx))
+	{
+		if (idx < nrOfNodes)
+			m_ReversedPath.push_back(idx);
+	}
+	for (auto it = m_ReversedPath.rbegin(); it != m_ReversedPath.rend(); ++it)
+		path.nodePath.push_back(m_Graph.GetNode(*it));
+
+	++path.nrOfRefinedSegments;
+	return true;
+}
+
+void HierarchicalPathfinder::GetSmoothedPath(const HierarchicalPath& path, std::vector<Vector2>& points)
+{
+	points.clear();
+	Polygon* pNavMesh = m_pNavGraph->GetNavMeshPolygon();
+	if (path.IsRefined())
+	{
+		//Start and goal in the same triangle
+		if (path.nodePath.empty())
+		{
+			points.push_back(path.goal.position);
+			return;
+		}
+		SSFA::FindPortals(path.start.position, path.nodePath, path.goal.position, pNavMesh, m_Portals);
+	}
+	else
+	{
+		if (path.nodePath.empty())
+			return;
+
+		//The last refined entrance is the end of the path for now
+		m_PartialNodePath.assign(path.nodePath.begin(), path.nodePath.end() - 1);
+		SSFA::FindPortals(path.start.position, m_PartialNodePath, path.nodePath.back()->GetPosition(), pNavMesh, m_Portals);
+	}
+	SSFA::OptimizePortals(m_Portals, points);
+}
+
+bool HierarchicalPathfinder::FindPath(const Vector2& start, const Vector2& goal, std::vector<Vector2>& points)
+{
+	points.clear();
+	if (!FindAbstractPath(start, goal, m_Path))
+		return false;
+
+	while (RefineNextSegment(m_Path))
+	{
+	}
+	if (!m_Path.IsRefined())
+		return false;
+
+	GetSmoothedPath(m_Path, points);
+	return true;
+}
+
+int HierarchicalPathfinder::GetCell(const Vector2& position) const
+{
+	const int column = static_cast<int>((position.x - m_CellOrigin.x) / m_ClusterSize);
+	const int row = static_cast<int>((position.y - m_CellOrigin.y) / m_ClusterSize);
+	return row * m_NrOfCellColumns + column;
+}
+
+Vector2 HierarchicalPathfinder::GetNodePosition(int idx, const SearchEndpoint* pStart, const SearchEndpoint* pGoal) const
+{
+	const int nrOfNodes = m_Graph.GetNrOfNodes();
+	if (idx == nrOfNodes)
+		return pStart->position;
+	if (idx == nrOfNodes + 1)
+		return pGoal->position;
+	return m_Graph.GetNodePos(idx);
+}
+
+float HierarchicalPathfinder::GetHeuristicCost(const Vector2& startPos, const Vector2& endPos) const
+{
+	const Vector2 toDestination = endPos - startPos;
+	return m_HeuristicFunction(abs(toDestination.x), abs(toDestination.y));
+}
+
+void HierarchicalPathfinder::ClusterTriangles()
+{
+	Polygon* pNavMesh = m_pNavGraph->GetNavMeshPolygon();
+	const std::vector<Triangle*>& vpTriangles = pNavMesh->GetTriangles();
+	m_CellOrigin = Vector2{ pNavMesh->GetPosVertMinXPos(), pNavMesh->GetPosVertMinYPos() };
+	m_NrOfCellColumns = static_cast<int>((pNavMesh->GetPosVertMaxXPos() - m_CellOrigin.x) / m_ClusterSize) + 1;
+
+	//A cluster is a set of triangles connected over portals with their center in the same square,
+	//so a square split by an obstacle becomes a cluster on each side
+	m_TriangleClusters.assign(vpTriangles.size(), invalid_node_index);
+	int nrOfClusters{};
+	std::vector<int> openTriangles;
+	for (int triangleIdx{}; triangleIdx < static_cast<int>(vpTriangles.size()); ++triangleIdx)
+	{
+		if (m_TriangleClusters[triangleIdx] != invalid_node_index)
+			continue;
+
+		const int cell = GetCell(vpTriangles[triangleIdx]->GetCenter());
+		m_TriangleClusters[triangleIdx] = nrOfClusters;
+		openTriangles.push_back(triangleIdx);
+		while (!openTriangles.empty())
+		{
+			const Triangle* pTriangle = vpTriangles[openTriangles.back()];
+			openTriangles.pop_back();
+			for (int lineIdx : pTriangle->metaData.IndexLines)
+			{
+				if (m_pNavGraph->GetNodeIdxFromLineIdx(lineIdx) == invalid_node_index)
+					continue;
+
+				for (const Triangle* pNeighbour : pNavMesh->GetTrianglesFromLineIndex(lineIdx))
+				{
+					const int neighbourIdx = pNeighbour->metaData.IndexTriangle;
+					if (m_TriangleClusters[neighbourIdx] == invalid_node_index && GetCell(pNeighbour->GetCenter()) == cell)
+					{
+						m_TriangleClusters[neighbourIdx] = nrOfClusters;
+						openTriangles.push_back(neighbourIdx);
+					}
+				}
+			}
+		}
+		++nrOfClusters;
+	}
+
+	//Every node belongs to the clusters on both sides of its portal, it's an entrance when those differ
+	const int nrOfNodes = m_Graph.GetNrOfNodes();
+	m_NodeClusters.assign(2 * nrOfNodes, invalid_node_index);
+	m_Entrances.clear();
+	m_ClusterEntrances.clear();
+	m_ClusterEntrances.resize(nrOfClusters);
+	for (int nodeIdx{}; nodeIdx < nrOfNodes; ++nodeIdx)
+	{
+		if (!m_Graph.IsNodeValid(nodeIdx))
+			continue;
+
+		const std::vector<const Triangle*> vpPortalTriangles = pNavMesh->GetTrianglesFromLineIndex(m_Graph.GetNode(nodeIdx)->GetLineIndex());
+		if (vpPortalTriangles.empty())
+			continue;
+
+		const int firstCluster = m_TriangleClusters[vpPortalTriangles.front()->metaData.IndexTriangle];
+		const int secondCluster = m_TriangleClusters[vpPortalTriangles.back()->metaData.IndexTriangle];
+		m_NodeClusters[2 * nodeIdx] = firstCluster;
+		m_NodeClusters[2 * nodeIdx + 1] = secondCluster;
+		if (firstCluster != secondCluster)
+		{
+			const int entrance = static_cast<int>(m_Entrances.size());
+			m_Entrances.push_back(nodeIdx);
+			m_ClusterEntrances[firstCluster].push_back(entrance);
+			m_ClusterEntrances[secondCluster].push_back(entrance);
+		}
+	}
+}
+
+void HierarchicalPathfinder::ConnectEntrances()
+{
+	const int nrOfEntrances = GetNrOfEntrances();
+	m_AbstractEdges.clear();
+	m_AbstractEdges.resize(nrOfEntrances);
+	m_NrOfAbstractEdges = 0;
+	m_StartCosts.assign(nrOfEntrances, FLT_MAX);
+	m_GoalCosts.assign(nrOfEntrances, FLT_MAX);
+
+	//One flood fill of the cluster per entrance, two entrances on the same two clusters are connected through both
+	for (int cluster{}; cluster < GetNrOfClusters(); ++cluster)
+	{
+		const std::vector<int>& entrances = m_ClusterEntrances[cluster];
+		for (int entrance : entrances)
+		{
+			SearchCluster(cluster, m_Entrances[entrance], invalid_node_index, nullptr, nullptr);
+			for (int toEntrance : entrances)
+			{
+				const int toIdx = m_Entrances[toEntrance];
+				if (toEntrance != entrance && m_Context.IsClosed(toIdx))
+				{
+					m_AbstractEdges[entrance].push_back(AbstractEdge{ toEntrance, m_Context.GetCostSoFar(toIdx), cluster });
+					++m_NrOfAbstractEdges;
+				}
+			}
+		}
+	}
+}
+
+bool HierarchicalPathfinder::SearchCluster(int cluster, int startIdx, int goalIdx, const SearchEndpoint* pStart, const SearchEndpoint* pGoal)
+{
+	const int nrOfNodes = m_Graph.GetNrOfNodes();
+	const int startEndpointIdx = nrOfNodes;
+	const int goalEndpointIdx = nrOfNodes + 1;
+	const bool isFloodFill = goalIdx == invalid_node_index;
+	const Vector2 goalPos = isFloodFill ? Vector2{} : GetNodePosition(goalIdx, pStart, pGoal);
+
+	auto relax = [this, isFloodFill, &goalPos, pStart, pGoal](int fromIdx, int toIdx, float costSoFar)
+	{
+		SEARCH_STATISTIC(++m_LastStatistics.nrOfRelaxedEdges);
+		if (m_Context.IsVisited(toIdx) && m_Context.GetCostSoFar(toIdx) <= costSoFar)
+			return;
+
+		const float heuristicCost = isFloodFill ? 0.f : GetHeuristicCost(GetNodePosition(toIdx, pStart, pGoal), goalPos);
+		m_Context.Open(toIdx, costSoFar, costSoFar + heuristicCost, fromIdx);
+		SEARCH_STATISTIC(m_LastStatistics.peakOpenListSize = std::max(m_LastStatistics.peakOpenListSize, m_Context.GetOpenListSize()));
+	};
+
+	m_Context.Reset(nrOfNodes + 2);
+	m_Context.Open(startIdx, 0.f, isFloodFill ? 0.f : GetHeuristicCost(GetNodePosition(startIdx, pStart, pGoal), goalPos), invalid_node_index);
+	while (!m_Context.IsOpenListEmpty())
+	{
+		const int currentIdx = m_Context.CloseBest();
+		SEARCH_STATISTIC(++m_LastStatistics.nrOfExpandedNodes);
+		if (currentIdx == goalIdx)
+			return true;
+
+		const float currentCostSoFar = m_Context.GetCostSoFar(currentIdx);
+		if (currentIdx == startEndpointIdx)
+		{
+			for (int i{}; i < pStart->nrOfLinks; ++i)
+			{
+				const int toIdx = pStart->links[i];
+				if (IsInCluster(toIdx, cluster))
+					relax(currentIdx, toIdx, currentCostSoFar + Distance(pStart->position, m_Graph.GetNodePos(toIdx)));
+			}
+			continue;
+		}
+
+		m_Graph.ForEachConnection(currentIdx, [this, cluster, currentIdx, currentCostSoFar, &relax](int, int toIdx, float cost, GraphConnection2D*)
+			{
+				if (IsInCluster(toIdx, cluster))
+					relax(currentIdx, toIdx, currentCostSoFar + cost);
+			});
+		if (pGoal && pGoal->IsLinkedTo(currentIdx))
+			relax(currentIdx, goalEndpointIdx, currentCostSoFar + Distance(m_Graph.GetNodePos(currentIdx), pGoal->position));
+	}
+	return isFloodFill;
+}
+
+void HierarchicalPathfinder::CollectEntranceCosts(int cluster, std::vector<float>& costs) const
+{
+	//Entrances the flood fill didn't reach keep FLT_MAX
+	for (int entrance : m_ClusterEntrances[cluster])
+	{
+		const int nodeIdx = m_Entrances[entrance];
+		costs[entrance] = m_Context.IsClosed(nodeIdx) ? m_Context.GetCostSoFar(nodeIdx) : FLT_MAX;
+	}
+}
+
+void HierarchicalPathfinder::ResetEntranceCosts(int cluster, std::vector<float>& costs) const
+{
+	for (int entrance : m_ClusterEntrances[cluster])
+		costs[entrance] = FLT_MAX;
+}
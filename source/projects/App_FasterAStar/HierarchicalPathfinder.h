@@ -0,0 +1,117 @@
+#pragma once
+#include <vector>
+#include "framework/EliteAI/EliteGraphs/ENavGraph.h"
+#include "framework/EliteAI/EliteGraphs/ECSRGraph.h"
+#include "framework/EliteAI/EliteGraphs/EliteGraphAlgorithms/EAStar.h"
+#include "framework/EliteAI/EliteGraphs/EliteGraphAlgorithms/ESearchContext.h"
+#include "framework/EliteAI/EliteGraphs/EliteGraphAlgorithms/ESearchEndpoint.h"
+#include "framework/EliteAI/EliteGraphs/EliteGraphAlgorithms/ESearchStatistics.h"
+#include "framework/EliteAI/EliteNavigation/Algorithms/EPathSmoothing.h"
+
+// Path found on the abstract graph, refined into portal nodes one cluster at a time.
+// Segment i runs from entrance i - 1 (or the start) to entrance i (or the goal) through segmentClusters[i].
+struct HierarchicalPath
+{
+	Elite::SearchEndpoint start;
+	Elite::SearchEndpoint goal;
+	std::vector<int> entranceNodes; // portal nodes on the border of two clusters, in path order
+	std::vector<int> segmentClusters; // one more than there are entrances
+	int nrOfRefinedSegments = 0;
+	std::vector<Elite::NavGraphNode*> nodePath; // portal nodes of the refined segments, like AStar::FindPath returns them
+	unsigned int graphVersion = 0; // NavGraph::GetVersion when it was found
+
+	void Clear() { *this = HierarchicalPath{}; }
+	bool IsRefined() const { return nrOfRefinedSegments == static_cast<int>(segmentClusters.size()); }
+};
+
+// HPA* on a NavGraph: the triangles are grouped into clusters (the connected triangles whose center is in the same square of
+// clusterSize), the portals on the border of two clusters become the entrances of an abstract graph and every two entrances
+// of a cluster are connected with the cost of the cheapest path inside the cluster. A query searches the abstract graph first
+// and then only refines the path inside the clusters it runs through, so long queries expand a fraction of the navmesh.
+// Every portal on a border is an entrance and every connection lies inside one triangle, so with an admissible heuristic
+// the paths are as short as the ones of a full A*.
+class HierarchicalPathfinder final
+{
+public:
+	using NodePathfinder = Elite::AStar<Elite::NavGraphNode, Elite::GraphConnection2D>;
+
+	HierarchicalPathfinder(Elite::NavGraph* pNavGraph, Elite::Heuristic hFunction, float clusterSize = 20.f);
+
+	//Clusters the navmesh and precomputes the abstract graph, FindPath calls it again once the NavGraph changed
+	void Build();
+	bool IsUpToDate() const { return m_GraphVersion == m_pNavGraph->GetVersion(); }
+
+	//Only searches the abstract graph, the path still has to be refined with RefineNextSegment.
+	//Start and goal in the same cluster are searched with a regular A* and return a path that's refined already.
+	bool FindAbstractPath(const Elite::Vector2& start, const Elite::Vector2& goal, HierarchicalPath& path);
+	//Refines the first segment that isn't refined yet, returns false when there was none left
+	//or the NavGraph changed since FindAbstractPath (query again when the path isn't refined then)
+	bool RefineNextSegment(HierarchicalPath& path);
+	//Smoothed path through the refined segments: up to the last refined entrance while the path isn't refined completely,
+	//so an agent can start following it while the rest is refined. Empty when nothing is refined yet.
+	void GetSmoothedPath(const HierarchicalPath& path, std::vector<Elite::Vector2>& points);
+
+	//Abstract search, full refinement and string pulling at once, points is empty when there's no path
+	bool FindPath(const Elite::Vector2& start, const Elite::Vector2& goal, std::vector<Elite::Vector2>& points);
+
+	float GetClusterSize() const { return m_ClusterSize; }
+	int GetNrOfClusters() const { return static_cast<int>(m_ClusterEntrances.size()); }
+	int GetNrOfEntrances() const { return static_cast<int>(m_Entrances.size()); }
+	int GetNrOfAbstractEdges() const { return m_NrOfAbstractEdges; }
+	int GetTriangleCluster(int triangleIdx) const { return m_TriangleClusters[triangleIdx]; }
+	float GetBuildTime() const { return m_BuildTime; }
+	//Work of the abstract search plus every refinement since the last FindAbstractPath
+	const Elite::SearchStatistics& GetLastSearchStatistics() const { return m_LastStatistics; }
+
+private:
+	struct AbstractEdge
+	{
+		int toEntrance = 0;
+		float cost = 0.f;
+		int cluster = 0; // the path of the edge stays inside this cluster
+	};
+
+	Elite::NavGraph* m_pNavGraph = nullptr;
+	Elite::GraphView<Elite::NavGraphNode, Elite::GraphConnection2D> m_Graph;
+	NodePathfinder m_Pathfinder; // start and goal in the same cluster
+	Elite::Heuristic m_HeuristicFunction;
+	float m_ClusterSize = 20.f;
+	Elite::Vector2 m_CellOrigin = {}; // bottom left of the navmesh, the squares of clusterSize start there
+	int m_NrOfCellColumns = 1;
+	unsigned int m_GraphVersion = 0;
+	float m_BuildTime = 0.f;
+
+	std::vector<int> m_TriangleClusters; // by triangle index
+	std::vector<int> m_NodeClusters; // two per node, the clusters of the triangles on both sides of its portal (equal inside a cluster)
+	std::vector<int> m_Entrances; // node of every entrance
+	std::vector<std::vector<int>> m_ClusterEntrances; // entrances on the border of every cluster
+	std::vector<std::vector<AbstractEdge>> m_AbstractEdges; // by entrance
+	int m_NrOfAbstractEdges = 0;
+
+	Elite::SearchContext m_Context; // nodes of the NavGraph plus the start and goal of the query
+	Elite::SearchContext m_AbstractContext; // entrances plus the start and goal of the query
+	std::vector<float> m_StartCosts; // by entrance, cost from the start to the entrances of its cluster, FLT_MAX for every other one
+	std::vector<float> m_GoalCosts; // by entrance, cost from the entrances of the goal cluster to the goal, FLT_MAX for every other one
+	std::vector<int> m_ReversedPath;
+	std::vector<Elite::NavGraphNode*> m_PartialNodePath;
+	std::vector<Elite::Portal> m_Portals;
+	HierarchicalPath m_Path; // used by FindPath
+	Elite::SearchStatistics m_LastStatistics = {};
+
+	bool IsInCluster(int nodeIdx, int cluster) const { return m_NodeClusters[2 * nodeIdx] == cluster || m_NodeClusters[2 * nodeIdx + 1] == cluster; }
+	int GetCell(const Elite::Vector2& position) const;
+	Elite::Vector2 GetNodePosition(int idx, const Elite::SearchEndpoint* pStart, const Elite::SearchEndpoint* pGoal) const;
+	float GetHeuristicCost(const Elite::Vector2& startPos, const Elite::Vector2& endPos) const;
+	void ClusterTriangles();
+	void ConnectEntrances();
+	//A* over the nodes of the cluster from startIdx to goalIdx, or a flood fill of the cluster when goalIdx is invalid_node_index.
+	//The start and goal endpoint are the virtual nodes GetNrOfNodes() and GetNrOfNodes() + 1, like AStar does.
+	bool SearchCluster(int cluster, int startIdx, int goalIdx, const Elite::SearchEndpoint* pStart, const Elite::SearchEndpoint* pGoal);
+	//Copies the costs of the last flood fill of the cluster to its entrances
+	void CollectEntranceCosts(int cluster, std::vector<float>& costs) const;
+	void ResetEntranceCosts(int cluster, std::vector<float>& costs) const;
+
+	//C++ make the class non-copyable
+	HierarchicalPathfinder(const HierarchicalPathfinder&) = delete;
+	HierarchicalPathfinder& operator=(const HierarchicalPathfinder&) = delete;
+};
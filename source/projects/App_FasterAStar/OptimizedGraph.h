@@ -6,7 +6,22 @@
 #include <map>
 #include <set>
 #include <algorithm>
-#include "Binary.h"
+#include "BoundingBoxTable.h"
+#include "QuantizedBoundingBoxTable.h"
+#include "GridBoundingBoxTable.h"
+#include "GoalBoundsFile.h"
+#include "framework/EliteAI/EliteGraphs/EliteGraphUtilities/EGraphFingerprint.h"
+#include "framework/EliteAI/EliteGraphs/ECSRGraph.h"
+#include "framework/EliteAI/EliteGraphs/EGraphNodeTypes.h"
+#include "framework/EliteAI/EliteGraphs/EGridGraph.h"
+#include <chrono>
+#include <mutex>
+#include <functional>
+#include <future>
+#include <atomic>
+#include <cfloat>
+#include "framework/EliteAI/EliteGraphs/EliteGraphAlgorithms/ESearchContext.h"
+#include "framework/EliteHelpers/EThreadPool.h"
 
 struct OSquare
 {
@@ -26,52 +41,86 @@ struct NodeInfo
 	NodeInfo() = default;
 	NodeInfo(int start) :sides{ std::vector<std::pair<int, OSquare>>{} }, optimalStart{ start }{}
 
-	void Write(std::ofstream& out) const
-	{
-		Binary::Writers::WritePOD(out, sides.size());
-		for (auto& elem : sides)
-		{
-			Binary::Writers::WritePOD(out, elem.first);
-			Binary::Writers::WritePOD(out, elem.second);
-		}
+	std::vector<std::pair<int, OSquare>> sides{};
+	std::vector<int> optimalStart{};
+};
 
-		Binary::Writers::WritePOD(out, optimalStart.size());
-		for (auto& elem : optimalStart)
-		{
-			Binary::Writers::WritePOD(out, elem);
-		}
-	}
-	void Read(std::ifstream& in)
-	{
-		int size{};
-		Binary::Readers::ReadPOD(in, size);
-		for (int i{}; i < size; ++i)
-		{
-			int first{};
-			OSquare sec{};
-			Binary::Readers::ReadPOD(in, first);
-			Binary::Readers::ReadPOD(in, sec);
-			sides.push_back({ first, sec });
-		}
+// Area in which a goal position is reached over this node: a navmesh node is the portal of the triangles on both sides of its line,
+// a goal anywhere in them can be linked to it (see NavGraph::GetSearchEndpoint)
+inline OSquare GetGoalArea(const Elite::NavGraphNode* pNode, const Elite::Vector2& pos, const Elite::Polygon* navMesh)
+{
+	OSquare area{ pos.x, pos.x, pos.y, pos.y };
+	if (!navMesh)
+		return area;
 
-		Binary::Readers::ReadPOD(in, size);
-		for (int i{}; i < size; ++i)
+	for (const Elite::Triangle* pTriangle : navMesh->GetTrianglesFromLineIndex(pNode->GetLineIndex()))
+	{
+		for (const Elite::Vector2& vertex : { pTriangle->p1, pTriangle->p2, pTriangle->p3 })
 		{
-			int elem{};
-			Binary::Readers::ReadPOD(in, elem);
-			optimalStart.push_back(elem);
+			area.left = std::min(area.left, vertex.x);
+			area.right = std::max(area.right, vertex.x);
+			area.bottom = std::min(area.bottom, vertex.y);
+			area.top = std::max(area.top, vertex.y);
 		}
 	}
+	return area;
+}
 
-	std::vector<std::pair<int, OSquare>> sides{};
-	std::vector<int> optimalStart{};
+// A grid cell is a unit square around its column and row, so a goal in the cell is strictly inside the boxes that hold it
+inline OSquare GetGoalArea(const Elite::GridTerrainNode*, const Elite::Vector2& pos, const Elite::Polygon*)
+{
+	return OSquare{ pos.x - 0.5f, pos.x + 0.5f, pos.y - 0.5f, pos.y + 0.5f };
+}
+
+// Other graphs only have goals on their nodes
+template<class T_NodeType>
+inline OSquare GetGoalArea(const T_NodeType*, const Elite::Vector2& pos, const Elite::Polygon*)
+{
+	return OSquare{ pos.x, pos.x, pos.y, pos.y };
+}
+
+// Wall-clock time (in seconds) spent in every phase of the last ComputeBoundingBoxes call
+struct BakeStatistics
+{
+	int nrOfSources = 0;
+	unsigned int nrOfWorkers = 0;
+	float floodFillTime = 0.f; // EnhancedDijkstra from every node, folded into boxes right away
+	float boundingBoxTime = 0.f; // building the bounding box table
+	float totalTime = 0.f;
+};
+
+// Receives the amount of sources that are done, called from the bake's worker threads but never concurrently
+using BakeProgressCallback = std::function<void(int nrOfSourcesDone, int nrOfSources)>;
+
+struct BakeSettings
+{
+	unsigned int nrOfWorkers = 0; // 0 = one per hardware thread
+	bool storeOptimalStart = false; // fills NodeInfo::optimalStart, costs N ints per node so only for small graphs
+	BakeProgressCallback onProgress = nullptr; // progress is logged when there is no callback
+};
+
+// Which boxes the pruning test reads
+enum class BoundingBoxPrecision
+{
+	Float, // 4 floats per edge, exact
+	Quantized16 // 4 shorts per edge, slightly bigger boxes so a few more edges survive
+};
+
+enum class BoundingBoxLoadResult
+{
+	Loaded,
+	Failed, // missing or damaged file, the current boxes are kept
+	Stale // baked for another version of the graph, the boxes are dropped so A* runs without pruning
 };
 
 template<class T_NodeType, class T_ConnectionType>
 class OptimizedGraph
 {
 public:
-	OptimizedGraph(Elite::IGraph<T_NodeType, T_ConnectionType>* pGraph) :m_pGraph{ pGraph } {}
+	OptimizedGraph(Elite::IGraph<T_NodeType, T_ConnectionType>* pGraph) :m_Graph{ pGraph } {}
+	// Bakes and prunes on a frozen snapshot of the graph, which has to outlive the optimized graph
+	OptimizedGraph(const Elite::CSRGraph<T_NodeType, T_ConnectionType>* pGraph) :m_Graph{ pGraph } {}
+	~OptimizedGraph() { CancelRebake(); }
 
 	// stores the optimal connection to a node and its total costs related to the start and end node of the path
 	struct NodeRecord
@@ -97,147 +146,875 @@ public:
 		};
 	};
 
-	bool ComputeBoundingBoxes(Elite::Polygon* navMesh);
+	// Bakes the boxes of every node on a thread pool, the result doesn't depend on the amount of threads.
+	// Every flood fill is folded into boxes straight away, so memory stays proportional to nodes + edges.
+	// The flood fills run on a CSR snapshot of the graph, taken here unless the optimized graph already wraps one.
+	bool ComputeBoundingBoxes(Elite::Polygon* navMesh, const BakeSettings& settings = {});
+	// Same bake for the grid this optimized graph wraps (live or as a snapshot), using its regularity: every cell has at most
+	// 8 neighbours at fixed index offsets, so the flood fills need no adjacency lists and fold the boxes per direction in a single pass.
+	// The step costs are the ones of the graph's connections, so they include the terrain (see GridGraph::CalculateConnectionCost).
+	// Fills the per direction boxes of GetGridBoundingBoxTable as well as the per edge boxes A* prunes with.
+	// A cell with several optimal first steps from a source is in the grid box of every one of them (JumpPointSearch needs that),
+	// the per edge boxes only get it in the box of the first of those directions, which prunes more.
+	bool ComputeGridBoundingBoxes(const Elite::GridGraph<T_NodeType, T_ConnectionType>& grid, const BakeSettings& settings = {});
 	bool IsWithinBoundingBox(T_NodeType* currentNode, const T_ConnectionType& d, const Elite::Vector2& pos);
+	// O(1) pruning test, edgeIdx = GetFirstEdge(from) + position of the connection in the from node's connection list
+	bool IsWithinBoundingBox(int edgeIdx, const Elite::Vector2& pos) const;
+	// Same test for up to BoundingBoxTable::max_batch_edges consecutive edges at once, bit i belongs to edge firstEdge + i
+	unsigned int GetWithinBoundingBoxMask(int firstEdge, int nrOfEdges, const Elite::Vector2& pos) const;
+	int GetFirstEdge(int nodeIdx) const;
+	// False until boxes of the current precision are baked or loaded for the current graph
+	bool HasBoundingBoxes() const;
 	void EnhancedDijkstra(int src, std::vector<T_ConnectionType*>& optimalConnections);
 
-	Elite::IGraph<T_NodeType, T_ConnectionType>* GetGraph() const { return m_pGraph; }
+	const BakeStatistics& GetBakeStatistics() const { return m_BakeStatistics; }
+
+	// Keeps the boxes valid across an incremental change of a live graph (see NavGraph::AddNavigationCollider).
+	// BeginGraphUpdate snapshots the graph before it changes. EndGraphUpdate marks a source dirty when it changed itself or when
+	// its distance or optimal start edges to one of the unchanged nodes around the change (the ports) differ, every other path is
+	// untouched. Dirty sources never prune until they are rebaked in the background, clean ones only grow to cover added nodes.
+	void BeginGraphUpdate();
+	void EndGraphUpdate(const std::vector<int>& changedNodes, const std::vector<int>& addedNodes, const std::vector<int>& removedNodes,
+		Elite::Polygon* navMesh, const BakeSettings& settings = {});
+	// Same bake on a background thread, the current boxes (none at first, so A* doesn't prune) stay in use until it is done.
+	// The navmesh is read while baking, call BeginGraphUpdate before changing it
+	void ComputeBoundingBoxesAsync(Elite::Polygon* navMesh, const BakeSettings& settings = {});
+	// Swaps in the boxes of a finished background (re)bake, they are complete tables by then and are moved in without copying their arrays (O(1)).
+	// Call it every frame from the thread that runs the queries, which is why the query path needs no locks
+	bool ApplyFinishedRebake();
+	bool IsRebaking() const { return m_Rebake.valid(); }
+	int GetNrOfDirtySources() const { return static_cast<int>(m_DirtySources.size()); }
+	int GetNrOfRebakedSources() const { return m_NrOfRebakedSources; }
+
+	const Elite::GraphView<T_NodeType, T_ConnectionType>& GetGraph() const { return m_Graph; }
 	const std::pair<int, OSquare>& GetConnection(int from, int idx) const;
 
 	const std::vector<NodeInfo>& GetBoundingBoxes() const { return m_BoundingBoxes; };
-	void SetBoundingBoxes(const std::vector<NodeInfo>& vec) { m_BoundingBoxes = vec; };
+	void SetBoundingBoxes(const std::vector<NodeInfo>& vec) { CancelRebake(); m_DirtySources.clear(); m_BoundingBoxes = vec; BuildBoundingBoxTable(); };
+	const BoundingBoxTable& GetBoundingBoxTable() const { return m_BoundingBoxTable; }
+	// Only filled by ComputeGridBoundingBoxes, any other change to the boxes empties it
+	const GridBoundingBoxTable& GetGridBoundingBoxTable() const { return m_GridBoundingBoxTable; }
 
-	void Write(std::ofstream& out) const
-	{
-		Binary::Writers::Write(out, m_BoundingBoxes);
-	}
-	void Read(std::ifstream& in)
-	{
-		Binary::Readers::Read(in, m_BoundingBoxes);
-	}
+	// Quantizes the float boxes on a grid over the bounds of the navmesh, they are requantized on every new bake
+	void QuantizeBoundingBoxes(const Elite::Polygon* navMesh);
+	const QuantizedBoundingBoxTable& GetQuantizedBoundingBoxTable() const { return m_QuantizedBoundingBoxTable; }
+	void SetQuantizedBoundingBoxes(const QuantizedBoundingBoxTable& table) { m_QuantizedBoundingBoxTable = table; }
+	void SetBoundingBoxPrecision(BoundingBoxPrecision precision) { m_Precision = precision; }
+
+	// Goal bounds file (see GoalBoundsFile.h) with the float boxes and, when quantized, the 16-bit boxes.
+	// Loaded boxes are used straight from the mapped file, GetBoundingBoxes stays empty.
+	// The file stores the fingerprint of the graph, boxes of any other graph are rejected on load.
+	// Saving copies loaded boxes out of their file first, so the file they were loaded from can be overwritten.
+	bool SaveBoundingBoxes(const std::string& path, const Elite::Polygon* navMesh);
+	BoundingBoxLoadResult LoadBoundingBoxes(const std::string& path);
+	BoundingBoxPrecision GetBoundingBoxPrecision() const { return m_Precision; }
 
 private:
-	Elite::IGraph<T_NodeType, T_ConnectionType>* m_pGraph = nullptr;
+	Elite::GraphView<T_NodeType, T_ConnectionType> m_Graph;
+	Elite::SearchContext m_SearchContext; // reused by every EnhancedDijkstra run
 
-	//Linked with each node Idx from m_pGraph
+	//Linked with each node Idx from m_Graph
 	//vector<vector<pair<"connection->from", OSquare>>> m_BoundingBoxes;
 	std::vector<NodeInfo> m_BoundingBoxes;
+	//Same boxes, flattened per edge for the pruning test
+	BoundingBoxTable m_BoundingBoxTable;
+	QuantizedBoundingBoxTable m_QuantizedBoundingBoxTable;
+	GridBoundingBoxTable m_GridBoundingBoxTable;
+	BoundingBoxPrecision m_Precision = BoundingBoxPrecision::Float;
+	BakeStatistics m_BakeStatistics;
+
+	//Sources with boxes that never prune, waiting for the background rebake
+	struct RebakeResult
+	{
+		std::vector<NodeInfo> boundingBoxes;
+		BoundingBoxTable boundingBoxTable;
+		QuantizedBoundingBoxTable quantizedBoundingBoxTable;
+	};
+	std::vector<int> m_DirtySources;
+	std::future<RebakeResult> m_Rebake; // empty result when cancelled
+	std::atomic<bool> m_IsRebakeCancelled{ false };
+	std::atomic<int> m_NrOfRebakedSources{ 0 };
+	std::unique_ptr<Elite::CSRGraph<T_NodeType, T_ConnectionType>> m_pGraphBeforeUpdate; // set between Begin- and EndGraphUpdate
+
+	void BuildBoundingBoxTable();
+	void BuildBoundingBoxTable(const Elite::GraphView<T_NodeType, T_ConnectionType>& graph, const std::vector<NodeInfo>& boundingBoxes, BoundingBoxTable& table) const;
+	void ReadBackNodeInfos();
+	void ComputeDistances(const Elite::GraphView<T_NodeType, T_ConnectionType>& graph, int src, std::vector<float>& distances);
+	void StartRebake(Elite::Polygon* navMesh, const BakeSettings& settings);
+	void CancelRebake();
+
+	void EnhancedDijkstra(const Elite::GraphView<T_NodeType, T_ConnectionType>& graph, int src, Elite::SearchContext& context) const;
+	void FoldNodeInfo(const Elite::GraphView<T_NodeType, T_ConnectionType>& graph, int src, const Elite::SearchContext& context,
+		const std::vector<OSquare>& goalAreas, bool storeOptimalStart, NodeInfo& nodeInfo) const;
+	std::vector<OSquare> ComputeGoalAreas(const Elite::GraphView<T_NodeType, T_ConnectionType>& graph, const Elite::Polygon* navMesh) const;
 };
 
 template<class T_NodeType, class T_ConnectionType>
-inline bool OptimizedGraph<T_NodeType, T_ConnectionType>::ComputeBoundingBoxes(Elite::Polygon* navMesh)
+inline bool OptimizedGraph<T_NodeType, T_ConnectionType>::ComputeBoundingBoxes(Elite::Polygon* navMesh, const BakeSettings& settings)
 {
-	//nodes[actualNodeIdx][actualNodeIdx] = Which Side is most optimal
-	std::vector<std::vector<T_ConnectionType*>> optimalSides(
-		m_pGraph->GetNrOfNodes()
-		, std::vector<T_ConnectionType*>(m_pGraph->GetNrOfNodes(), nullptr)
-	);
+	using Clock = std::chrono::high_resolution_clock;
+	const auto bakeStart = Clock::now();
+
+	//The flood fills walk every edge once per source, contiguous edge arrays beat chasing connection lists
+	Elite::CSRGraph<T_NodeType, T_ConnectionType> snapshot{};
+	if (!m_Graph.IsCSR())
+		snapshot.Build(m_Graph.GetGraph());
+	const Elite::GraphView<T_NodeType, T_ConnectionType> graph{ m_Graph.IsCSR() ? m_Graph : Elite::GraphView<T_NodeType, T_ConnectionType>{ &snapshot } };
+
+	const int nrOfNodes = graph.GetNrOfNodes();
+	Elite::ThreadPool threadPool(settings.nrOfWorkers);
 
-	for (int i{}; i < m_pGraph->GetNrOfNodes(); ++i)
+	m_BakeStatistics = {};
+	m_BakeStatistics.nrOfWorkers = threadPool.GetNrOfWorkers();
+	for (int i{}; i < nrOfNodes; ++i)
 	{
-		if (!m_pGraph->IsNodeValid(i))
+		if (graph.IsNodeValid(i))
+			++m_BakeStatistics.nrOfSources;
+	}
+	const int nrOfSources = m_BakeStatistics.nrOfSources;
+
+	//Every worker gets its own search scratch space, the only per node state that outlives a source is its NodeInfo
+	std::vector<Elite::SearchContext> searchContexts(threadPool.GetNrOfWorkers());
+	std::vector<NodeInfo> nodeInfos(nrOfNodes);
+	const std::vector<OSquare> goalAreas{ ComputeGoalAreas(graph, navMesh) };
+
+	std::mutex progressMutex;
+	int nrOfSourcesDone{};
+	const int logInterval = std::max(nrOfSources / 10, 1);
+
+	//Flood fill from every node and fold the goal areas of the reached nodes into its boxes, each source only writes
+	//its own slot so the order in which they finish doesn't matter
+	threadPool.ParallelFor(nrOfNodes, [&](unsigned int workerIdx, int i)
+		{
+			if (!graph.IsNodeValid(i))
+				return;
+
+			EnhancedDijkstra(graph, i, searchContexts[workerIdx]);
+			FoldNodeInfo(graph, i, searchContexts[workerIdx], goalAreas, settings.storeOptimalStart, nodeInfos[i]);
+
+			std::lock_guard<std::mutex> lock(progressMutex);
+			++nrOfSourcesDone;
+			if (settings.onProgress)
+				settings.onProgress(nrOfSourcesDone, nrOfSources);
+			else if (nrOfSourcesDone % logInterval == 0 || nrOfSourcesDone == nrOfSources)
+				std::cout << "Goal bounding bake: " << nrOfSourcesDone << "/" << nrOfSources << " sources" << std::endl;
+		});
+	const auto floodFillEnd = Clock::now();
+
+	//Indexed by node, removed nodes keep an empty slot so incremental updates can find every source back
+	CancelRebake();
+	m_DirtySources.clear();
+	m_BoundingBoxes = std::move(nodeInfos);
+	BuildBoundingBoxTable();
+	const auto bakeEnd = Clock::now();
+
+	////sort all boundingboxes of each node from less to greater
+	//for (auto& boundingBoxes : m_BoundingBoxes)
+	//	std::sort(boundingBoxes.sides.begin(), boundingBoxes.sides.end(), [](const std::pair<int, OSquare>& A, const std::pair<int, OSquare>& B)
+	//		{
+	//			return A.second.GetArea() < B.second.GetArea();
+	//		});
+	//
+
+	m_BakeStatistics.floodFillTime = std::chrono::duration<float>(floodFillEnd - bakeStart).count();
+	m_BakeStatistics.boundingBoxTime = std::chrono::duration<float>(bakeEnd - floodFillEnd).count();
+	m_BakeStatistics.totalTime = std::chrono::duration<float>(bakeEnd - bakeStart).count();
+	std::cout << "Goal bounding bake: " << nrOfSources << " sources on " << m_BakeStatistics.nrOfWorkers << " threads, flood fill "
+		<< m_BakeStatistics.floodFillTime << "s, bounding boxes " << m_BakeStatistics.boundingBoxTime << "s, total "
+		<< m_BakeStatistics.totalTime << "s" << std::endl;
+
+	return true;
+}
+
+template<class T_NodeType, class T_ConnectionType>
+inline bool OptimizedGraph<T_NodeType, T_ConnectionType>::ComputeGridBoundingBoxes(const Elite::GridGraph<T_NodeType, T_ConnectionType>& grid, const BakeSettings& settings)
+{
+	using Clock = std::chrono::high_resolution_clock;
+	const auto bakeStart = Clock::now();
+
+	const int nrOfColumns = grid.GetColumns();
+	const int nrOfCells = nrOfColumns * grid.GetRows();
+	assert(m_Graph.GetNrOfNodes() == nrOfCells && "<OptimizedGraph::ComputeGridBoundingBoxes>: the optimized graph doesn't wrap this grid");
+	const int nrOfDirections = GridBoundingBoxTable::nr_of_directions;
+
+	//Cost of the step in every direction of every cell, FLT_MAX where there is no connection (edge of the grid, water or removed).
+	//The neighbour in a direction is always at the same index offset, that's all the adjacency the flood fills need
+	std::vector<float> stepCosts(static_cast<size_t>(nrOfCells) * nrOfDirections, FLT_MAX);
+	int directionOffsets[nrOfDirections]{};
+	for (int direction{}; direction < nrOfDirections; ++direction)
+		directionOffsets[direction] = GridBoundingBoxTable::GetRowOffset(direction) * nrOfColumns + GridBoundingBoxTable::GetColumnOffset(direction);
+
+	int nrOfSources{};
+	for (int i{}; i < nrOfCells; ++i)
+	{
+		if (!m_Graph.IsNodeValid(i))
 			continue;
 
-		EnhancedDijkstra(i, optimalSides[i]);
+		++nrOfSources;
+		const Elite::Vector2 cell = m_Graph.GetNodePos(i);
+		m_Graph.ForEachConnection(i, [&](int, int toIdx, float cost, T_ConnectionType*)
+			{
+				const Elite::Vector2 neighbour = m_Graph.GetNodePos(toIdx);
+				const int direction = GridBoundingBoxTable::GetDirection(int(neighbour.x) - int(cell.x), int(neighbour.y) - int(cell.y));
+				assert(direction >= 0 && "<OptimizedGraph::ComputeGridBoundingBoxes>: a connection doesn't lead to a neighbouring cell");
+				stepCosts[static_cast<size_t>(i) * nrOfDirections + direction] = cost;
+			});
+	}
 
-		std::vector<T_ConnectionType*> edges = optimalSides[i];
-		sort(edges.begin(), edges.end());
-		edges.erase(unique(edges.begin(), edges.end()), edges.end());
+	Elite::ThreadPool threadPool(settings.nrOfWorkers);
+	m_BakeStatistics = {};
+	m_BakeStatistics.nrOfSources = nrOfSources;
+	m_BakeStatistics.nrOfWorkers = threadPool.GetNrOfWorkers();
 
-		// The final task is to iterate through all nodes in the map and build up the bounding boxes that contain each starting node edge.
-		Vector2 startPos = m_pGraph->GetNodeWorldPos(i);
-		m_BoundingBoxes.push_back(NodeInfo{});
+	std::vector<Elite::SearchContext> searchContexts(threadPool.GetNrOfWorkers());
+	GridBoundingBoxTable gridBoxes{}, firstStepBoxes{};
+	gridBoxes.Resize(nrOfColumns, grid.GetRows());
+	firstStepBoxes.Resize(nrOfColumns, grid.GetRows());
 
-		for (auto& sidePerNode : optimalSides[i])
-			m_BoundingBoxes.back().optimalStart.push_back(sidePerNode->GetTo());
+	std::mutex progressMutex;
+	int nrOfSourcesDone{};
+	const int logInterval = std::max(nrOfSources / 10, 1);
 
-		for (auto it : edges)
+	//Dijkstra from every cell, the origin of a cell is the mask of the directions of every optimal first step from the source towards it.
+	//Paths that tie (up to rounding) with the best known one add their first steps to it. Every source only grows its own boxes
+	threadPool.ParallelFor(nrOfCells, [&](unsigned int workerIdx, int src)
 		{
-			m_BoundingBoxes.back().sides.push_back({});
+			if (!m_Graph.IsNodeValid(src))
+				return;
 
-			float left{ startPos.x };
-			float right{ startPos.x };
-			float bottom{ startPos.y };
-			float top{ startPos.y };
-
-			for (size_t j{}; j < optimalSides[i].size(); ++j)
+			Elite::SearchContext& context = searchContexts[workerIdx];
+			context.Reset(nrOfCells);
+			context.Open(src, 0.f, 0.f, invalid_node_index, invalid_node_index);
+			while (!context.IsOpenListEmpty())
 			{
-				if (it->GetTo() == optimalSides[i][j]->GetTo())
+				const int currentIdx = context.CloseBest();
+				const float currentCostSoFar = context.GetCostSoFar(currentIdx);
+				const float* pStepCosts = &stepCosts[static_cast<size_t>(currentIdx) * nrOfDirections];
+				for (int direction{}; direction < nrOfDirections; ++direction)
 				{
-					Vector2 pos = m_pGraph->GetNodeWorldPos(j);
+					if (pStepCosts[direction] == FLT_MAX)
+						continue;
 
-					left = (pos.x < left) ? pos.x : left;
-					right = (pos.x > right) ? pos.x : right;
-					bottom = (pos.y < bottom) ? pos.y : bottom;
-					top = (pos.y > top) ? pos.y : top;
+					const int toIdx = currentIdx + directionOffsets[direction];
+					const float totalGCost = currentCostSoFar + pStepCosts[direction];
+					const int originMask = (currentIdx == src) ? (1 << direction) : context.GetOrigin(currentIdx);
+					if (!context.IsVisited(toIdx))
+					{
+						context.Open(toIdx, totalGCost, totalGCost, currentIdx, originMask);
+						continue;
+					}
 
-					m_BoundingBoxes.back().sides.back() = { it->GetTo(), OSquare(left, right, bottom, top) };
+					//Costs are positive, so a closed cell is always cheaper than this path
+					const float costSoFar = context.GetCostSoFar(toIdx);
+					const float tieTolerance = 1e-5f * std::max(costSoFar, 1.f);
+					if (totalGCost < costSoFar - tieTolerance)
+						context.Open(toIdx, totalGCost, totalGCost, currentIdx, originMask);
+					else if (totalGCost <= costSoFar + tieTolerance && context.IsOpen(toIdx))
+						context.SetRecord(toIdx, costSoFar, costSoFar, context.GetParent(toIdx), context.GetOrigin(toIdx) | originMask);
 				}
 			}
+
+			//Cells are numbered row by row, so the column and row follow from the index
+			for (int i{}; i < nrOfCells; ++i)
+			{
+				if (i == src || !context.IsClosed(i))
+					continue;
+
+				const unsigned int originMask = context.GetOrigin(i);
+				int firstDirection = -1;
+				for (int direction{}; direction < nrOfDirections; ++direction)
+				{
+					if (!(originMask & (1u << direction)))
+						continue;
+
+					gridBoxes.AddCell(src, direction, i % nrOfColumns, i / nrOfColumns);
+					if (firstDirection < 0)
+						firstDirection = direction;
+				}
+				firstStepBoxes.AddCell(src, firstDirection, i % nrOfColumns, i / nrOfColumns);
+			}
+
+			std::lock_guard<std::mutex> lock(progressMutex);
+			++nrOfSourcesDone;
+			if (settings.onProgress)
+				settings.onProgress(nrOfSourcesDone, nrOfSources);
+			else if (nrOfSourcesDone % logInterval == 0 || nrOfSourcesDone == nrOfSources)
+				std::cout << "Grid goal bounding bake: " << nrOfSourcesDone << "/" << nrOfSources << " sources" << std::endl;
+		});
+	const auto floodFillEnd = Clock::now();
+
+	//The per edge boxes for A*: every connection gets the first step box of its direction, grown by half a cell so the cells on its border
+	//are strictly inside (see GetGoalArea)
+	std::vector<NodeInfo> nodeInfos(nrOfCells);
+	for (int i{}; i < nrOfCells; ++i)
+	{
+		if (!m_Graph.IsNodeValid(i))
+			continue;
+
+		const Elite::Vector2 cell = m_Graph.GetNodePos(i);
+		m_Graph.ForEachConnection(i, [&](int, int toIdx, float, T_ConnectionType*)
+			{
+				const Elite::Vector2 neighbour = m_Graph.GetNodePos(toIdx);
+				const GridBoundingBoxTable::Box& box = firstStepBoxes.GetBox(i, GridBoundingBoxTable::GetDirection(int(neighbour.x) - int(cell.x), int(neighbour.y) - int(cell.y)));
+				if (!box.IsEmpty())
+					nodeInfos[i].sides.push_back({ toIdx, OSquare(box.minColumn - 0.5f, box.maxColumn + 0.5f, box.minRow - 0.5f, box.maxRow + 0.5f) });
+			});
+	}
+
+	CancelRebake();
+	m_DirtySources.clear();
+	m_BoundingBoxes = std::move(nodeInfos);
+	BuildBoundingBoxTable();
+	m_GridBoundingBoxTable = std::move(gridBoxes);
+	const auto bakeEnd = Clock::now();
+
+	m_BakeStatistics.floodFillTime = std::chrono::duration<float>(floodFillEnd - bakeStart).count();
+	m_BakeStatistics.boundingBoxTime = std::chrono::duration<float>(bakeEnd - floodFillEnd).count();
+	m_BakeStatistics.totalTime = std::chrono::duration<float>(bakeEnd - bakeStart).count();
+	std::cout << "Grid goal bounding bake: " << nrOfSources << " cells on " << m_BakeStatistics.nrOfWorkers << " threads, flood fill "
+		<< m_BakeStatistics.floodFillTime << "s, bounding boxes " << m_BakeStatistics.boundingBoxTime << "s, total "
+		<< m_BakeStatistics.totalTime << "s" << std::endl;
+
+	return true;
+}
+
+template<class T_NodeType, class T_ConnectionType>
+inline void OptimizedGraph<T_NodeType, T_ConnectionType>::FoldNodeInfo(const Elite::GraphView<T_NodeType, T_ConnectionType>& graph, int src, const Elite::SearchContext& context,
+	const std::vector<OSquare>& goalAreas, bool storeOptimalStart, NodeInfo& nodeInfo) const
+{
+	nodeInfo = NodeInfo{};
+
+	//The starting node edge of a node is the connection from src to its origin, the start node itself and unreachable nodes have none
+	const int nrOfNodes = graph.GetNrOfNodes();
+	auto getOrigin = [&context, src](int nodeIdx)
+	{
+		return (nodeIdx != src && context.IsClosed(nodeIdx)) ? context.GetOrigin(nodeIdx) : invalid_node_index;
+	};
+
+	if (storeOptimalStart)
+	{
+		nodeInfo.optimalStart.reserve(nrOfNodes);
+		for (int j{}; j < nrOfNodes; ++j)
+			nodeInfo.optimalStart.push_back(getOrigin(j));
+	}
+
+	// The final task is to iterate through all nodes in the map and build up the bounding boxes that contain each starting node edge.
+	// A box contains the goal areas of its nodes, so it also holds for goal positions that aren't nodes.
+	// The boxes follow the order of the start node's connections.
+	const Elite::Vector2 startPos = graph.GetNodePos(src);
+	graph.ForEachConnection(src, [&](int, int originIdx, float, T_ConnectionType*)
+	{
+		float left{ startPos.x };
+		float right{ startPos.x };
+		float bottom{ startPos.y };
+		float top{ startPos.y };
+		bool isOptimalForAnyNode{ false };
+
+		for (int j{}; j < nrOfNodes; ++j)
+		{
+			if (getOrigin(j) == originIdx)
+			{
+				const OSquare& area = goalAreas[j];
+
+				left = (area.left < left) ? area.left : left;
+				right = (area.right > right) ? area.right : right;
+				bottom = (area.bottom < bottom) ? area.bottom : bottom;
+				top = (area.top > top) ? area.top : top;
+
+				isOptimalForAnyNode = true;
+			}
 		}
 
-		for (auto& box : m_BoundingBoxes.back().sides)
+		//Edges that aren't on any optimal path don't get a box, so they're always pruned
+		if (isOptimalForAnyNode)
+			nodeInfo.sides.push_back({ originIdx, OSquare(left, right, bottom, top) });
+	});
+}
+
+template<class T_NodeType, class T_ConnectionType>
+inline std::vector<OSquare> OptimizedGraph<T_NodeType, T_ConnectionType>::ComputeGoalAreas(const Elite::GraphView<T_NodeType, T_ConnectionType>& graph, const Elite::Polygon* navMesh) const
+{
+	std::vector<OSquare> goalAreas(graph.GetNrOfNodes());
+	for (int i{}; i < graph.GetNrOfNodes(); ++i)
+	{
+		if (graph.IsNodeValid(i))
+			goalAreas[i] = GetGoalArea(graph.GetNode(i), graph.GetNodePos(i), navMesh);
+	}
+	return goalAreas;
+}
+
+template<class T_NodeType, class T_ConnectionType>
+inline bool OptimizedGraph<T_NodeType, T_ConnectionType>::IsWithinBoundingBox(T_NodeType* currentNode, const T_ConnectionType& d, const Elite::Vector2& pos)
+{
+	//Find the position of the connection in its node's connection list
+	int edgeNr{ invalid_node_index };
+	m_Graph.ForEachConnection(currentNode->GetIndex(), [&edgeNr, &d](int nr, int toIdx, float, T_ConnectionType*)
 		{
-			Elite::Vector2 leftBottom{ box.second.left, box.second.bottom };
-			Elite::Vector2 rightTop{ box.second.right, box.second.top };
-		
-			auto triangleLeftBottom = navMesh->GetTriangleFromPosition(leftBottom);
-			if (triangleLeftBottom)
+			if (edgeNr == invalid_node_index && toIdx == d.GetTo())
+				edgeNr = nr;
+		});
+
+	return edgeNr != invalid_node_index && IsWithinBoundingBox(GetFirstEdge(currentNode->GetIndex()) + edgeNr, pos);
+}
+
+template<class T_NodeType, class T_ConnectionType>
+inline bool OptimizedGraph<T_NodeType, T_ConnectionType>::IsWithinBoundingBox(int edgeIdx, const Elite::Vector2& pos) const
+{
+	if (m_Precision == BoundingBoxPrecision::Quantized16)
+		return m_QuantizedBoundingBoxTable.IsInside(edgeIdx, pos.x, pos.y);
+	return m_BoundingBoxTable.IsInside(edgeIdx, pos.x, pos.y);
+}
+
+template<class T_NodeType, class T_ConnectionType>
+inline unsigned int OptimizedGraph<T_NodeType, T_ConnectionType>::GetWithinBoundingBoxMask(int firstEdge, int nrOfEdges, const Elite::Vector2& pos) const
+{
+	if (m_Precision == BoundingBoxPrecision::Quantized16)
+		return m_QuantizedBoundingBoxTable.GetInsideMask(firstEdge, nrOfEdges, pos.x, pos.y);
+	return m_BoundingBoxTable.GetInsideMask(firstEdge, nrOfEdges, pos.x, pos.y);
+}
+
+template<class T_NodeType, class T_ConnectionType>
+inline int OptimizedGraph<T_NodeType, T_ConnectionType>::GetFirstEdge(int nodeIdx) const
+{
+	if (m_Precision == BoundingBoxPrecision::Quantized16)
+		return m_QuantizedBoundingBoxTable.GetFirstEdge(nodeIdx);
+	return m_BoundingBoxTable.GetFirstEdge(nodeIdx);
+}
+
+template<class T_NodeType, class T_ConnectionType>
+inline bool OptimizedGraph<T_NodeType, T_ConnectionType>::HasBoundingBoxes() const
+{
+	if (m_Precision == BoundingBoxPrecision::Quantized16)
+		return m_QuantizedBoundingBoxTable.GetNrOfNodes() == m_Graph.GetNrOfNodes();
+	return m_BoundingBoxTable.GetNrOfNodes() == m_Graph.GetNrOfNodes();
+}
+
+template<class T_NodeType, class T_ConnectionType>
+inline void OptimizedGraph<T_NodeType, T_ConnectionType>::QuantizeBoundingBoxes(const Elite::Polygon* navMesh)
+{
+	m_QuantizedBoundingBoxTable.Quantize(m_BoundingBoxTable,
+		{ navMesh->GetPosVertMinXPos(), navMesh->GetPosVertMinYPos() },
+		{ navMesh->GetPosVertMaxXPos(), navMesh->GetPosVertMaxYPos() });
+}
+
+template<class T_NodeType, class T_ConnectionType>
+inline bool OptimizedGraph<T_NodeType, T_ConnectionType>::SaveBoundingBoxes(const std::string& path, const Elite::Polygon* navMesh)
+{
+	//A mapped file can't be replaced (Windows) or truncated (POSIX) while the tables still read from it
+	m_BoundingBoxTable.Detach();
+	m_QuantizedBoundingBoxTable.Detach();
+	return GoalBoundsFile::Save(path, m_BoundingBoxTable, m_QuantizedBoundingBoxTable,
+		GoalBoundsFile::HashNavMesh(*navMesh), Elite::ComputeGraphFingerprint(m_Graph));
+}
+
+template<class T_NodeType, class T_ConnectionType>
+inline BoundingBoxLoadResult OptimizedGraph<T_NodeType, T_ConnectionType>::LoadBoundingBoxes(const std::string& path)
+{
+	BoundingBoxTable boxes{};
+	QuantizedBoundingBoxTable quantizedBoxes{};
+	GoalBoundsFile::Header header{};
+	if (!GoalBoundsFile::Load(path, boxes, quantizedBoxes, &header))
+		return BoundingBoxLoadResult::Failed;
+
+	//A running rebake belongs to the boxes that get replaced
+	CancelRebake();
+	m_DirtySources.clear();
+
+	//Boxes of another graph would prune the wrong edges, better not to prune at all
+	const uint64_t graphHash{ Elite::ComputeGraphFingerprint(m_Graph) };
+	if (header.graphHash != graphHash || header.nrOfNodes != m_Graph.GetNrOfNodes())
+	{
+		std::cout << "Bounding boxes in " << path << " were baked for another graph (fingerprint " << std::hex << header.graphHash
+			<< ", expected " << graphHash << std::dec << "), pruning is disabled until they are rebaked" << std::endl;
+		m_BoundingBoxes.clear();
+		m_BoundingBoxTable.Clear();
+		m_QuantizedBoundingBoxTable.Clear();
+		m_GridBoundingBoxTable.Clear();
+		return BoundingBoxLoadResult::Stale;
+	}
+
+	m_BoundingBoxes.clear();
+	m_BoundingBoxTable = std::move(boxes);
+	m_GridBoundingBoxTable.Clear();
+	m_QuantizedBoundingBoxTable = std::move(quantizedBoxes);
+	return BoundingBoxLoadResult::Loaded;
+}
+
+template<class T_NodeType, class T_ConnectionType>
+inline void OptimizedGraph<T_NodeType, T_ConnectionType>::BuildBoundingBoxTable()
+{
+	BuildBoundingBoxTable(m_Graph, m_BoundingBoxes, m_BoundingBoxTable);
+	m_GridBoundingBoxTable.Clear();
+
+	//Keep the quantized boxes in sync, on the grid they were quantized on before
+	if (!m_QuantizedBoundingBoxTable.IsEmpty())
+		m_QuantizedBoundingBoxTable.Quantize(m_BoundingBoxTable, m_QuantizedBoundingBoxTable.GetBoundsMin(), m_QuantizedBoundingBoxTable.GetBoundsMax());
+}
+
+template<class T_NodeType, class T_ConnectionType>
+inline void OptimizedGraph<T_NodeType, T_ConnectionType>::BuildBoundingBoxTable(const Elite::GraphView<T_NodeType, T_ConnectionType>& graph, const std::vector<NodeInfo>& boundingBoxes, BoundingBoxTable& table) const
+{
+	const int nrOfNodes = graph.GetNrOfNodes();
+	table.Clear();
+	table.Reserve(nrOfNodes, graph.GetNrOfEdges());
+
+	for (int i{}; i < nrOfNodes; ++i)
+	{
+		//Connections without a box aren't on any optimal path, they get a box that never contains the goal
+		graph.ForEachConnection(i, [&](int, int toIdx, float, T_ConnectionType*)
+		{
+			const OSquare* pBox{ nullptr };
+			if (i < static_cast<int>(boundingBoxes.size()))
 			{
-				auto triangleLeftBottomPoints = triangleLeftBottom->GetPointsInVector();
-		
-				leftBottom = *std::min_element(triangleLeftBottomPoints.begin(), triangleLeftBottomPoints.end(),
-					[](const Elite::Vector2& A, const Elite::Vector2& B)
-					{return A.x < B.x&& A.y < B.y; });
+				for (const auto& side : boundingBoxes[i].sides)
+				{
+					if (side.first == toIdx)
+					{
+						pBox = &side.second;
+						break;
+					}
+				}
 			}
+
+			if (pBox)
+				table.AddEdge(pBox->left, pBox->right, pBox->bottom, pBox->top);
 			else
-				leftBottom = { navMesh->GetPosVertMinXPos(), navMesh->GetPosVertMinYPos() };
-		
-			auto triangleRightTop = navMesh->GetTriangleFromPosition(rightTop);
-			if (triangleRightTop)
+				table.AddEmptyEdge();
+		});
+		table.EndNode();
+	}
+}
+
+template<class T_NodeType, class T_ConnectionType>
+inline void OptimizedGraph<T_NodeType, T_ConnectionType>::BeginGraphUpdate()
+{
+	assert(!m_Graph.IsCSR() && "<OptimizedGraph::BeginGraphUpdate>: a CSR snapshot never changes");
+
+	//The running rebake reads the graph and navmesh that are about to change, its sources stay dirty and get rebaked again
+	CancelRebake();
+
+	//Without boxes A* doesn't prune, there is nothing to keep valid
+	m_pGraphBeforeUpdate.reset();
+	if (m_BoundingBoxTable.IsEmpty())
+		return;
+
+	if (m_BoundingBoxes.size() != static_cast<size_t>(m_BoundingBoxTable.GetNrOfNodes()))
+		ReadBackNodeInfos();
+
+	m_pGraphBeforeUpdate.reset(new Elite::CSRGraph<T_NodeType, T_ConnectionType>());
+	m_pGraphBeforeUpdate->Build(m_Graph.GetGraph());
+}
+
+template<class T_NodeType, class T_ConnectionType>
+inline void OptimizedGraph<T_NodeType, T_ConnectionType>::EndGraphUpdate(const std::vector<int>& changedNodes, const std::vector<int>& addedNodes, const std::vector<int>& removedNodes,
+	Elite::Polygon* navMesh, const BakeSettings& settings)
+{
+	if (!m_pGraphBeforeUpdate)
+	{
+		//A first bake that was cancelled by the change starts over
+		if (!m_DirtySources.empty())
+			ComputeBoundingBoxesAsync(navMesh, settings);
+		return;
+	}
+
+	const Elite::GraphView<T_NodeType, T_ConnectionType> oldGraph{ m_pGraphBeforeUpdate.get() };
+	const int nrOfNodes = m_Graph.GetNrOfNodes();
+	m_BoundingBoxes.resize(nrOfNodes);
+
+	//1. Every path that changed runs between two ports: changed nodes that are in both graphs, next to the ones that aren't
+	auto isIn = [](const std::vector<int>& nodes, int idx) { return std::binary_search(nodes.begin(), nodes.end(), idx); };
+	std::vector<int> ports{};
+	for (int idx : changedNodes)
+	{
+		if (oldGraph.IsNodeValid(idx) && m_Graph.IsNodeValid(idx) && !isIn(addedNodes, idx) && !isIn(removedNodes, idx))
+			ports.push_back(idx);
+	}
+
+	//The graph is undirected, so the distances from a port are the distances from every source to it
+	std::vector<std::vector<float>> oldDistances(ports.size());
+	std::vector<std::vector<float>> newDistances(ports.size());
+	for (size_t i{}; i < ports.size(); ++i)
+	{
+		ComputeDistances(oldGraph, ports[i], oldDistances[i]);
+		ComputeDistances(m_Graph, ports[i], newDistances[i]);
+	}
+	auto isSameCost = [](float a, float b) { return abs(a - b) <= 1e-4f * std::max(1.f, std::max(abs(a), abs(b))); };
+
+	//2. A source that didn't change itself keeps its connections. When it reaches every port at the same cost over the
+	//same start edges, every target keeps an optimal start edge that is in its box
+	std::vector<int> dirtySources{ changedNodes };
+	dirtySources.insert(dirtySources.end(), m_DirtySources.begin(), m_DirtySources.end());
+	std::sort(dirtySources.begin(), dirtySources.end());
+	dirtySources.erase(std::unique(dirtySources.begin(), dirtySources.end()), dirtySources.end());
+
+	const size_t nrOfChangedSources{ dirtySources.size() };
+	for (int src{}; src < nrOfNodes; ++src)
+	{
+		if (!m_Graph.IsNodeValid(src) || std::binary_search(dirtySources.begin(), dirtySources.begin() + nrOfChangedSources, src))
+			continue;
+
+		bool isDirty{ false };
+		for (size_t i{}; i < ports.size() && !isDirty; ++i)
+		{
+			const float oldCost{ oldDistances[i][src] };
+			const float newCost{ newDistances[i][src] };
+			if (oldCost == FLT_MAX && newCost == FLT_MAX)
+				continue;
+			if (oldCost == FLT_MAX || newCost == FLT_MAX || !isSameCost(oldCost, newCost))
 			{
-				auto triangleRightTopPoints = triangleRightTop->GetPointsInVector();
-		
-				rightTop = *std::max_element(triangleRightTopPoints.begin(), triangleRightTopPoints.end(),
-					[](const Elite::Vector2& A, const Elite::Vector2& B)
-					{return A.x < B.x&& A.y < B.y; });
+				isDirty = true;
+				break;
 			}
+
+			m_Graph.ForEachConnection(src, [&](int, int toIdx, float cost, T_ConnectionType*)
+			{
+				const bool wasOptimal{ isSameCost(cost + oldDistances[i][toIdx], oldCost) };
+				const bool isOptimal{ isSameCost(cost + newDistances[i][toIdx], newCost) };
+				isDirty = isDirty || wasOptimal != isOptimal;
+			});
+		}
+
+		if (isDirty)
+		{
+			dirtySources.push_back(src);
+			continue;
+		}
+
+		//Grows the box of an optimal start edge toward a port to cover the goal area of idx
+		auto addGoalArea = [&](size_t portNr, int idx)
+		{
+			int startIdx{ invalid_node_index };
+			m_Graph.ForEachConnection(src, [&](int, int toIdx, float cost, T_ConnectionType*)
+			{
+				if (startIdx == invalid_node_index && isSameCost(cost + newDistances[portNr][toIdx], newDistances[portNr][src]))
+					startIdx = toIdx;
+			});
+
+			const OSquare addedBox{ GetGoalArea(m_Graph.GetNode(idx), m_Graph.GetNodePos(idx), navMesh) };
+
+			auto& sides = m_BoundingBoxes[src].sides;
+			auto sideIt = std::find_if(sides.begin(), sides.end(), [startIdx](const std::pair<int, OSquare>& side) { return side.first == startIdx; });
+			if (sideIt == sides.end())
+				sides.push_back({ startIdx, addedBox });
 			else
-				rightTop = { navMesh->GetPosVertMaxXPos(), navMesh->GetPosVertMaxYPos() };
-		
-			box.second = { leftBottom.x, rightTop.x, leftBottom.y, rightTop.y };
+				sideIt->second = OSquare(std::min(sideIt->second.left, addedBox.left), std::max(sideIt->second.right, addedBox.right),
+					std::min(sideIt->second.bottom, addedBox.bottom), std::max(sideIt->second.top, addedBox.top));
+		};
+
+		//A port keeps its line, but one of its triangles was replaced by a triangle of the retriangulated area,
+		//a goal in the new part of its goal area is reached over the port
+		for (size_t i{}; i < ports.size(); ++i)
+		{
+			if (newDistances[i][src] != FLT_MAX)
+				addGoalArea(i, ports[i]);
+		}
+
+		//Added nodes are reached over a port, the box of an optimal start edge to that port grows to cover them
+		for (int idx : addedNodes)
+		{
+			size_t bestPort{ ports.size() };
+			float bestCost{ FLT_MAX };
+			for (size_t i{}; i < ports.size(); ++i)
+			{
+				if (newDistances[i][src] == FLT_MAX || newDistances[i][idx] == FLT_MAX)
+					continue;
+				const float cost{ newDistances[i][src] + newDistances[i][idx] };
+				if (cost < bestCost)
+				{
+					bestCost = cost;
+					bestPort = i;
+				}
+			}
+			if (bestPort != ports.size())
+				addGoalArea(bestPort, idx);
 		}
 	}
+	m_pGraphBeforeUpdate.reset();
+	std::inplace_merge(dirtySources.begin(), dirtySources.begin() + nrOfChangedSources, dirtySources.end());
 
-	////sort all boundingboxes of each node from less to greater
-	//for (auto& boundingBoxes : m_BoundingBoxes)
-	//	std::sort(boundingBoxes.sides.begin(), boundingBoxes.sides.end(), [](const std::pair<int, OSquare>& A, const std::pair<int, OSquare>& B)
-	//		{
-	//			return A.second.GetArea() < B.second.GetArea();
-	//		});
-	//
+	//3. Dirty sources can't prune anything until they are rebaked, removed nodes don't need boxes anymore
+	m_DirtySources.clear();
+	for (int src : dirtySources)
+	{
+		if (src >= nrOfNodes)
+			continue;
+
+		m_BoundingBoxes[src] = NodeInfo{};
+		if (!m_Graph.IsNodeValid(src))
+			continue;
+
+		m_Graph.ForEachConnection(src, [&](int, int toIdx, float, T_ConnectionType*)
+		{
+			m_BoundingBoxes[src].sides.push_back({ toIdx, OSquare(-FLT_MAX, FLT_MAX, -FLT_MAX, FLT_MAX) });
+		});
+		m_DirtySources.push_back(src);
+	}
+	BuildBoundingBoxTable();
+
+	std::cout << "Goal bounding update: " << ports.size() << " ports, " << m_DirtySources.size() << " of " << nrOfNodes << " sources are rebaked" << std::endl;
+	if (!m_DirtySources.empty())
+		StartRebake(navMesh, settings);
+}
+
+template<class T_NodeType, class T_ConnectionType>
+inline void OptimizedGraph<T_NodeType, T_ConnectionType>::ComputeBoundingBoxesAsync(Elite::Polygon* navMesh, const BakeSettings& settings)
+{
+	CancelRebake();
+
+	m_DirtySources.clear();
+	for (int i{}; i < m_Graph.GetNrOfNodes(); ++i)
+	{
+		if (m_Graph.IsNodeValid(i))
+			m_DirtySources.push_back(i);
+	}
+	StartRebake(navMesh, settings);
+}
+
+template<class T_NodeType, class T_ConnectionType>
+inline bool OptimizedGraph<T_NodeType, T_ConnectionType>::ApplyFinishedRebake()
+{
+	if (!m_Rebake.valid() || m_Rebake.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+		return false;
+
+	//Every graph change restarts the rebake, so a finished one always belongs to the current graph
+	RebakeResult result{ m_Rebake.get() };
+	m_BoundingBoxes = std::move(result.boundingBoxes);
+	m_BoundingBoxTable = std::move(result.boundingBoxTable);
+	m_GridBoundingBoxTable.Clear();
+	if (!result.quantizedBoundingBoxTable.IsEmpty())
+		m_QuantizedBoundingBoxTable = std::move(result.quantizedBoundingBoxTable);
+	else if (!m_QuantizedBoundingBoxTable.IsEmpty()) //quantized while the bake was running
+		m_QuantizedBoundingBoxTable.Quantize(m_BoundingBoxTable, m_QuantizedBoundingBoxTable.GetBoundsMin(), m_QuantizedBoundingBoxTable.GetBoundsMax());
+	m_DirtySources.clear();
 	return true;
 }
 
 template<class T_NodeType, class T_ConnectionType>
-inline bool OptimizedGraph<T_NodeType, T_ConnectionType>::IsWithinBoundingBox(T_NodeType* currentNode, const T_ConnectionType& d, const Elite::Vector2& pos)
+inline void OptimizedGraph<T_NodeType, T_ConnectionType>::ReadBackNodeInfos()
+{
+	//Boxes loaded from a goal bounds file only live in the table, in the connection order of the graph they were baked for
+	const int nrOfNodes = m_BoundingBoxTable.GetNrOfNodes();
+	m_BoundingBoxes.assign(nrOfNodes, NodeInfo{});
+	for (int i{}; i < nrOfNodes; ++i)
+	{
+		const int firstEdge = m_BoundingBoxTable.GetFirstEdge(i);
+		m_Graph.ForEachConnection(i, [&](int nr, int toIdx, float, T_ConnectionType*)
+		{
+			OSquare box{};
+			m_BoundingBoxTable.GetBox(firstEdge + nr, box.left, box.right, box.bottom, box.top);
+			if (box.left <= box.right && box.bottom <= box.top)
+				m_BoundingBoxes[i].sides.push_back({ toIdx, box });
+		});
+	}
+}
+
+template<class T_NodeType, class T_ConnectionType>
+inline void OptimizedGraph<T_NodeType, T_ConnectionType>::ComputeDistances(const Elite::GraphView<T_NodeType, T_ConnectionType>& graph, int src, std::vector<float>& distances)
+{
+	EnhancedDijkstra(graph, src, m_SearchContext);
+
+	//Nodes that the other graph doesn't have count as unreachable
+	distances.assign(std::max(graph.GetNrOfNodes(), m_Graph.GetNrOfNodes()), FLT_MAX);
+	for (int i{}; i < graph.GetNrOfNodes(); ++i)
+	{
+		if (m_SearchContext.IsClosed(i))
+			distances[i] = m_SearchContext.GetCostSoFar(i);
+	}
+}
+
+template<class T_NodeType, class T_ConnectionType>
+inline void OptimizedGraph<T_NodeType, T_ConnectionType>::StartRebake(Elite::Polygon* navMesh, const BakeSettings& settings)
+{
+	//The flood fills run on a snapshot, so the live graph can be read while they do
+	std::shared_ptr<Elite::CSRGraph<T_NodeType, T_ConnectionType>> pSnapshot{};
+	if (!m_Graph.IsCSR())
+	{
+		pSnapshot = std::make_shared<Elite::CSRGraph<T_NodeType, T_ConnectionType>>();
+		pSnapshot->Build(m_Graph.GetGraph());
+	}
+	const Elite::CSRGraph<T_NodeType, T_ConnectionType>* pGraph{ m_Graph.IsCSR() ? m_Graph.GetCSRGraph() : pSnapshot.get() };
+
+	//Sources that aren't rebaked keep their boxes, the tables are built in the background as well
+	std::vector<NodeInfo> boundingBoxes{ m_BoundingBoxes };
+	boundingBoxes.resize(pGraph->GetNrOfNodes());
+	const bool isQuantized{ !m_QuantizedBoundingBoxTable.IsEmpty() };
+	const Elite::Vector2 quantizedBoundsMin{ isQuantized ? m_QuantizedBoundingBoxTable.GetBoundsMin() : Elite::Vector2{} };
+	const Elite::Vector2 quantizedBoundsMax{ isQuantized ? m_QuantizedBoundingBoxTable.GetBoundsMax() : Elite::Vector2{} };
+
+	//The navmesh is only read here, the live one can change while the rebake runs
+	std::vector<OSquare> goalAreas{ ComputeGoalAreas(Elite::GraphView<T_NodeType, T_ConnectionType>{ pGraph }, navMesh) };
+
+	m_IsRebakeCancelled = false;
+	m_NrOfRebakedSources = 0;
+	const std::vector<int> sources{ m_DirtySources };
+	const unsigned int nrOfWorkers = settings.nrOfWorkers;
+	const bool storeOptimalStart = settings.storeOptimalStart;
+	m_Rebake = std::async(std::launch::async, [this, pSnapshot, pGraph, sources, nrOfWorkers, storeOptimalStart, isQuantized,
+		quantizedBoundsMin, quantizedBoundsMax, boundingBoxes = std::move(boundingBoxes), goalAreas = std::move(goalAreas)]() mutable
+		{
+			const Elite::GraphView<T_NodeType, T_ConnectionType> graph{ pGraph };
+			Elite::ThreadPool threadPool(nrOfWorkers);
+			std::vector<Elite::SearchContext> searchContexts(threadPool.GetNrOfWorkers());
+
+			threadPool.ParallelFor(static_cast<int>(sources.size()), [&](unsigned int workerIdx, int i)
+				{
+					if (m_IsRebakeCancelled)
+						return;
+
+					const int src{ sources[i] };
+					EnhancedDijkstra(graph, src, searchContexts[workerIdx]);
+					FoldNodeInfo(graph, src, searchContexts[workerIdx], goalAreas, storeOptimalStart, boundingBoxes[src]);
+					++m_NrOfRebakedSources;
+				});
+
+			RebakeResult result{};
+			if (m_IsRebakeCancelled)
+				return result;
+
+			BuildBoundingBoxTable(graph, boundingBoxes, result.boundingBoxTable);
+			if (isQuantized)
+				result.quantizedBoundingBoxTable.Quantize(result.boundingBoxTable, quantizedBoundsMin, quantizedBoundsMax);
+			result.boundingBoxes = std::move(boundingBoxes);
+			return result;
+		});
+}
+
+template<class T_NodeType, class T_ConnectionType>
+inline void OptimizedGraph<T_NodeType, T_ConnectionType>::CancelRebake()
 {
-	//auto node = m_pGraph->GetClosestNodeFromPosition(pos);
-
- 	auto boundingBox = std::find_if(m_BoundingBoxes[currentNode->GetIndex()].sides.begin(), m_BoundingBoxes[currentNode->GetIndex()].sides.end(),
- 		[&d](const std::pair<int, OSquare>& A)
- 		{
- 			return A.first == d.GetTo();
- 		});
- 
- 	if (boundingBox == m_BoundingBoxes[currentNode->GetIndex()].sides.end())
- 		return false;
- 
-	return boundingBox->second.IsInside(pos);
+	if (!m_Rebake.valid())
+		return;
+
+	//The rebake stops after the sources it is working on, the dirty sources keep their boxes that never prune
+	m_IsRebakeCancelled = true;
+	m_Rebake.get();
 }
 
 template<class T_NodeType, class T_ConnectionType>
 inline void OptimizedGraph<T_NodeType, T_ConnectionType>::EnhancedDijkstra(int src, std::vector<T_ConnectionType*>& optimalConnections)
+{
+	EnhancedDijkstra(m_Graph, src, m_SearchContext);
+
+	//Translate the starting node edge of every reached node back to the connection of the start node
+	const int nrOfNodes = m_Graph.GetNrOfNodes();
+	optimalConnections.assign(nrOfNodes, nullptr);
+
+	for (int i{}; i < nrOfNodes; ++i)
+	{
+		if (i == src || !m_SearchContext.IsClosed(i))
+			continue;
+
+		const int originIdx = m_SearchContext.GetOrigin(i);
+		m_Graph.ForEachConnection(src, [&](int, int toIdx, float, T_ConnectionType* pConnection)
+			{
+				if (!optimalConnections[i] && toIdx == originIdx)
+					optimalConnections[i] = pConnection;
+			});
+	}
+}
+
+template<class T_NodeType, class T_ConnectionType>
+inline void OptimizedGraph<T_NodeType, T_ConnectionType>::EnhancedDijkstra(const Elite::GraphView<T_NodeType, T_ConnectionType>& graph, int src, Elite::SearchContext& context) const
 {
 	//Source: http://www.gameaipro.com/GameAIPro3/GameAIPro3_Chapter22_Faster_A_Star_with_Goal_Bounding.pdf
 	/* We will start the Dijkstra search at our single node and give it no destination,
@@ -257,79 +1034,31 @@ inline void OptimizedGraph<T_NodeType, T_ConnectionType>::EnhancedDijkstra(int s
 	*/
 
 
-	T_NodeType* pStartNode = m_pGraph->GetNode(src);
-	T_NodeType* pDestinationNode = pStartNode;
 	//Dijkstra  algorithm
-	std::vector<T_NodeType*> path;
-	std::vector<NodeRecord> openList;
-	std::vector<NodeRecord> closedList;
-	NodeRecord currentRecord;
-
-	//Add the start node to OPEN
-	NodeRecord startRecord{};
-	startRecord.pNode = pStartNode;
-	startRecord.pConnection = nullptr;
-	startRecord.estimatedTotalCost = startRecord.costSoFar;
-	openList.push_back(startRecord);
+	context.Reset(graph.GetNrOfNodes());
+
+	//Add the start node to OPEN, it has no starting node edge itself
+	context.Open(src, 0.f, 0.f, invalid_node_index, invalid_node_index);
 
 	//Loop
-	while (!openList.empty())
+	while (!context.IsOpenListEmpty())
 	{
-		//Set the currentRecord to the best record from the openList (The one with the lowest F-cost)
-		currentRecord = *std::min_element(openList.begin(), openList.end(), [](NodeRecord A, NodeRecord B) {return A < B; });
+		//Close the node with the lowest G-cost
+		const int currentIdx = context.CloseBest();
+		const float currentCostSoFar = context.GetCostSoFar(currentIdx);
 
-		//Check if that connection leads to the end node
-		if (currentRecord.pConnection)
+		//Get all the connections of the current node
+		graph.ForEachConnection(currentIdx, [&](int, int toIdx, float cost, T_ConnectionType*)
 		{
-			if (currentRecord.pConnection->GetTo() == pDestinationNode->GetIndex())
-				break;
-		}
+			const float totalGCost = cost + currentCostSoFar;
 
-		//Else, we get all the connections of the connection's end node (neighbors of the currentNode.pNode)
-		std::list<T_ConnectionType*> connections{ m_pGraph->GetNodeConnections(currentRecord.pNode->GetIndex()) };
-		for (auto& connection : connections)
-		{
-			float totalGCost = connection->GetCost() + currentRecord.costSoFar;
+			if (context.IsVisited(toIdx) && context.GetCostSoFar(toIdx) <= totalGCost)
+				return;
 
-			auto nodeInClosedList{ std::find_if(closedList.begin(), closedList.end(), [&connection](NodeRecord A) {return A.pNode->GetIndex() == connection->GetTo(); }) };
-			auto nodeInOpenList{ std::find_if(openList.begin(), openList.end(), [&connection](NodeRecord A) {return A.pNode->GetIndex() == connection->GetTo(); }) };
-			if (nodeInClosedList != closedList.end())
-			{
-				if (nodeInClosedList->costSoFar < totalGCost)
-					continue;
-				else
-					closedList.erase(std::remove(closedList.begin(), closedList.end(), *nodeInClosedList), closedList.end());
-			}
-			else if (nodeInOpenList != openList.end())
-			{
-				if (nodeInOpenList->costSoFar < totalGCost)
-					continue;
-				else
-					openList.erase(std::remove(openList.begin(), openList.end(), *nodeInOpenList), openList.end());
-			}
-
-//Check if start node
-			if (currentRecord.pNode == pStartNode)
-				currentRecord.pStartConnection = connection;
-
-			NodeRecord newRecord{};
-			newRecord.pConnection = connection;
-			newRecord.pNode = m_pGraph->GetNode(connection->GetTo());
-			newRecord.costSoFar = totalGCost;
-			newRecord.estimatedTotalCost = totalGCost;
-
-//Assign the root connection to the next node
-			newRecord.pStartConnection = currentRecord.pStartConnection;
-
-			openList.push_back(newRecord);
-		}
-		//G Remove NodeRecord from the openList and add it to the closedList.
-		openList.erase(std::remove(openList.begin(), openList.end(), currentRecord), openList.end());
-		closedList.push_back(currentRecord);
-	}
-	for (size_t i{}; i < closedList.size(); ++i)
-	{
-		optimalConnections[i] = closedList[i].pStartConnection;
+			//Assign the root connection to the next node, neighbours of the start node are their own root
+			const int originIdx = (currentIdx == src) ? toIdx : context.GetOrigin(currentIdx);
+			context.Open(toIdx, totalGCost, totalGCost, currentIdx, originIdx);
+		});
 	}
 }
 
@@ -0,0 +1,86 @@
+#include "stdafx.h"
+#include "PathCache.h"
+
+PathCache::PathCache(size_t capacity)
+	: m_Capacity{ capacity }
+{
+	assert(capacity > 0 && "<PathCache::PathCache>: capacity can't be 0");
+	m_EntryLookup.reserve(capacity);
+}
+
+const PathCache::Corridor* PathCache::Find(const Elite::Triangle* pStartTriangle, const Elite::Triangle* pGoalTriangle, unsigned int graphVersion)
+{
+	SetGraphVersion(graphVersion);
+
+	const auto lookupIt = m_EntryLookup.find(GetKey(pStartTriangle, pGoalTriangle));
+	if (lookupIt == m_EntryLookup.end())
+	{
+		++m_Statistics.nrOfMisses;
+		return nullptr;
+	}
+
+	++m_Statistics.nrOfHits;
+	m_Entries.splice(m_Entries.begin(), m_Entries, lookupIt->second);
+	return &m_Entries.front().corridor;
+}
+
+void PathCache::Insert(const Elite::Triangle* pStartTriangle, const Elite::Triangle* pGoalTriangle, unsigned int graphVersion,
+	const std::vector<Elite::NavGraphNode*>& nodePath, bool isPathFound)
+{
+	SetGraphVersion(graphVersion);
+
+	const uint64_t key = GetKey(pStartTriangle, pGoalTriangle);
+	const auto lookupIt = m_EntryLookup.find(key);
+	if (lookupIt != m_EntryLookup.end())
+	{
+		m_Entries.splice(m_Entries.begin(), m_Entries, lookupIt->second);
+	}
+	else
+	{
+		//Reuse the least recently used entry (and its corridor memory) when full
+		if (m_Entries.size() >= m_Capacity)
+		{
+			m_EntryLookup.erase(m_Entries.back().key);
+			m_Entries.splice(m_Entries.begin(), m_Entries, std::prev(m_Entries.end()));
+			++m_Statistics.nrOfEvictions;
+		}
+		else
+		{
+			m_Entries.emplace_front();
+		}
+		m_Entries.front().key = key;
+		m_EntryLookup[key] = m_Entries.begin();
+	}
+
+	Corridor& corridor = m_Entries.front().corridor;
+	corridor.portalNodes.clear();
+	for (auto pNode : nodePath)
+		corridor.portalNodes.push_back(pNode->GetIndex());
+	corridor.isPathFound = isPathFound;
+}
+
+void PathCache::Clear()
+{
+	m_Entries.clear();
+	m_EntryLookup.clear();
+}
+
+uint64_t PathCache::GetKey(const Elite::Triangle* pStartTriangle, const Elite::Triangle* pGoalTriangle)
+{
+	//Both triangle indices fit in one key, two pointers wouldn't
+	return (static_cast<uint64_t>(static_cast<uint32_t>(pStartTriangle->metaData.IndexTriangle)) << 32)
+		| static_cast<uint32_t>(pGoalTriangle->metaData.IndexTriangle);
+}
+
+void PathCache::SetGraphVersion(unsigned int graphVersion)
+{
+	if (graphVersion == m_GraphVersion)
+		return;
+
+	m_GraphVersion = graphVersion;
+	if (!m_Entries.empty())
+	{
+		Clear();
+		++m_Statistics.nrOfInvalidations;
+	}
+}
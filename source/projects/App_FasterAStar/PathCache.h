@@ -0,0 +1,60 @@
+#pragma once
+#include <vector>
+#include <list>
+#include <unordered_map>
+#include <cstdint>
+#include "framework/EliteAI/EliteGraphs/EGraphNodeTypes.h"
+
+struct PathCacheStatistics
+{
+	int nrOfHits = 0;
+	int nrOfMisses = 0;
+	int nrOfEvictions = 0;
+	int nrOfInvalidations = 0; // times the whole cache was dropped because the graph changed
+};
+
+// Least recently used cache of the portal corridors A* found between two navmesh triangles.
+// A hit skips the triangle to triangle search, only the funnel still runs with the exact start and goal.
+// The corridor is the one found for the first pair of positions in these triangles, other positions in the same
+// triangles reuse it even if their own optimal path would take another corridor (one path per region pair).
+// Entries are only valid for the graph version they were found on, see NavGraph::GetVersion.
+class PathCache final
+{
+public:
+	struct Corridor
+	{
+		std::vector<int> portalNodes; // the node path between the start and goal triangle
+		bool isPathFound = false; // unreachable goals are cached as well
+	};
+
+	explicit PathCache(size_t capacity = 256);
+
+	//nullptr on a miss, a hit becomes the most recently used entry. Drops every entry first when graphVersion changed.
+	//The pointer is valid until the next Insert or Clear
+	const Corridor* Find(const Elite::Triangle* pStartTriangle, const Elite::Triangle* pGoalTriangle, unsigned int graphVersion);
+	//Evicts the least recently used entry when the cache is full
+	void Insert(const Elite::Triangle* pStartTriangle, const Elite::Triangle* pGoalTriangle, unsigned int graphVersion,
+		const std::vector<Elite::NavGraphNode*>& nodePath, bool isPathFound);
+	void Clear();
+
+	size_t GetSize() const { return m_Entries.size(); }
+	size_t GetCapacity() const { return m_Capacity; }
+	const PathCacheStatistics& GetStatistics() const { return m_Statistics; }
+	void ResetStatistics() { m_Statistics = {}; }
+
+private:
+	struct Entry
+	{
+		uint64_t key = 0;
+		Corridor corridor = {};
+	};
+
+	static uint64_t GetKey(const Elite::Triangle* pStartTriangle, const Elite::Triangle* pGoalTriangle);
+	void SetGraphVersion(unsigned int graphVersion);
+
+	size_t m_Capacity;
+	unsigned int m_GraphVersion = 0;
+	std::list<Entry> m_Entries; // most recently used first
+	std::unordered_map<uint64_t, std::list<Entry>::iterator> m_EntryLookup;
+	PathCacheStatistics m_Statistics = {};
+};
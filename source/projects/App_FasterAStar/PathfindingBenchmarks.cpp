@@ -0,0 +1,602 @@
+#include "stdafx.h"
+#include "PathfindingBenchmarks.h"
+#include "framework/EliteAI/EliteGraphs/ENavGraph.h"
+#include "framework/EliteAI/EliteGraphs/EliteGraphAlgorithms/EAStar.h"
+#include "framework/EliteAI/EliteGraphs/EliteGraphAlgorithms/EJumpPointSearch.h"
+#include "HierarchicalPathfinder.h"
+
+namespace
+{
+	using Clock = std::chrono::high_resolution_clock;
+	using NodePathfinder = Elite::AStar<Elite::NavGraphNode, Elite::GraphConnection2D>;
+	using TerrainGrid = Elite::GridGraph<Elite::GridTerrainNode, Elite::GraphConnection>;
+
+	//One rectangular obstacle in every cell of a grid over the level, jittered within the cell so they never overlap.
+	//Every obstacle stays margin away from the border of its cell, so obstacles expanded by up to margin don't overlap either
+	std::vector<Elite::Polygon> GenerateObstacles(float width, float height, int nrOfObstacles, float margin, unsigned int seed)
+	{
+		std::vector<Elite::Polygon> obstacles{};
+		obstacles.reserve(nrOfObstacles);
+
+		std::mt19937 generator{ seed };
+		std::uniform_real_distribution<float> distribution{ 0.f, 1.f };
+		const int columns = static_cast<int>(ceil(sqrt(nrOfObstacles * width / height)));
+		const int rows = (nrOfObstacles + columns - 1) / columns;
+		const float cellWidth = width / columns;
+		const float cellHeight = height / rows;
+		const float innerWidth = cellWidth - 2.f * margin;
+		const float innerHeight = cellHeight - 2.f * margin;
+		assert(innerWidth > 0.f && innerHeight > 0.f && "<GenerateObstacles>: too many obstacles for the margin");
+		for (int i{}; i < nrOfObstacles; ++i)
+		{
+			const float halfWidth = innerWidth * (0.1f + 0.2f * distribution(generator));
+			const float halfHeight = innerHeight * (0.1f + 0.2f * distribution(generator));
+			const float x = -width / 2.f + cellWidth * (i % columns + 0.5f) + (distribution(generator) - 0.5f) * (innerWidth / 2.f - halfWidth);
+			const float y = -height / 2.f + cellHeight * (i / columns + 0.5f) + (distribution(generator) - 0.5f) * (innerHeight / 2.f - halfHeight);
+			obstacles.push_back(Elite::Polygon{ std::vector<Elite::Vector2>{ { x - halfWidth, y - halfHeight }, { x + halfWidth, y - halfHeight }, { x + halfWidth, y + halfHeight }, { x - halfWidth, y + halfHeight } } });
+			obstacles.back().OrientateWithChildren(Elite::Winding::CW);
+		}
+		return obstacles;
+	}
+
+	Elite::Polygon GetLevelBox(float width, float height)
+	{
+		std::list<Elite::Vector2> box{ { -width / 2.f, height / 2.f }, { -width / 2.f, -height / 2.f }, { width / 2.f, -height / 2.f }, { width / 2.f, height / 2.f } };
+		return Elite::Polygon{ box };
+	}
+
+	//Fills in the latencies of result, sorts latencies in place
+	void SetLatencies(std::vector<float>& latencies, PathfindingBenchmarks::SearchAlgorithmResult& result)
+	{
+		const int nrOfQueries = static_cast<int>(latencies.size());
+		if (nrOfQueries == 0)
+			return;
+
+		for (float latency : latencies)
+			result.averageLatency += latency / nrOfQueries;
+		std::sort(latencies.begin(), latencies.end());
+		result.p50Latency = latencies[nrOfQueries / 2];
+		result.p99Latency = latencies[std::min(nrOfQueries * 99 / 100, nrOfQueries - 1)];
+	}
+
+	//Runs every query and fills in the counters and latencies of result
+	void RunSearchQueries(NodePathfinder& pathfinder, OptimizedGraph<Elite::NavGraphNode, Elite::GraphConnection2D>* pOptimizedGraph,
+		const std::vector<Elite::SearchEndpoint>& starts, const std::vector<Elite::SearchEndpoint>& goals, PathfindingBenchmarks::SearchAlgorithmResult& result)
+	{
+		const int nrOfQueries = static_cast<int>(starts.size());
+		std::vector<float> latencies{};
+		latencies.reserve(nrOfQueries);
+		std::vector<Elite::NavGraphNode*> path{};
+		long long nrOfExpandedNodes{}, nrOfPrunedEdges{};
+		for (int i{}; i < nrOfQueries; ++i)
+		{
+			const auto queryStart = Clock::now();
+			const bool isPathFound = pathfinder.FindPath(starts[i], goals[i], path, pOptimizedGraph);
+			const auto queryEnd = Clock::now();
+
+			latencies.push_back(std::chrono::duration<float>(queryEnd - queryStart).count());
+			nrOfExpandedNodes += pathfinder.GetLastSearchStatistics().nrOfExpandedNodes;
+			nrOfPrunedEdges += pathfinder.GetLastSearchStatistics().nrOfPrunedEdges;
+			if (isPathFound)
+				++result.nrOfPathsFound;
+		}
+		if (nrOfQueries == 0)
+			return;
+
+		result.averageExpandedNodes = static_cast<float>(nrOfExpandedNodes) / nrOfQueries;
+		result.averagePrunedEdges = static_cast<float>(nrOfPrunedEdges) / nrOfQueries;
+		SetLatencies(latencies, result);
+	}
+
+	//Same for the hierarchical pathfinder, a query is the abstract search and the refinement of every segment
+	void RunHierarchicalSearchQueries(HierarchicalPathfinder& pathfinder, const std::vector<Elite::SearchEndpoint>& starts,
+		const std::vector<Elite::SearchEndpoint>& goals, PathfindingBenchmarks::SearchAlgorithmResult& result)
+	{
+		const int nrOfQueries = static_cast<int>(starts.size());
+		std::vector<float> latencies{};
+		latencies.reserve(nrOfQueries);
+		HierarchicalPath path{};
+		long long nrOfExpandedNodes{};
+		for (int i{}; i < nrOfQueries; ++i)
+		{
+			const auto queryStart = Clock::now();
+			bool isPathFound = pathfinder.FindAbstractPath(starts[i].position, goals[i].position, path);
+			while (pathfinder.RefineNextSegment(path))
+			{
+			}
+			isPathFound = isPathFound && path.IsRefined();
+			const auto queryEnd = Clock::now();
+
+			latencies.push_back(std::chrono::duration<float>(queryEnd - queryStart).count());
+			nrOfExpandedNodes += pathfinder.GetLastSearchStatistics().nrOfExpandedNodes;
+			if (isPathFound)
+				++result.nrOfPathsFound;
+		}
+		if (nrOfQueries == 0)
+			return;
+
+		result.averageExpandedNodes = static_cast<float>(nrOfExpandedNodes) / nrOfQueries;
+		SetLatencies(latencies, result);
+	}
+
+	//Same for a grid pathfinder (AStar or JumpPointSearch), queries are pairs of cell indices
+	template<typename T_Pathfinder>
+	void RunGridSearchQueries(T_Pathfinder& pathfinder, TerrainGrid& grid, OptimizedGraph<Elite::GridTerrainNode, Elite::GraphConnection>* pOptimizedGraph,
+		const std::vector<std::pair<int, int>>& queries, PathfindingBenchmarks::SearchAlgorithmResult& result)
+	{
+		const int nrOfQueries = static_cast<int>(queries.size());
+		std::vector<float> latencies{};
+		latencies.reserve(nrOfQueries);
+		long long nrOfExpandedNodes{}, nrOfPrunedEdges{};
+		for (const std::pair<int, int>& query : queries)
+		{
+			const auto queryStart = Clock::now();
+			const std::vector<Elite::GridTerrainNode*> path = pathfinder.FindPath(grid.GetNode(query.first), grid.GetNode(query.second), pOptimizedGraph);
+			const auto queryEnd = Clock::now();
+
+			latencies.push_back(std::chrono::duration<float>(queryEnd - queryStart).count());
+			nrOfExpandedNodes += pathfinder.GetLastSearchStatistics().nrOfExpandedNodes;
+			nrOfPrunedEdges += pathfinder.GetLastSearchStatistics().nrOfPrunedEdges;
+			if (!path.empty())
+				++result.nrOfPathsFound;
+		}
+		if (nrOfQueries == 0)
+			return;
+
+		result.averageExpandedNodes = static_cast<float>(nrOfExpandedNodes) / nrOfQueries;
+		result.averagePrunedEdges = static_cast<float>(nrOfPrunedEdges) / nrOfQueries;
+		SetLatencies(latencies, result);
+	}
+
+	bool IsJsonPath(const std::string& path)
+	{
+		const std::string jsonExtension{ ".json" };
+		return path.size() >= jsonExtension.size() && path.compare(path.size() - jsonExtension.size(), jsonExtension.size(), jsonExtension) == 0;
+	}
+
+	//Runs every batch of the table against every goal, the checksum keeps the compiler from skipping the work
+	template<typename T_Test>
+	unsigned int RunBoundingBoxTest(const BoundingBoxTable& table, const std::vector<Elite::Vector2>& goals, T_Test test)
+	{
+		unsigned int checksum{};
+		for (const Elite::Vector2& goal : goals)
+		{
+			for (int node{}; node < table.GetNrOfNodes(); ++node)
+			{
+				const int endEdge = table.GetFirstEdge(node + 1);
+				for (int edge = table.GetFirstEdge(node); edge < endEdge; edge += BoundingBoxTable::max_batch_edges)
+				{
+					const int nrOfEdges = std::min(endEdge - edge, int(BoundingBoxTable::max_batch_edges));
+					checksum = checksum * 31 + test(edge, nrOfEdges, goal.x, goal.y);
+				}
+			}
+		}
+		return checksum;
+	}
+}
+
+PathfindingBenchmarks::BoundingBoxTestResult PathfindingBenchmarks::BenchmarkBoundingBoxTest(const BoundingBoxTable& table, const std::vector<Elite::Vector2>& goals, int nrOfRuns)
+{
+	BoundingBoxTestResult result{};
+	result.nrOfRuns = nrOfRuns;
+	for (int node{}; node < table.GetNrOfNodes(); ++node)
+	{
+		const int nrOfEdges = table.GetFirstEdge(node + 1) - table.GetFirstEdge(node);
+		result.nrOfBatches += (nrOfEdges + BoundingBoxTable::max_batch_edges - 1) / BoundingBoxTable::max_batch_edges;
+	}
+	result.nrOfBatches *= static_cast<int>(goals.size());
+
+	const auto scalar = [&table](int firstEdge, int nrOfEdges, float x, float y) { return table.GetInsideMaskScalar(firstEdge, nrOfEdges, x, y); };
+	const auto simd = [&table](int firstEdge, int nrOfEdges, float x, float y) { return table.GetInsideMask(firstEdge, nrOfEdges, x, y); };
+
+	unsigned int scalarChecksum{};
+	const auto scalarStart = Clock::now();
+	for (int run{}; run < nrOfRuns; ++run)
+		scalarChecksum += RunBoundingBoxTest(table, goals, scalar);
+	const auto scalarEnd = Clock::now();
+
+	unsigned int simdChecksum{};
+	for (int run{}; run < nrOfRuns; ++run)
+		simdChecksum += RunBoundingBoxTest(table, goals, simd);
+	const auto simdEnd = Clock::now();
+
+	result.scalarTime = std::chrono::duration<float>(scalarEnd - scalarStart).count();
+	result.simdTime = std::chrono::duration<float>(simdEnd - scalarEnd).count();
+	result.isMatching = scalarChecksum == simdChecksum;
+
+#if defined(BOUNDING_BOX_TABLE_AVX2)
+	const char* instructionSet = "AVX2";
+#elif defined(BOUNDING_BOX_TABLE_SSE2)
+	const char* instructionSet = "SSE2";
+#else
+	const char* instructionSet = "scalar";
+#endif
+	std::cout << "Bounding box test: " << result.nrOfBatches << " batches x " << nrOfRuns << " runs, "
+		<< "scalar " << result.scalarTime << "s, " << instructionSet << " " << result.simdTime << "s"
+		<< (result.isMatching ? "" : ", RESULTS DIFFER") << std::endl;
+
+	return result;
+}
+
+PathfindingBenchmarks::TriangulationResult PathfindingBenchmarks::BenchmarkTriangulation(int nrOfObstacles, unsigned int seed)
+{
+	TriangulationResult result{};
+	result.nrOfObstacles = nrOfObstacles;
+
+	//Level sized box with a field of obstacles
+	const float width{ 120.f }, height{ 60.f };
+	Elite::Polygon earClippingPolygon{ GetLevelBox(width, height) };
+	for (const Elite::Polygon& obstacle : GenerateObstacles(width, height, nrOfObstacles, 0.f, seed))
+		earClippingPolygon.AddChild(obstacle);
+	Elite::Polygon delaunayPolygon{ earClippingPolygon };
+
+	const auto earClippingStart = Clock::now();
+	result.earClippingTriangles = static_cast<int>(earClippingPolygon.Triangulate(Elite::TriangulationEngine::EarClipping).size());
+	const auto earClippingEnd = Clock::now();
+	result.delaunayTriangles = static_cast<int>(delaunayPolygon.Triangulate(Elite::TriangulationEngine::ConstrainedDelaunay).size());
+	const auto delaunayEnd = Clock::now();
+
+	result.earClippingTime = std::chrono::duration<float>(earClippingEnd - earClippingStart).count();
+	result.delaunayTime = std::chrono::duration<float>(delaunayEnd - earClippingEnd).count();
+
+	std::cout << "Triangulation: " << nrOfObstacles << " obstacles, "
+		<< "ear clipping " << result.earClippingTime << "s (" << result.earClippingTriangles << " triangles), "
+		<< "constrained Delaunay " << result.delaunayTime << "s (" << result.delaunayTriangles << " triangles)" << std::endl;
+
+	return result;
+}
+
+PathfindingBenchmarks::TriangleLookupResult PathfindingBenchmarks::BenchmarkTriangleLookup(const Elite::Polygon& polygon, int nrOfQueries, unsigned int seed)
+{
+	TriangleLookupResult result{};
+	result.nrOfQueries = nrOfQueries;
+	result.nrOfTriangles = static_cast<int>(polygon.GetTriangles().size());
+
+	//Same points for both versions, generated up front so only the lookups are timed
+	std::mt19937 generator{ seed };
+	std::uniform_real_distribution<float> xDistribution{ polygon.GetPosVertMinXPos(), polygon.GetPosVertMaxXPos() };
+	std::uniform_real_distribution<float> yDistribution{ polygon.GetPosVertMinYPos(), polygon.GetPosVertMaxYPos() };
+	std::vector<Elite::Vector2> points{};
+	points.reserve(nrOfQueries);
+	for (int i{}; i < nrOfQueries; ++i)
+	{
+		const float x = xDistribution(generator);
+		points.push_back({ x, yDistribution(generator) });
+	}
+
+	std::vector<const Elite::Triangle*> linearTriangles{};
+	linearTriangles.reserve(nrOfQueries);
+	const auto linearStart = Clock::now();
+	for (const Elite::Vector2& point : points)
+		linearTriangles.push_back(polygon.GetTriangleFromPositionLinear(point));
+	const auto linearEnd = Clock::now();
+
+	std::vector<const Elite::Triangle*> gridTriangles{};
+	gridTriangles.reserve(nrOfQueries);
+	for (const Elite::Vector2& point : points)
+		gridTriangles.push_back(polygon.GetTriangleFromPosition(point));
+	const auto gridEnd = Clock::now();
+
+	result.linearTime = std::chrono::duration<float>(linearEnd - linearStart).count();
+	result.gridTime = std::chrono::duration<float>(gridEnd - linearEnd).count();
+	result.isMatching = linearTriangles == gridTriangles;
+
+	std::cout << "Triangle lookup: " << nrOfQueries << " points on " << result.nrOfTriangles << " triangles, "
+		<< "linear " << result.linearTime << "s, grid " << result.gridTime << "s"
+		<< (result.isMatching ? "" : ", RESULTS DIFFER") << std::endl;
+
+	return result;
+}
+
+PathfindingBenchmarks::SearchBenchmarkResult PathfindingBenchmarks::BenchmarkSearch(const SearchBenchmarkSettings& settings)
+{
+	SearchBenchmarkResult result{};
+	result.settings = settings;
+
+	//The obstacles are expanded by the agent radius, so they are generated that far apart
+	const std::vector<Elite::Polygon> obstacles{ GenerateObstacles(settings.width, settings.height, settings.nrOfObstacles, settings.agentRadius, settings.seed) };
+	Elite::NavGraph navGraph{ GetLevelBox(settings.width, settings.height), obstacles, settings.agentRadius, Elite::TriangulationEngine::ConstrainedDelaunay };
+	const Elite::Polygon* pNavMesh = navGraph.GetNavMeshPolygon();
+	result.nrOfTriangles = static_cast<int>(pNavMesh->GetTriangles().size());
+	result.nrOfNodes = navGraph.GetNrOfActiveNodes();
+
+	BakeSettings bakeSettings{};
+	bakeSettings.onProgress = [](int, int) {};
+	OptimizedGraph<Elite::NavGraphNode, Elite::GraphConnection2D> optimizedGraph{ &navGraph };
+	optimizedGraph.ComputeBoundingBoxes(pNavMesh, bakeSettings);
+	result.bakeTime = optimizedGraph.GetBakeStatistics().totalTime;
+
+	//Random positions on the navmesh, the start and goal of a query are never in the same triangle
+	std::mt19937 generator{ settings.seed };
+	std::uniform_real_distribution<float> xDistribution{ -settings.width / 2.f, settings.width / 2.f };
+	std::uniform_real_distribution<float> yDistribution{ -settings.height / 2.f, settings.height / 2.f };
+	const auto getRandomPosition = [&]()
+	{
+		for (;;)
+		{
+			const Elite::Vector2 position{ xDistribution(generator), yDistribution(generator) };
+			if (const Elite::Triangle* pTriangle = pNavMesh->GetTriangleFromPosition(position))
+				return std::make_pair(position, pTriangle);
+		}
+	};
+	std::vector<Elite::SearchEndpoint> starts{}, goals{};
+	starts.reserve(settings.nrOfQueries);
+	goals.reserve(settings.nrOfQueries);
+	while (static_cast<int>(starts.size()) < settings.nrOfQueries)
+	{
+		const auto start = getRandomPosition();
+		const auto goal = getRandomPosition();
+		if (start.second == goal.second)
+			continue;
+		starts.push_back(navGraph.GetSearchEndpoint(start.first, start.second));
+		goals.push_back(navGraph.GetSearchEndpoint(goal.first, goal.second));
+	}
+
+	//Every algorithm gets its own pathfinder, the first queries of one don't warm up the search context of the next
+	NodePathfinder aStar{ &navGraph, Elite::HeuristicFunctions::Euclidean };
+	NodePathfinder goalBoundedAStar{ &navGraph, Elite::HeuristicFunctions::Euclidean };
+	NodePathfinder dijkstra{ &navGraph, Elite::HeuristicFunctions::Zero };
+	HierarchicalPathfinder hierarchicalPathfinder{ &navGraph, Elite::HeuristicFunctions::Euclidean, settings.clusterSize };
+	result.hierarchyBuildTime = hierarchicalPathfinder.GetBuildTime();
+	result.algorithms.resize(4);
+	result.algorithms[0].name = "astar";
+	RunSearchQueries(aStar, nullptr, starts, goals, result.algorithms[0]);
+	result.algorithms[1].name = "astar_goal_bounds";
+	RunSearchQueries(goalBoundedAStar, &optimizedGraph, starts, goals, result.algorithms[1]);
+	result.algorithms[2].name = "dijkstra";
+	RunSearchQueries(dijkstra, nullptr, starts, goals, result.algorithms[2]);
+	result.algorithms[3].name = "hpa";
+	RunHierarchicalSearchQueries(hierarchicalPathfinder, starts, goals, result.algorithms[3]);
+
+	std::cout << "Search: " << settings.width << "x" << settings.height << ", " << settings.nrOfObstacles << " obstacles, "
+		<< result.nrOfNodes << " nodes, bake " << result.bakeTime << "s, hierarchy " << result.hierarchyBuildTime << "s" << std::endl;
+	for (const SearchAlgorithmResult& algorithm : result.algorithms)
+	{
+		std::cout << "  " << algorithm.name << ": " << algorithm.averageExpandedNodes << " nodes expanded, "
+			<< algorithm.averagePrunedEdges << " edges pruned, p50 " << algorithm.p50Latency * 1e6f << "us, p99 " << algorithm.p99Latency * 1e6f << "us" << std::endl;
+	}
+
+	return result;
+}
+
+void PathfindingBenchmarks::WriteSearchBenchmarkCsv(std::ostream& out, const std::vector<SearchBenchmarkResult>& results)
+{
+	out << "width,height,obstacles,triangles,nodes,bake_s,hierarchy_s,algorithm,queries,paths_found,avg_expanded_nodes,avg_pruned_edges,avg_latency_us,p50_latency_us,p99_latency_us\n";
+	for (const SearchBenchmarkResult& result : results)
+	{
+		for (const SearchAlgorithmResult& algorithm : result.algorithms)
+		{
+			out << result.settings.width << ',' << result.settings.height << ',' << result.settings.nrOfObstacles << ','
+				<< result.nrOfTriangles << ',' << result.nrOfNodes << ',' << result.bakeTime << ',' << result.hierarchyBuildTime << ','
+				<< algorithm.name << ',' << result.settings.nrOfQueries << ',' << algorithm.nrOfPathsFound << ','
+				<< algorithm.averageExpandedNodes << ',' << algorithm.averagePrunedEdges << ','
+				<< algorithm.averageLatency * 1e6f << ',' << algorithm.p50Latency * 1e6f << ',' << algorithm.p99Latency * 1e6f << '\n';
+		}
+	}
+}
+
+void PathfindingBenchmarks::WriteSearchBenchmarkJson(std::ostream& out, const std::vector<SearchBenchmarkResult>& results)
+{
+	out << "[\n";
+	for (size_t i{}; i < results.size(); ++i)
+	{
+		const SearchBenchmarkResult& result = results[i];
+		out << "  {\"width\": " << result.settings.width << ", \"height\": " << result.settings.height
+			<< ", \"obstacles\": " << result.settings.nrOfObstacles << ", \"triangles\": " << result.nrOfTriangles
+			<< ", \"nodes\": " << result.nrOfNodes << ", \"bake_s\": " << result.bakeTime << ", \"hierarchy_s\": " << result.hierarchyBuildTime
+			<< ", \"queries\": " << result.settings.nrOfQueries << ", \"algorithms\": [\n";
+		for (size_t j{}; j < result.algorithms.size(); ++j)
+		{
+			const SearchAlgorithmResult& algorithm = result.algorithms[j];
+			out << "    {\"name\": \"" << algorithm.name << "\", \"paths_found\": " << algorithm.nrOfPathsFound
+				<< ", \"avg_expanded_nodes\": " << algorithm.averageExpandedNodes << ", \"avg_pruned_edges\": " << algorithm.averagePrunedEdges
+				<< ", \"avg_latency_us\": " << algorithm.averageLatency * 1e6f << ", \"p50_latency_us\": " << algorithm.p50Latency * 1e6f
+				<< ", \"p99_latency_us\": " << algorithm.p99Latency * 1e6f << "}" << (j + 1 < result.algorithms.size() ? "," : "") << "\n";
+		}
+		out << "  ]}" << (i + 1 < results.size() ? "," : "") << "\n";
+	}
+	out << "]\n";
+}
+
+int PathfindingBenchmarks::RunSearchBenchmarks(const std::string& outputPath, int nrOfQueries)
+{
+#ifndef USE_SEARCH_STATISTICS
+	std::cout << "Search benchmark: WARNING USE_SEARCH_STATISTICS isn't defined, every expanded, relaxed and pruned count will be 0. "
+		"Build with /DUSE_SEARCH_STATISTICS to measure them" << std::endl;
+#endif
+
+	//Growing maps at a low and a high obstacle density
+	const SearchBenchmarkSettings maps[]
+	{
+		{ 120.f, 60.f, 10, nrOfQueries },
+		{ 120.f, 60.f, 100, nrOfQueries },
+		{ 240.f, 120.f, 40, nrOfQueries },
+		{ 240.f, 120.f, 400, nrOfQueries },
+		{ 480.f, 240.f, 1600, nrOfQueries }
+	};
+
+	std::vector<SearchBenchmarkResult> results{};
+	for (const SearchBenchmarkSettings& settings : maps)
+		results.push_back(BenchmarkSearch(settings));
+
+	std::ofstream out{ outputPath };
+	if (!out)
+	{
+		std::cout << "Search benchmark: can't write " << outputPath << std::endl;
+		return 1;
+	}
+	if (IsJsonPath(outputPath))
+		WriteSearchBenchmarkJson(out, results);
+	else
+		WriteSearchBenchmarkCsv(out, results);
+
+	std::cout << "Search benchmark: results written to " << outputPath << std::endl;
+	return 0;
+}
+
+PathfindingBenchmarks::GridSearchBenchmarkResult PathfindingBenchmarks::BenchmarkGridSearch(const GridSearchBenchmarkSettings& settings)
+{
+	GridSearchBenchmarkResult result{};
+	result.settings = settings;
+
+	//Blocked cells are water, like the graph editor paints them: they lose every connection
+	TerrainGrid grid{ settings.columns, settings.rows, 1, false, true };
+	const int nrOfCells = settings.columns * settings.rows;
+	std::mt19937 generator{ settings.seed };
+	std::uniform_real_distribution<float> distribution{ 0.f, 1.f };
+	for (int i{}; i < nrOfCells; ++i)
+	{
+		const float terrain = distribution(generator);
+		if (terrain < settings.blockedRatio)
+		{
+			grid.GetNode(i)->SetTerrainType(TerrainType::Water);
+			grid.RemoveConnectionsToAdjacentNodes(i);
+		}
+		else if (terrain < settings.blockedRatio + settings.mudRatio)
+		{
+			grid.GetNode(i)->SetTerrainType(TerrainType::Mud);
+			grid.AddConnectionsToAdjacentCells(i);
+		}
+	}
+
+	std::vector<int> passableCells{};
+	for (int i{}; i < nrOfCells; ++i)
+	{
+		if (!grid.GetNodeConnections(i).empty())
+			passableCells.push_back(i);
+	}
+	result.nrOfPassableCells = static_cast<int>(passableCells.size());
+
+	BakeSettings bakeSettings{};
+	bakeSettings.onProgress = [](int, int) {};
+	OptimizedGraph<Elite::GridTerrainNode, Elite::GraphConnection> optimizedGraph{ &grid };
+	optimizedGraph.ComputeGridBoundingBoxes(grid, bakeSettings);
+	result.bakeTime = optimizedGraph.GetBakeStatistics().totalTime;
+
+	Elite::JumpPointSearch<Elite::GridTerrainNode, Elite::GraphConnection> jumpPointSearch{ &grid, Elite::HeuristicFunctions::Chebyshev };
+	Elite::JumpPointSearch<Elite::GridTerrainNode, Elite::GraphConnection> jumpPointSearchPlus{ &grid, Elite::HeuristicFunctions::Chebyshev };
+	Elite::JumpPointSearch<Elite::GridTerrainNode, Elite::GraphConnection> goalBoundedJumpPointSearchPlus{ &grid, Elite::HeuristicFunctions::Chebyshev };
+	jumpPointSearch.Build();
+	const auto jumpDistancesStart = Clock::now();
+	jumpPointSearchPlus.Build(true);
+	const auto jumpDistancesEnd = Clock::now();
+	goalBoundedJumpPointSearchPlus.Build(true);
+	result.jumpDistancesTime = std::chrono::duration<float>(jumpDistancesEnd - jumpDistancesStart).count();
+	result.isUniformCost = jumpPointSearch.IsUniformCost();
+
+	//Random pairs of different passable cells, the same ones for every algorithm
+	std::vector<std::pair<int, int>> queries{};
+	if (passableCells.size() >= 2)
+	{
+		std::uniform_int_distribution<size_t> cellDistribution{ 0, passableCells.size() - 1 };
+		while (static_cast<int>(queries.size()) < settings.nrOfQueries)
+		{
+			const int start = passableCells[cellDistribution(generator)];
+			const int goal = passableCells[cellDistribution(generator)];
+			if (start != goal)
+				queries.push_back({ start, goal });
+		}
+	}
+
+	//Every algorithm gets its own pathfinder, the first queries of one don't warm up the search context of the next
+	Elite::AStar<Elite::GridTerrainNode, Elite::GraphConnection> aStar{ &grid, Elite::HeuristicFunctions::Chebyshev };
+	Elite::AStar<Elite::GridTerrainNode, Elite::GraphConnection> goalBoundedAStar{ &grid, Elite::HeuristicFunctions::Chebyshev };
+	result.algorithms.resize(5);
+	result.algorithms[0].name = "astar";
+	RunGridSearchQueries(aStar, grid, nullptr, queries, result.algorithms[0]);
+	result.algorithms[1].name = "astar_goal_bounds";
+	RunGridSearchQueries(goalBoundedAStar, grid, &optimizedGraph, queries, result.algorithms[1]);
+	result.algorithms[2].name = "jps";
+	RunGridSearchQueries(jumpPointSearch, grid, nullptr, queries, result.algorithms[2]);
+	result.algorithms[3].name = "jps_plus";
+	RunGridSearchQueries(jumpPointSearchPlus, grid, nullptr, queries, result.algorithms[3]);
+	result.algorithms[4].name = "jps_plus_goal_bounds";
+	RunGridSearchQueries(goalBoundedJumpPointSearchPlus, grid, &optimizedGraph, queries, result.algorithms[4]);
+
+	std::cout << "Grid search: " << settings.columns << "x" << settings.rows << ", " << settings.blockedRatio * 100.f << "% blocked, "
+		<< settings.mudRatio * 100.f << "% mud, " << result.nrOfPassableCells << " passable cells, bake " << result.bakeTime << "s, jump distances "
+		<< result.jumpDistancesTime << "s" << (result.isUniformCost ? "" : ", not uniform: JPS runs A*") << std::endl;
+	for (const SearchAlgorithmResult& algorithm : result.algorithms)
+	{
+		std::cout << "  " << algorithm.name << ": " << algorithm.averageExpandedNodes << " nodes expanded, "
+			<< algorithm.averagePrunedEdges << " edges pruned, p50 " << algorithm.p50Latency * 1e6f << "us, p99 " << algorithm.p99Latency * 1e6f << "us" << std::endl;
+	}
+
+	return result;
+}
+
+void PathfindingBenchmarks::WriteGridSearchBenchmarkCsv(std::ostream& out, const std::vector<GridSearchBenchmarkResult>& results)
+{
+	out << "columns,rows,blocked_ratio,mud_ratio,passable_cells,uniform_cost,bake_s,jump_distances_s,algorithm,queries,paths_found,avg_expanded_nodes,avg_pruned_edges,avg_latency_us,p50_latency_us,p99_latency_us\n";
+	for (const GridSearchBenchmarkResult& result : results)
+	{
+		for (const SearchAlgorithmResult& algorithm : result.algorithms)
+		{
+			out << result.settings.columns << ',' << result.settings.rows << ',' << result.settings.blockedRatio << ',' << result.settings.mudRatio << ','
+				<< result.nrOfPassableCells << ',' << (result.isUniformCost ? 1 : 0) << ',' << result.bakeTime << ',' << result.jumpDistancesTime << ','
+				<< algorithm.name << ',' << result.settings.nrOfQueries << ',' << algorithm.nrOfPathsFound << ','
+				<< algorithm.averageExpandedNodes << ',' << algorithm.averagePrunedEdges << ','
+				<< algorithm.averageLatency * 1e6f << ',' << algorithm.p50Latency * 1e6f << ',' << algorithm.p99Latency * 1e6f << '\n';
+		}
+	}
+}
+
+void PathfindingBenchmarks::WriteGridSearchBenchmarkJson(std::ostream& out, const std::vector<GridSearchBenchmarkResult>& results)
+{
+	out << "[\n";
+	for (size_t i{}; i < results.size(); ++i)
+	{
+		const GridSearchBenchmarkResult& result = results[i];
+		out << "  {\"columns\": " << result.settings.columns << ", \"rows\": " << result.settings.rows
+			<< ", \"blocked_ratio\": " << result.settings.blockedRatio << ", \"mud_ratio\": " << result.settings.mudRatio
+			<< ", \"passable_cells\": " << result.nrOfPassableCells << ", \"uniform_cost\": " << (result.isUniformCost ? "true" : "false")
+			<< ", \"bake_s\": " << result.bakeTime << ", \"jump_distances_s\": " << result.jumpDistancesTime
+			<< ", \"queries\": " << result.settings.nrOfQueries << ", \"algorithms\": [\n";
+		for (size_t j{}; j < result.algorithms.size(); ++j)
+		{
+			const SearchAlgorithmResult& algorithm = result.algorithms[j];
+			out << "    {\"name\": \"" << algorithm.name << "\", \"paths_found\": " << algorithm.nrOfPathsFound
+				<< ", \"avg_expanded_nodes\": " << algorithm.averageExpandedNodes << ", \"avg_pruned_edges\": " << algorithm.averagePrunedEdges
+				<< ", \"avg_latency_us\": " << algorithm.averageLatency * 1e6f << ", \"p50_latency_us\": " << algorithm.p50Latency * 1e6f
+				<< ", \"p99_latency_us\": " << algorithm.p99Latency * 1e6f << "}" << (j + 1 < result.algorithms.size() ? "," : "") << "\n";
+		}
+		out << "  ]}" << (i + 1 < results.size() ? "," : "") << "\n";
+	}
+	out << "]\n";
+}
+
+int PathfindingBenchmarks::RunGridSearchBenchmarks(const std::string& outputPath, int nrOfQueries)
+{
+#ifndef USE_SEARCH_STATISTICS
+	std::cout << "Grid search benchmark: WARNING USE_SEARCH_STATISTICS isn't defined, every expanded, relaxed and pruned count will be 0. "
+		"Build with /DUSE_SEARCH_STATISTICS to measure them" << std::endl;
+#endif
+
+	//Growing grids at a low and a high density of blocked cells, the last one has mud so JPS falls back to A*
+	const GridSearchBenchmarkSettings grids[]
+	{
+		{ 64, 64, 0.1f, 0.f, nrOfQueries },
+		{ 64, 64, 0.3f, 0.f, nrOfQueries },
+		{ 128, 128, 0.1f, 0.f, nrOfQueries },
+		{ 128, 128, 0.3f, 0.f, nrOfQueries },
+		{ 128, 128, 0.1f, 0.1f, nrOfQueries }
+	};
+
+	std::vector<GridSearchBenchmarkResult> results{};
+	for (const GridSearchBenchmarkSettings& settings : grids)
+		results.push_back(BenchmarkGridSearch(settings));
+
+	std::ofstream out{ outputPath };
+	if (!out)
+	{
+		std::cout << "Grid search benchmark: can't write " << outputPath << std::endl;
+		return 1;
+	}
+	if (IsJsonPath(outputPath))
+		WriteGridSearchBenchmarkJson(out, results);
+	else
+		WriteGridSearchBenchmarkCsv(out, results);
+
+	std::cout << "Grid search benchmark: results written to " << outputPath << std::endl;
+	return 0;
+}
@@ -0,0 +1,120 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <ostream>
+#include "BoundingBoxTable.h"
+
+// Micro benchmarks of the pathfinding building blocks, results are printed to std::cout
+namespace PathfindingBenchmarks
+{
+	struct BoundingBoxTestResult
+	{
+		int nrOfBatches = 0; // GetInsideMask calls per run
+		int nrOfRuns = 0;
+		float scalarTime = 0.f; // seconds for all runs
+		float simdTime = 0.f;
+		bool isMatching = true; // both versions returned the same masks
+	};
+
+	// Tests every goal against the edges of every node, once one box at a time and once with the SIMD kernel
+	BoundingBoxTestResult BenchmarkBoundingBoxTest(const BoundingBoxTable& table, const std::vector<Elite::Vector2>& goals, int nrOfRuns = 10);
+
+	struct TriangleLookupResult
+	{
+		int nrOfQueries = 0;
+		int nrOfTriangles = 0;
+		float linearTime = 0.f; // seconds for all queries
+		float gridTime = 0.f;
+		bool isMatching = true; // both versions found the same triangles
+	};
+
+	// Looks up random points within the bounds of a triangulated polygon, once testing every triangle and once through its triangle grid
+	TriangleLookupResult BenchmarkTriangleLookup(const Elite::Polygon& polygon, int nrOfQueries = 10000, unsigned int seed = 0);
+
+	struct TriangulationResult
+	{
+		int nrOfObstacles = 0;
+		int earClippingTriangles = 0;
+		int delaunayTriangles = 0;
+		float earClippingTime = 0.f; // seconds
+		float delaunayTime = 0.f;
+	};
+
+	// Triangulates a generated field of non overlapping rectangular obstacles, once with every TriangulationEngine
+	TriangulationResult BenchmarkTriangulation(int nrOfObstacles, unsigned int seed = 0);
+
+	struct SearchBenchmarkSettings
+	{
+		float width = 120.f;
+		float height = 60.f;
+		int nrOfObstacles = 100;
+		int nrOfQueries = 1000;
+		float agentRadius = 1.f;
+		unsigned int seed = 0;
+		float clusterSize = 20.f; // of the hierarchical pathfinder
+	};
+
+	struct SearchAlgorithmResult
+	{
+		std::string name;
+		int nrOfPathsFound = 0;
+		float averageExpandedNodes = 0.f;
+		float averagePrunedEdges = 0.f;
+		float averageLatency = 0.f; // seconds per query
+		float p50Latency = 0.f;
+		float p99Latency = 0.f;
+	};
+
+	struct SearchBenchmarkResult
+	{
+		SearchBenchmarkSettings settings = {};
+		int nrOfTriangles = 0;
+		int nrOfNodes = 0;
+		float bakeTime = 0.f; // seconds for the goal bounds of the whole map
+		float hierarchyBuildTime = 0.f; // seconds for the clusters and abstract graph of the hierarchical pathfinder
+		std::vector<SearchAlgorithmResult> algorithms; // A*, goal bounded A*, Dijkstra and hierarchical A*, on the same queries
+	};
+
+	// Generates a navmesh with a field of obstacles, bakes its goal bounds and runs the same random queries
+	// through A*, A* pruned by the goal bounds, Dijkstra (A* without heuristic) and the HierarchicalPathfinder
+	SearchBenchmarkResult BenchmarkSearch(const SearchBenchmarkSettings& settings);
+
+	// One row per map and algorithm
+	void WriteSearchBenchmarkCsv(std::ostream& out, const std::vector<SearchBenchmarkResult>& results);
+	void WriteSearchBenchmarkJson(std::ostream& out, const std::vector<SearchBenchmarkResult>& results);
+
+	// Headless entry point (GPP_Framework.exe --benchmark <file> [nrOfQueries]): benchmarks a few map sizes and obstacle
+	// densities and writes the results to outputPath, as JSON when it ends in .json and as CSV otherwise. Returns the exit code
+	int RunSearchBenchmarks(const std::string& outputPath, int nrOfQueries = 1000);
+
+	struct GridSearchBenchmarkSettings
+	{
+		int columns = 128;
+		int rows = 128;
+		float blockedRatio = 0.2f; // chance of a cell being water, which has no connections
+		float mudRatio = 0.f; // chance of a cell being mud, any mud makes the costs non uniform
+		int nrOfQueries = 1000;
+		unsigned int seed = 0;
+	};
+
+	struct GridSearchBenchmarkResult
+	{
+		GridSearchBenchmarkSettings settings = {};
+		int nrOfPassableCells = 0;
+		bool isUniformCost = false; // false when JumpPointSearch falls back to A*
+		float bakeTime = 0.f; // seconds for the grid goal bounds
+		float jumpDistancesTime = 0.f; // seconds for the JPS+ jump distances
+		std::vector<SearchAlgorithmResult> algorithms; // A*, goal bounded A*, JPS, JPS+ and goal bounded JPS+, on the same queries
+	};
+
+	// Generates a GridGraph with randomly blocked cells, bakes its grid goal bounds and runs the same random queries
+	// through A*, goal bounded A*, Jump Point Search, JPS+ and JPS+ pruned by the goal bounds
+	GridSearchBenchmarkResult BenchmarkGridSearch(const GridSearchBenchmarkSettings& settings);
+
+	// One row per grid and algorithm
+	void WriteGridSearchBenchmarkCsv(std::ostream& out, const std::vector<GridSearchBenchmarkResult>& results);
+	void WriteGridSearchBenchmarkJson(std::ostream& out, const std::vector<GridSearchBenchmarkResult>& results);
+
+	// Headless entry point (GPP_Framework.exe --grid-benchmark <file> [nrOfQueries]), same output formats as RunSearchBenchmarks
+	int RunGridSearchBenchmarks(const std::string& outputPath, int nrOfQueries = 1000);
+}
@@ -0,0 +1,312 @@
+#pragma once
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <cassert>
+#include "BoundingBoxTable.h"
+
+// BoundingBoxTable with every side stored as a 16-bit coordinate on a grid spanning the navmesh bounds,
+// half the size of the float table. Sides are snapped outward (plus one cell for rounding), so a quantized box
+// always contains its float box and pruning with it never throws away an optimal edge.
+// Positions outside the bounds are never inside a box.
+// Like BoundingBoxTable, the arrays are either owned by the table or live in a mapped goal bounds file.
+class QuantizedBoundingBoxTable final
+{
+public:
+	QuantizedBoundingBoxTable() { PointAtStorage(); }
+	QuantizedBoundingBoxTable(const QuantizedBoundingBoxTable& other) { *this = other; }
+	QuantizedBoundingBoxTable& operator=(const QuantizedBoundingBoxTable& other);
+	// Takes over the arrays without copying them, other is left empty
+	QuantizedBoundingBoxTable(QuantizedBoundingBoxTable&& other) { *this = std::move(other); }
+	QuantizedBoundingBoxTable& operator=(QuantizedBoundingBoxTable&& other);
+
+	void Clear();
+	// Rebuilds the table from the float boxes, on a grid spanning [boundsMin, boundsMax]
+	void Quantize(const BoundingBoxTable& boxes, const Elite::Vector2& boundsMin, const Elite::Vector2& boundsMax);
+
+	// Reads the arrays in place, pMappedFile keeps them alive for as long as the table uses them
+	void Attach(std::shared_ptr<const Elite::MappedFile> pMappedFile, const Elite::Vector2& boundsMin, const Elite::Vector2& boundsMax, int nrOfNodes, int nrOfEdges,
+		const int* pFirstEdge, const unsigned short* pLeft, const unsigned short* pRight, const unsigned short* pBottom, const unsigned short* pTop);
+	// Copies the arrays out of the mapped file and lets go of it, e.g. before that file is overwritten
+	void Detach();
+	// True when a grid can span the bounds: finite, not empty on either axis and big enough that the cells per unit stay finite
+	static bool AreBoundsValid(const Elite::Vector2& boundsMin, const Elite::Vector2& boundsMax);
+
+	bool IsEmpty() const { return m_NrOfEdges == 0; }
+	int GetNrOfNodes() const { return m_NrOfNodes; }
+	int GetNrOfEdges() const { return m_NrOfEdges; }
+	int GetFirstEdge(int nodeIdx) const { return m_pFirstEdge[nodeIdx]; }
+	const Elite::Vector2& GetBoundsMin() const { return m_BoundsMin; }
+	const Elite::Vector2& GetBoundsMax() const { return m_BoundsMax; }
+
+	// Raw arrays, GetNrOfNodes() + 1 edge offsets and GetNrOfEdges() sides in grid coordinates
+	const int* GetFirstEdges() const { return m_pFirstEdge; }
+	const unsigned short* GetLeftSides() const { return m_pLeft; }
+	const unsigned short* GetRightSides() const { return m_pRight; }
+	const unsigned short* GetBottomSides() const { return m_pBottom; }
+	const unsigned short* GetTopSides() const { return m_pTop; }
+
+	bool IsInside(int edgeIdx, float x, float y) const
+	{
+		assert(edgeIdx >= 0 && edgeIdx < GetNrOfEdges() && "<QuantizedBoundingBoxTable::IsInside>: invalid edge index");
+		const float gridX{ ToGridX(x) };
+		const float gridY{ ToGridY(y) };
+		return gridX > m_pLeft[edgeIdx] && gridX < m_pRight[edgeIdx] && gridY > m_pBottom[edgeIdx] && gridY < m_pTop[edgeIdx];
+	}
+
+	// Same contract as BoundingBoxTable::GetInsideMask
+	unsigned int GetInsideMask(int firstEdge, int nrOfEdges, float x, float y) const;
+
+private:
+	enum { max_coordinate = 0xFFFF };
+
+	//Storage of a table that is quantized in memory
+	std::vector<int> m_FirstEdge{ 0 };
+	std::vector<unsigned short> m_Left;
+	std::vector<unsigned short> m_Right;
+	std::vector<unsigned short> m_Bottom;
+	std::vector<unsigned short> m_Top;
+	std::shared_ptr<const Elite::MappedFile> m_pMappedFile; // set when the arrays live in a mapped file
+
+	//Arrays the queries read, they point into the storage above or into the mapped file
+	const int* m_pFirstEdge = nullptr;
+	const unsigned short* m_pLeft = nullptr;
+	const unsigned short* m_pRight = nullptr;
+	const unsigned short* m_pBottom = nullptr;
+	const unsigned short* m_pTop = nullptr;
+	int m_NrOfNodes = 0;
+	int m_NrOfEdges = 0;
+
+	Elite::Vector2 m_BoundsMin{};
+	Elite::Vector2 m_BoundsMax{};
+	Elite::Vector2 m_CellsPerUnit{}; // grid cells per world unit on both axes
+
+	float ToGridX(float x) const { return (x - m_BoundsMin.x) * m_CellsPerUnit.x; }
+	float ToGridY(float y) const { return (y - m_BoundsMin.y) * m_CellsPerUnit.y; }
+	static unsigned short SnapDown(float gridPos);
+	static unsigned short SnapUp(float gridPos);
+	void SetBounds(const Elite::Vector2& boundsMin, const Elite::Vector2& boundsMax);
+
+	void PointAtStorage()
+	{
+		m_pFirstEdge = m_FirstEdge.data();
+		m_pLeft = m_Left.data();
+		m_pRight = m_Right.data();
+		m_pBottom = m_Bottom.data();
+		m_pTop = m_Top.data();
+		m_NrOfNodes = static_cast<int>(m_FirstEdge.size()) - 1;
+		m_NrOfEdges = m_FirstEdge.back();
+	}
+};
+
+inline QuantizedBoundingBoxTable& QuantizedBoundingBoxTable::operator=(const QuantizedBoundingBoxTable& other)
+{
+	if (this == &other)
+		return *this;
+
+	m_FirstEdge = other.m_FirstEdge;
+	m_Left = other.m_Left;
+	m_Right = other.m_Right;
+	m_Bottom = other.m_Bottom;
+	m_Top = other.m_Top;
+	SetBounds(other.m_BoundsMin, other.m_BoundsMax);
+
+	if (other.m_pMappedFile)
+		Attach(other.m_pMappedFile, other.m_BoundsMin, other.m_BoundsMax, other.m_NrOfNodes, other.m_NrOfEdges,
+			other.m_pFirstEdge, other.m_pLeft, other.m_pRight, other.m_pBottom, other.m_pTop);
+	else
+	{
+		m_pMappedFile.reset();
+		PointAtStorage();
+	}
+	return *this;
+}
+
+inline QuantizedBoundingBoxTable& QuantizedBoundingBoxTable::operator=(QuantizedBoundingBoxTable&& other)
+{
+	if (this == &other)
+		return *this;
+
+	//A moved vector keeps its buffer, so the arrays stay where other's pointers point, owned or mapped
+	m_FirstEdge = std::move(other.m_FirstEdge);
+	m_Left = std::move(other.m_Left);
+	m_Right = std::move(other.m_Right);
+	m_Bottom = std::move(other.m_Bottom);
+	m_Top = std::move(other.m_Top);
+	m_pMappedFile = std::move(other.m_pMappedFile);
+	SetBounds(other.m_BoundsMin, other.m_BoundsMax);
+	m_pFirstEdge = other.m_pFirstEdge;
+	m_pLeft = other.m_pLeft;
+	m_pRight = other.m_pRight;
+	m_pBottom = other.m_pBottom;
+	m_pTop = other.m_pTop;
+	m_NrOfNodes = other.m_NrOfNodes;
+	m_NrOfEdges = other.m_NrOfEdges;
+
+	other.Clear();
+	return *this;
+}
+
+inline void QuantizedBoundingBoxTable::Clear()
+{
+	m_pMappedFile.reset();
+	m_FirstEdge.assign(1, 0);
+	m_Left.clear();
+	m_Right.clear();
+	m_Bottom.clear();
+	m_Top.clear();
+	PointAtStorage();
+}
+
+inline bool QuantizedBoundingBoxTable::AreBoundsValid(const Elite::Vector2& boundsMin, const Elite::Vector2& boundsMax)
+{
+	//NaN fails every comparison, so it never passes the max > min test
+	return std::isfinite(boundsMin.x) && std::isfinite(boundsMin.y) && std::isfinite(boundsMax.x) && std::isfinite(boundsMax.y)
+		&& boundsMax.x > boundsMin.x && boundsMax.y > boundsMin.y
+		&& std::isfinite(max_coordinate / (boundsMax.x - boundsMin.x)) && std::isfinite(max_coordinate / (boundsMax.y - boundsMin.y));
+}
+
+inline void QuantizedBoundingBoxTable::SetBounds(const Elite::Vector2& boundsMin, const Elite::Vector2& boundsMax)
+{
+	m_BoundsMin = boundsMin;
+	m_BoundsMax = boundsMax;
+	m_CellsPerUnit = { max_coordinate / (boundsMax.x - boundsMin.x), max_coordinate / (boundsMax.y - boundsMin.y) };
+}
+
+inline void QuantizedBoundingBoxTable::Attach(std::shared_ptr<const Elite::MappedFile> pMappedFile, const Elite::Vector2& boundsMin, const Elite::Vector2& boundsMax, int nrOfNodes, int nrOfEdges,
+	const int* pFirstEdge, const unsigned short* pLeft, const unsigned short* pRight, const unsigned short* pBottom, const unsigned short* pTop)
+{
+	assert(pFirstEdge[nrOfNodes] == nrOfEdges && "<QuantizedBoundingBoxTable::Attach>: edge offsets don't match the amount of edges");
+
+	Clear();
+	SetBounds(boundsMin, boundsMax);
+	m_pMappedFile = std::move(pMappedFile);
+	m_pFirstEdge = pFirstEdge;
+	m_pLeft = pLeft;
+	m_pRight = pRight;
+	m_pBottom = pBottom;
+	m_pTop = pTop;
+	m_NrOfNodes = nrOfNodes;
+	m_NrOfEdges = nrOfEdges;
+}
+
+inline void QuantizedBoundingBoxTable::Detach()
+{
+	if (!m_pMappedFile)
+		return;
+
+	m_FirstEdge.assign(m_pFirstEdge, m_pFirstEdge + m_NrOfNodes + 1);
+	m_Left.assign(m_pLeft, m_pLeft + m_NrOfEdges);
+	m_Right.assign(m_pRight, m_pRight + m_NrOfEdges);
+	m_Bottom.assign(m_pBottom, m_pBottom + m_NrOfEdges);
+	m_Top.assign(m_pTop, m_pTop + m_NrOfEdges);
+	m_pMappedFile.reset();
+	PointAtStorage();
+}
+
+inline void QuantizedBoundingBoxTable::Quantize(const BoundingBoxTable& boxes, const Elite::Vector2& boundsMin, const Elite::Vector2& boundsMax)
+{
+	assert(boundsMin.x < boundsMax.x && boundsMin.y < boundsMax.y && "<QuantizedBoundingBoxTable::Quantize>: invalid bounds");
+
+	Clear();
+	SetBounds(boundsMin, boundsMax);
+
+	const int nrOfEdges{ boxes.GetNrOfEdges() };
+	m_FirstEdge.reserve(boxes.GetNrOfNodes() + 1);
+	m_Left.reserve(nrOfEdges);
+	m_Right.reserve(nrOfEdges);
+	m_Bottom.reserve(nrOfEdges);
+	m_Top.reserve(nrOfEdges);
+
+	for (int node{}; node < boxes.GetNrOfNodes(); ++node)
+	{
+		for (int edge = boxes.GetFirstEdge(node); edge < boxes.GetFirstEdge(node + 1); ++edge)
+		{
+			float left{}, right{}, bottom{}, top{};
+			boxes.GetBox(edge, left, right, bottom, top);
+
+			//Empty boxes stay empty, left > right can't contain anything
+			if (left > right || bottom > top)
+			{
+				m_Left.push_back(max_coordinate);
+				m_Right.push_back(0);
+				m_Bottom.push_back(max_coordinate);
+				m_Top.push_back(0);
+				continue;
+			}
+
+			m_Left.push_back(SnapDown(ToGridX(left)));
+			m_Right.push_back(SnapUp(ToGridX(right)));
+			m_Bottom.push_back(SnapDown(ToGridY(bottom)));
+			m_Top.push_back(SnapUp(ToGridY(top)));
+		}
+		m_FirstEdge.push_back(static_cast<int>(m_Left.size()));
+	}
+	PointAtStorage();
+}
+
+inline unsigned short QuantizedBoundingBoxTable::SnapDown(float gridPos)
+{
+	//One extra cell covers the rounding of ToGrid, both when baking and when testing
+	const float snapped{ std::floor(gridPos) - 1.f };
+	return static_cast<unsigned short>(std::min(std::max(snapped, 0.f), static_cast<float>(max_coordinate)));
+}
+
+inline unsigned short QuantizedBoundingBoxTable::SnapUp(float gridPos)
+{
+	const float snapped{ std::ceil(gridPos) + 1.f };
+	return static_cast<unsigned short>(std::min(std::max(snapped, 0.f), static_cast<float>(max_coordinate)));
+}
+
+inline unsigned int QuantizedBoundingBoxTable::GetInsideMask(int firstEdge, int nrOfEdges, float x, float y) const
+{
+	assert(nrOfEdges >= 0 && nrOfEdges <= BoundingBoxTable::max_batch_edges && "<QuantizedBoundingBoxTable::GetInsideMask>: too many edges for one batch");
+	assert(firstEdge >= 0 && firstEdge + nrOfEdges <= GetNrOfEdges() && "<QuantizedBoundingBoxTable::GetInsideMask>: invalid edge range");
+
+	const float gridX{ ToGridX(x) };
+	const float gridY{ ToGridY(y) };
+	unsigned int mask{};
+	int i{};
+
+#ifdef BOUNDING_BOX_TABLE_AVX2
+	const __m256 x8 = _mm256_set1_ps(gridX);
+	const __m256 y8 = _mm256_set1_ps(gridY);
+	const auto load8 = [](const unsigned short* pCoordinates)
+	{
+		return _mm256_cvtepi32_ps(_mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pCoordinates))));
+	};
+	for (; i + 8 <= nrOfEdges; i += 8)
+	{
+		const int e = firstEdge + i;
+		const __m256 insideX = _mm256_and_ps(_mm256_cmp_ps(x8, load8(m_pLeft + e), _CMP_GT_OQ), _mm256_cmp_ps(x8, load8(m_pRight + e), _CMP_LT_OQ));
+		const __m256 insideY = _mm256_and_ps(_mm256_cmp_ps(y8, load8(m_pBottom + e), _CMP_GT_OQ), _mm256_cmp_ps(y8, load8(m_pTop + e), _CMP_LT_OQ));
+		mask |= static_cast<unsigned int>(_mm256_movemask_ps(_mm256_and_ps(insideX, insideY))) << i;
+	}
+#endif
+#ifdef BOUNDING_BOX_TABLE_SSE2
+	const __m128 x4 = _mm_set1_ps(gridX);
+	const __m128 y4 = _mm_set1_ps(gridY);
+	const __m128i zero = _mm_setzero_si128();
+	const auto load4 = [zero](const unsigned short* pCoordinates)
+	{
+		return _mm_cvtepi32_ps(_mm_unpacklo_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(pCoordinates)), zero));
+	};
+	for (; i + 4 <= nrOfEdges; i += 4)
+	{
+		const int e = firstEdge + i;
+		const __m128 insideX = _mm_and_ps(_mm_cmpgt_ps(x4, load4(m_pLeft + e)), _mm_cmplt_ps(x4, load4(m_pRight + e)));
+		const __m128 insideY = _mm_and_ps(_mm_cmpgt_ps(y4, load4(m_pBottom + e)), _mm_cmplt_ps(y4, load4(m_pTop + e)));
+		mask |= static_cast<unsigned int>(_mm_movemask_ps(_mm_and_ps(insideX, insideY))) << i;
+	}
+#endif
+
+	//Leftover edges
+	for (; i < nrOfEdges; ++i)
+	{
+		const int e = firstEdge + i;
+		if (gridX > m_pLeft[e] && gridX < m_pRight[e] && gridY > m_pBottom[e] && gridY < m_pTop[e])
+			mask |= 1u << i;
+	}
+
+	return mask;
+}
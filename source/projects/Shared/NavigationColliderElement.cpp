@@ -27,4 +27,22 @@ NavigationColliderElement::~NavigationColliderElement()
 void NavigationColliderElement::RenderElement()
 {
 	//Do Nothing
+}
+
+Elite::Polygon NavigationColliderElement::GetShape() const
+{
+	//Corners in the order of a box shape, the body isn't rotated
+	const float halfWidth{ m_Width / 2.f };
+	const float halfHeight{ m_Height / 2.f };
+	const std::vector<Elite::Vector2> corners
+	{
+		m_Position + Elite::Vector2(-halfWidth, -halfHeight),
+		m_Position + Elite::Vector2(halfWidth, -halfHeight),
+		m_Position + Elite::Vector2(halfWidth, halfHeight),
+		m_Position + Elite::Vector2(-halfWidth, halfHeight)
+	};
+
+	Elite::Polygon shape{ corners };
+	shape.OrientateWithChildren(Elite::Winding::CW);
+	return shape;
 }
\ No newline at end of file
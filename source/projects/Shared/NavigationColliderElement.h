@@ -18,6 +18,8 @@ public:
 
 	//--- Functions ---
 	void RenderElement();
+	//Same shape as PhysicsWorld::GetAllStaticShapesInWorld returns for this collider, for incremental navmesh updates
+	Elite::Polygon GetShape() const;
 
 private:
 	//--- Datamembers ---